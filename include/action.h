@@ -78,6 +78,16 @@ typedef enum {
     ACTION_SHOW_MESSAGE_RUN,
     /* resize the edges of the current window */
     ACTION_RESIZE_BY,
+    /* save the frames of all monitors under a name */
+    ACTION_SAVE_LAYOUT,
+    /* restore frames saved with `ACTION_SAVE_LAYOUT` */
+    ACTION_RESTORE_LAYOUT,
+    /* write the memory usage of each subsystem and the glyph cache statistics
+     * to a file
+     */
+    ACTION_DUMP_MEMORY,
+    /* replace fensterchef with a new process and keep the layout */
+    ACTION_RESTART,
     /* quit fensterchef */
     ACTION_QUIT,
 
@@ -110,4 +120,27 @@ void free_actions(Action *actions, uint32_t number_of_actions);
 /* Do the given action on the given window. */
 void do_action(const Action *action, Window *window);
 
+/* Check if repetitions of @action can be merged by
+ * `do_repeated_action()`.
+ */
+bool is_action_repeatable(const Action *action);
+
+/* Do @action @count times on the focused window as if it was a single action.
+ *
+ * For `ACTION_RESIZE_BY`, the deltas are summed up and the window is resized
+ * once. The other repeatable actions are done @count times in a row.
+ */
+void do_repeated_action(const Action *action, uint32_t count);
+
+/* Start running multiple actions as one transaction.
+ *
+ * Until `end_action_transaction()` is called, Z stack changes and
+ * notifications are collected so that only the final result is sent to the
+ * server instead of every intermediate step.
+ */
+void begin_action_transaction(void);
+
+/* Send all changes collected since `begin_action_transaction()`. */
+void end_action_transaction(void);
+
 #endif
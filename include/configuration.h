@@ -7,6 +7,7 @@
 #include "action.h"
 #include "keymap.h"
 #include "utility.h"
+#include "window_rules.h"
 
 /* general settings */
 struct configuration_general {
@@ -35,6 +36,8 @@ struct configuration_tiling {
 struct configuration_font {
     /* name of the font in fontconfig format */
     uint8_t *name;
+    /* the number of kilobytes the rendered glyphs may take up on the server */
+    uint32_t cache_size;
 };
 
 /* border settings (tiling and popup) */
@@ -69,6 +72,10 @@ struct configuration_notification {
     uint32_t foreground;
     /* color of the background */
     uint32_t background;
+    /* the number of kilobytes the window icons shown in the window list may
+     * take up on the server, 0 disables icons
+     */
+    uint32_t icon_cache_size;
 };
 
 /* if the binding should be for a release event */
@@ -93,6 +100,12 @@ struct configuration_button {
 struct configuration_mouse {
     /* how many pixels off the edges of windows should be used for resizing */
     int32_t resize_tolerance;
+    /* whether the window the mouse moves into gets the focus */
+    bool focus_follows_mouse;
+    /* how many milliseconds the mouse needs to stay within a window before it
+     * gets the focus
+     */
+    uint32_t focus_delay;
     /* the modifier key for all buttons (applied at the parsing step) */
     uint16_t modifiers;
     /* the modifiers to ignore */
@@ -128,6 +141,26 @@ struct configuration_keyboard {
     uint32_t number_of_keys;
 };
 
+/* window rule, e.g.: class Firefox frame left */
+struct configuration_rule {
+    /* what the pattern is matched against */
+    rule_match_t match;
+    /* the pattern, `*` matches any text and `?` any single character */
+    uint8_t *pattern;
+    /* the mode to put the window in, `WINDOW_MODE_MAX` if not set */
+    window_mode_t mode;
+    /* the frame to put the window in */
+    rule_frame_t frame;
+};
+
+/* window rules */
+struct configuration_rules {
+    /* the configured rules in the order they appear */
+    struct configuration_rule *rules;
+    /* the number of configured rules */
+    uint32_t number_of_rules;
+};
+
 /* the currently loaded configuration */
 extern struct configuration {
     /* general settings */
@@ -148,6 +181,8 @@ extern struct configuration {
     struct configuration_mouse mouse;
     /* keyboard settings / key bindings */
     struct configuration_keyboard keyboard;
+    /* window rules */
+    struct configuration_rules rules;
 } configuration;
 
 /* Create a deep copy of @duplicate and put it into itself.
@@ -32,6 +32,8 @@ typedef enum {
     PARSER_ERROR_INVALID_LABEL,
     /* a ']' is missing */
     PARSER_ERROR_MISSING_CLOSING,
+    /* a '"' is missing */
+    PARSER_ERROR_MISSING_QUOTE,
     /* no label was specified */
     PARSER_ERROR_NOT_IN_LABEL,
     /* invalid boolean identifier */
@@ -56,6 +58,12 @@ typedef enum {
     PARSER_ERROR_INVALID_ACTION,
     /* an action value is missing */
     PARSER_ERROR_MISSING_ACTION,
+    /* invalid rule matcher */
+    PARSER_ERROR_INVALID_RULE_MATCHER,
+    /* invalid window type in a rule */
+    PARSER_ERROR_INVALID_WINDOW_TYPE,
+    /* invalid rule effect or effect value */
+    PARSER_ERROR_INVALID_RULE_EFFECT,
     /* an unexpected syntax on a line */
     PARSER_ERROR_UNEXPECTED
 } parser_error_t;
@@ -82,6 +90,7 @@ typedef enum parser_label {
     PARSER_LABEL_NOTIFICATION,
     PARSER_LABEL_MOUSE,
     PARSER_LABEL_KEYBOARD,
+    PARSER_LABEL_RULES,
 
     PARSER_LABEL_MAX,
 } parser_label_t;
@@ -118,6 +127,8 @@ typedef struct parser {
     struct configuration_button button;
     /* keybinding, e.g.: n next-window */
     struct configuration_key key;
+    /* window rule, e.g.: class Firefox frame left */
+    struct configuration_rule rule;
 } Parser;
 
 /* Converts @error to a string. */
@@ -5,6 +5,17 @@
 
 #include "x11_management.h"
 
+/* the number of event types, the most significant bit of the response type
+ * only indicates whether the event was sent by a client
+ */
+#define EVENT_TYPE_MAX 128
+
+/* the maximum number of handlers that can be registered for one event type */
+#define EVENT_HANDLERS_MAX 4
+
+/* a function handling an X event */
+typedef void (*event_handler_t)(xcb_generic_event_t *event);
+
 /* this is the first index of a randr event */
 extern uint8_t randr_event_base;
 
@@ -25,10 +36,42 @@ void synchronize_client_list(void);
 /* Synchronize the local data with the X server. */
 void synchronize_with_server(void);
 
+/* Register the event handlers of the window manager core.
+ *
+ * This needs to be called after randr was initialized.
+ */
+void initialize_event_handlers(void);
+
+/* Add @handler to the handlers of events with given @type.
+ *
+ * Handlers registered later are called before handlers registered earlier.
+ * Subsystems should only register their handlers while they are active.
+ */
+void register_event_handler(uint8_t type, event_handler_t handler);
+
+/* Remove @handler from the handlers of events with given @type.
+ *
+ * It is allowed to call this from within an event handler.
+ */
+void unregister_event_handler(uint8_t type, event_handler_t handler);
+
+/* Log how many events of @window were deferred because it was throttled and
+ * reset the counts.
+ *
+ * This is done when the throttling of a window ends, when it is destroyed and
+ * for all windows by `log_event_statistics()`.
+ */
+void log_deferred_events(Window *window);
+
+/* Log how many events of each type were handled and which windows are still
+ * throttled.
+ */
+void log_event_statistics(void);
+
 /* Runs the next cycle of the event loop. This handles signals and all events
  * that are currently queued.
  *
- * It also delegates events to the window list if it is mapped.
+ * Events are delegated to the handlers registered for their type.
  */
 int next_cycle(void);
 
@@ -37,7 +80,7 @@ void initiate_window_move_resize(Window *window,
         wm_move_resize_direction_t direction,
         int32_t start_x, int32_t start_y);
 
-/* Handle the given X event. */
+/* Handle the given X event by calling all handlers registered for its type. */
 void handle_event(xcb_generic_event_t *event);
 
 #endif
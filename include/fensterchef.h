@@ -30,4 +30,12 @@ void quit_fensterchef(int exit_code);
  */
 void set_notification(const uint8_t *message, int32_t x, int32_t y);
 
+/* Collect notifications instead of showing them right away, only the last one
+ * is shown when calling `flush_notification()`.
+ */
+void defer_notification(void);
+
+/* Show the last notification collected since `defer_notification()`. */
+void flush_notification(void);
+
 #endif
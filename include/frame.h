@@ -13,6 +13,14 @@
 /* the minimum width or height of a frame */
 #define FRAME_MINIMUM_SIZE 12
 
+/* the ratio of a frame whose left child takes up all space, see
+ * `Frame.ratio`
+ */
+#define FRAME_RATIO_ONE (1 << 16)
+
+/* the ratio of a frame whose children are equally sized */
+#define FRAME_RATIO_HALF (FRAME_RATIO_ONE / 2)
+
 /* an edge of the frame */
 typedef enum {
     FRAME_EDGE_LEFT,
@@ -48,6 +56,19 @@ struct frame {
     /* the direction the frame was split in */
     frame_split_direction_t split_direction;
 
+    /* the part of the width (horizontal split) or height (vertical split) the
+     * left child gets relative to `FRAME_RATIO_ONE`, the child sizes are
+     * always derived from this
+     */
+    uint32_t ratio;
+
+    /* the minimum size of this frame and all its children, only valid if
+     * `is_minimum_size_valid` is true
+     */
+    Size minimum_size;
+    /* if `minimum_size` needs no recomputation */
+    bool is_minimum_size_valid;
+
     /* parent of the frame */
     Frame *parent;
     /* left child and right child of the frame */
@@ -75,7 +96,11 @@ bool is_point_in_frame(const Frame *frame, int32_t x, int32_t y);
  */
 Frame *get_frame_at_position(int32_t x, int32_t y);
 
-/* Set the size of a frame, this also resize the inner frames and windows. */
+/* Set the size of a frame, this also resize the inner frames and windows.
+ *
+ * The sizes of the inner frames are computed from the ratios in a single top
+ * down pass.
+ */
 void resize_frame(Frame *frame, int32_t x, int32_t y,
         uint32_t width, uint32_t height);
 
@@ -85,6 +110,12 @@ void resize_frame(Frame *frame, int32_t x, int32_t y,
  */
 void replace_frame(Frame *frame, Frame *with);
 
+/* Mark the cached minimum size of @frame and all its parents as outdated.
+ *
+ * This must be called whenever the children of @frame change.
+ */
+void invalidate_frame_minimum_size(Frame *frame);
+
 /* Get the gaps the frame applies to its inner window. */
 void get_frame_gaps(Frame *frame, Extents *gaps);
 
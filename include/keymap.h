@@ -4,13 +4,32 @@
 #include <xcb/xcb.h>
 #include <xcb/xcb_keysyms.h>
 
-/* Initializes the key symbol table so the below functions can be used. */
+/* Initializes the key symbol table so the below functions can be used.
+ *
+ * This also turns on detectable autorepeat so that held down keys send only
+ * presses.
+ */
 int initialize_keymap(void);
 
-/* Refresh the keymap if a mapping notify event arrives. */
-void refresh_keymap(xcb_mapping_notify_event_t *event);
+/* Remember that the keymap needs to be refreshed because of @event.
+ *
+ * Only changes of the keyboard mapping are considered, pointer and modifier
+ * mapping changes do not change the key symbols. A burst of mapping
+ * notifications is applied once by `flush_keymap_refresh()`.
+ */
+void queue_keymap_refresh(xcb_mapping_notify_event_t *event);
 
-/* Get a keysym from a keycode. */
+/* Refresh the keymap if a refresh was queued.
+ *
+ * The keys are only grabbed again if the keycodes of any bound key symbol
+ * changed.
+ */
+void flush_keymap_refresh(void);
+
+/* Get a keysym from a keycode.
+ *
+ * This flushes a queued refresh first so the result is never outdated.
+ */
 xcb_keysym_t get_keysym(xcb_keycode_t keycode);
 
 /* Get a list of keycodes from a keysym.
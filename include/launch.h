@@ -0,0 +1,64 @@
+#ifndef LAUNCH_H
+#define LAUNCH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "bits/window_typedef.h"
+
+#include "utility.h"
+
+/* the maximum size of a startup identifier including the null terminator */
+#define LAUNCH_ID_SIZE 64
+
+/* the maximum number of programs waiting for their first window at once */
+#define MAXIMUM_PENDING_LAUNCHES 16
+
+/* the number of milliseconds after which a launch that did not map a window is
+ * forgotten
+ */
+#define LAUNCH_TIMEOUT 30000
+
+/* Programs started with the `RUN` action remember the frame that was focused
+ * at that moment.
+ *
+ * The program gets a startup identifier in `DESKTOP_STARTUP_ID` which toolkits
+ * put into `_NET_STARTUP_ID` of their windows. Programs that do not do that are
+ * matched through `_NET_WM_PID` instead. When a window of the program is shown
+ * for the first time, it is put into the remembered frame instead of the one
+ * focused at that time. This only happens when the window is shown on the
+ * screen the program was started on.
+ */
+
+/* Remember the focused frame for a program that is about to start.
+ *
+ * @return the startup identifier to put into `DESKTOP_STARTUP_ID`.
+ */
+const char *begin_launch(void);
+
+/* Set the process id of the program started with the startup identifier @id.
+ */
+void set_launch_process(const char *id, pid_t process_id);
+
+/* Take the launch of the current screen with the startup identifier @id or, if
+ * there is none, the one with the process id @process_id.
+ *
+ * @id is @id_length long and not null terminated, it may be NULL if
+ * @id_length is 0. @process_id may be 0.
+ *
+ * @now is the current monotonic time in milliseconds, launches older than
+ * `LAUNCH_TIMEOUT` are not considered.
+ *
+ * @position receives the center of the frame the launch remembered. The launch
+ * is forgotten so that only the first window of a program is placed.
+ *
+ * @return false if no launch matches.
+ */
+bool take_launch(const char *id, size_t id_length, pid_t process_id,
+        uint64_t now, Point *position);
+
+/* Match the new @window to a pending launch and take over its frame. */
+void match_window_to_launch(Window *window);
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef LAYOUT_H
+#define LAYOUT_H
+
+/* A layout is a named copy of the frame trees of all monitors including the
+ * split directions, sizes and which window is in which frame.
+ *
+ * Layouts are kept in memory and are also written to
+ * `FENSTERCHEF_LAYOUT_DIRECTORY` so they survive a restart of fensterchef. In
+ * memory, a layout knows the exact windows. On disk, the windows are stored by
+ * their instance and class name and any window with the same names is put
+ * into the frame.
+ *
+ * Restoring a layout builds all frames first and then sizes each monitor in a
+ * single pass, so every affected window is only configured once.
+ */
+
+/* the directory layouts are saved in, one file per layout */
+#define FENSTERCHEF_LAYOUT_DIRECTORY "~/.config/fensterchef/layouts"
+
+/* Save the frames of all monitors under @name.
+ *
+ * This overwrites any layout with the same name in memory and on disk.
+ *
+ * @return ERROR if the name is invalid or the layout could not be written to
+ *         disk, it is still kept in memory in the latter case.
+ */
+int save_layout(const char *name);
+
+/* Restore the layout with given @name.
+ *
+ * If the layout is not in memory, it is loaded from disk. Monitors not in the
+ * layout are left untouched. The windows of the other monitors that the layout
+ * does not place are stashed.
+ *
+ * @return ERROR if there is no layout with that name.
+ */
+int restore_layout(const char *name);
+
+#endif
@@ -24,6 +24,21 @@ typedef struct monitor {
     /* root frame */
     Frame *frame;
 
+    /* the maximal empty rectangles not covered by any window, see
+     * `placement.h`
+     */
+    Rectangle *free_rectangles;
+    /* the number of rectangles in `free_rectangles` */
+    uint32_t number_of_free_rectangles;
+    /* the allocated length of `free_rectangles` */
+    uint32_t free_rectangles_capacity;
+    /* the region of the monitor without the strut `free_rectangles` were built
+     * for
+     */
+    Rectangle free_space_bounds;
+    /* if `free_rectangles` were built at all */
+    bool is_free_space_valid;
+
     /* next monitor in the linked list */
     struct monitor *next;
 } Monitor;
@@ -31,7 +46,11 @@ typedef struct monitor {
 /* the first monitor in the monitor linked list */
 extern Monitor *first_monitor;
 
-/* Try to initialize randr and the internal monitor linked list. */
+/* Try to initialize randr and the internal monitor linked list of the current
+ * screen.
+ *
+ * The randr extension is only queried for the first screen.
+ */
 void initialize_monitors(void);
 
 /* Get the monitor that overlaps given rectangle the most.
@@ -0,0 +1,48 @@
+#ifndef PLACEMENT_H
+#define PLACEMENT_H
+
+#include <stdbool.h>
+
+#include "bits/window_typedef.h"
+
+#include "monitor.h"
+#include "utility.h"
+
+/* The placement engine keeps track of the free space on each monitor that is
+ * not covered by any floating, fullscreen or dock window. The free space is
+ * stored as a list of maximal empty rectangles ordered by their area.
+ *
+ * Each window remembers the region it occupies. When a window is shown, hidden,
+ * moved or resized, only the free rectangles around its old and new region are
+ * updated. The free space of a monitor is only built from scratch when its
+ * size or strut changes.
+ *
+ * This is used to place new floating windows next to each other instead of
+ * stacking them all in the center of the monitor.
+ */
+
+/* Update the region @window occupies in the free space.
+ *
+ * This is called for all windows when synchronizing with the server, it does
+ * nothing when the window did not change.
+ */
+void update_window_free_space(Window *window);
+
+/* Give the region @window occupies back to the free space. */
+void release_window_free_space(Window *window);
+
+/* Move @geometry of @window into the free space of @monitor.
+ *
+ * The border of @window is added to the size of @geometry, just like the free
+ * space is computed with the border of each window.
+ *
+ * The region @geometry is placed at becomes the region @window occupies so that
+ * placing multiple windows within the same event cycle does not overlap them.
+ *
+ * @return false if there is no free region large enough, @geometry is
+ *         unchanged then.
+ */
+bool place_in_free_space(Window *window, Monitor *monitor,
+        Rectangle *geometry);
+
+#endif
@@ -0,0 +1,118 @@
+#ifndef PROBE_H
+#define PROBE_H
+
+#include <stdbool.h>
+
+#include "utility.h"
+
+/* Static tracepoints: when compiled with `USDT_PROBES` defined (`make USDT=1`,
+ * this needs `sys/sdt.h` from systemtap), USDT probes of the provider
+ * `fensterchef` are placed on the hot paths so that bpftrace or perf can
+ * correlate latency with windows and actions.
+ *
+ * Each probe is a single nop until a tracer attaches to it. The probe
+ * arguments, including the clock reads for durations, are only computed while
+ * a tracer is attached because every probe checks its semaphore first.
+ *
+ * Without `USDT_PROBES`, the probes compile to nothing.
+ *
+ * Example bpftrace scripts are in `probes/`.
+ */
+
+/* expands to all probes, the probe arguments are listed in the comments
+ *
+ * All durations are in nanoseconds.
+ */
+#define DEFINE_ALL_PROBES \
+    /* an event was taken out of the queue: event type, window */ \
+    X(event__receive) \
+    /* an event was handled: event type, window, duration */ \
+    X(event__handle) \
+    /* an action starts: action code, window */ \
+    X(action__start) \
+    /* an action ended: action code, window, duration */ \
+    X(action__end) \
+    /* `synchronize_with_server()` starts */ \
+    X(synchronize__start) \
+    /* `synchronize_with_server()` ended: duration */ \
+    X(synchronize__end) \
+    /* a property was fetched: window, property atom, length in bytes */ \
+    X(property__fetch) \
+    /* a glyph was not in the glyph cache: codepoint, size in bytes, duration
+     * of rendering and uploading it
+     */ \
+    X(glyph__miss) \
+    /* the input focus was set: focused window, active window */ \
+    X(input__focus)
+
+#ifdef USDT_PROBES
+
+/* let the tracer enable the probes through semaphores */
+#define _SDT_HAS_SEMAPHORES 1
+#include <sys/sdt.h>
+
+/* the semaphores a tracer increments while it is attached to a probe */
+#define X(name) extern unsigned short fensterchef_##name##_semaphore;
+DEFINE_ALL_PROBES
+#undef X
+
+/* Check if a tracer is attached to the probe @name. */
+#define IS_PROBE_ENABLED(name) \
+    __builtin_expect(fensterchef_##name##_semaphore != 0, 0)
+
+/* Fire the probe @name with up to three arguments. */
+#define PROBE(name) do { \
+    if (IS_PROBE_ENABLED(name)) { \
+        DTRACE_PROBE(fensterchef, name); \
+    } \
+} while (0)
+#define PROBE1(name, a) do { \
+    if (IS_PROBE_ENABLED(name)) { \
+        DTRACE_PROBE1(fensterchef, name, a); \
+    } \
+} while (0)
+#define PROBE2(name, a, b) do { \
+    if (IS_PROBE_ENABLED(name)) { \
+        DTRACE_PROBE2(fensterchef, name, a, b); \
+    } \
+} while (0)
+#define PROBE3(name, a, b, c) do { \
+    if (IS_PROBE_ENABLED(name)) { \
+        DTRACE_PROBE3(fensterchef, name, a, b, c); \
+    } \
+} while (0)
+
+#else
+
+#define IS_PROBE_ENABLED(name) false
+
+/* the arguments are referenced but never evaluated */
+#define PROBE(name) do { } while (0)
+#define PROBE1(name, a) do { \
+    if (false) { \
+        (void) (a); \
+    } \
+} while (0)
+#define PROBE2(name, a, b) do { \
+    if (false) { \
+        (void) (a); (void) (b); \
+    } \
+} while (0)
+#define PROBE3(name, a, b, c) do { \
+    if (false) { \
+        (void) (a); (void) (b); (void) (c); \
+    } \
+} while (0)
+
+#endif
+
+/* Get the start time of a duration reported by the probe @name, this is 0 if
+ * no tracer is attached.
+ */
+#define START_PROBE_TIMER(name) \
+    (IS_PROBE_ENABLED(name) ? get_monotonic_nanoseconds() : 0)
+
+/* Get the nanoseconds passed since @start. */
+#define GET_PROBE_DURATION(start) (get_monotonic_nanoseconds() - (start))
+
+#endif
@@ -33,9 +33,21 @@ enum {
 /* graphical objects with the id referring to the X id */
 extern uint32_t stock_objects[STOCK_MAX];
 
-/* Initialize the graphical stock objects that can be used for rendering. */
+/* the pictures created for the windows of the current screen, see
+ * `cache_window_picture()`
+ */
+extern struct window_picture_cache *window_picture_cache_head;
+
+/* Initialize the picture formats and the font, these are shared by all
+ * screens.
+ */
 int initialize_renderer(void);
 
+/* Create the graphical stock objects of the current screen that can be used
+ * for rendering.
+ */
+int create_stock_objects(void);
+
 /* Free all resources associated to rendering. */
 void deinitialize_renderer(void);
 
@@ -48,6 +60,19 @@ void set_pen_color(xcb_render_picture_t pen, xcb_render_color_t color);
 /* Create a picture with width and height set to 1. */
 xcb_render_picture_t create_pen(xcb_render_color_t color);
 
+/* Create a picture from @width times @height premultiplied ARGB @pixels.
+ *
+ * @return XCB_NONE if the picture could not be created.
+ */
+xcb_render_picture_t create_argb_picture(const uint32_t *pixels,
+        uint32_t width, uint32_t height);
+
+/* Draw @picture onto a given drawable at @x and @y, blending it with what is
+ * below.
+ */
+void draw_picture(xcb_drawable_t xcb_drawable, xcb_render_picture_t picture,
+        int32_t x, int32_t y, uint32_t width, uint32_t height);
+
 /* Helper function to convert an RRGGBB color into an xcb color. */
 static inline void convert_color_to_xcb_color(xcb_render_color_t *xcb_color,
         uint32_t color)
@@ -61,6 +86,23 @@ static inline void convert_color_to_xcb_color(xcb_render_color_t *xcb_color,
     xcb_color->blue = (color & 0xff) << 8;
 }
 
+/* statistics about the glyph cache */
+struct glyph_cache_statistics {
+    /* the number of times a glyph was already in the glyphset */
+    uint64_t hits;
+    /* the number of times a glyph had to be added to the glyphset */
+    uint64_t misses;
+    /* the number of glyphs freed because the cache was full */
+    uint64_t evictions;
+    /* the number of glyphs currently in the glyphset */
+    uint32_t number_of_glyphs;
+    /* the number of bytes the glyphs currently take up */
+    size_t size;
+};
+
+/* Get the statistics of the glyph cache. */
+void get_glyph_cache_statistics(struct glyph_cache_statistics *statistics);
+
 /* Set the globally used font for rendering.
  *
  * @return OK on success or ERROR when the font was not found.
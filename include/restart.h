@@ -0,0 +1,45 @@
+#ifndef RESTART_H
+#define RESTART_H
+
+/* An in-place restart replaces the running fensterchef process with a new one
+ * without losing the window layout.
+ *
+ * Before the restart, a snapshot of every managed screen is written into an
+ * anonymous memory file. It holds the windows (id, number, mode, floating
+ * position and size), the frame trees of all monitors, the stash and the focus
+ * of each screen. The file descriptor is inherited by the new process through
+ * the `FENSTERCHEF_SNAPSHOT_FD` environment variable which then restores the
+ * layout from it instead of querying all existing windows again.
+ */
+
+/* the environment variable holding the file descriptor of the snapshot */
+#define FENSTERCHEF_SNAPSHOT_VARIABLE "FENSTERCHEF_SNAPSHOT_FD"
+
+/* Remember the arguments fensterchef was started with.
+ *
+ * This must be called before the arguments are parsed as parsing modifies them.
+ */
+void save_restart_arguments(int argc, char **argv);
+
+/* Write a snapshot of the state of all screens and replace the process with a
+ * new fensterchef process.
+ *
+ * @return ERROR if the snapshot could not be created, on success this function
+ *         does not return.
+ */
+int restart_fensterchef(void);
+
+/* Restore the state of all screens from the snapshot passed by the previous
+ * process.
+ *
+ * This creates all windows in the snapshot and puts them back into their
+ * frames. Screens that are no longer managed are skipped. Windows that are not
+ * in the snapshot are not touched, call `query_existing_windows()` afterwards
+ * to manage them.
+ *
+ * @return ERROR if there is no snapshot or it is invalid, nothing was changed
+ *         then.
+ */
+int restore_from_snapshot(void);
+
+#endif
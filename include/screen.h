@@ -0,0 +1,97 @@
+#ifndef SCREEN_H
+#define SCREEN_H
+
+#include "bits/frame_typedef.h"
+#include "bits/window_typedef.h"
+
+#include "monitor.h"
+#include "render.h"
+#include "window_list.h"
+#include "x11_management.h"
+
+/* All screens of the display are managed by one process over one connection.
+ *
+ * Everything tied to a root window lives in the usual globals like `screen`,
+ * `first_monitor` or `first_window`. These globals always hold the state of
+ * `current_screen`, `switch_screen()` stores them into the managed screen they
+ * belong to and loads the ones of another screen. The configuration, the
+ * glyphs and the keymap are the same for all screens.
+ */
+
+/* a screen managed by the window manager */
+struct managed_screen {
+    /* the X screen */
+    xcb_screen_t *screen;
+    /* the number of the screen within the display */
+    int number;
+
+    /* these are stored and loaded by `switch_screen()`, they are only valid
+     * while the managed screen is not the current screen
+     */
+    xcb_window_t wm_check_window;
+    XClient notification;
+    struct window_list window_list;
+    uint32_t stock_objects[STOCK_MAX];
+    struct window_picture_cache *window_picture_cache_head;
+    Monitor *first_monitor;
+    Frame *focus_frame;
+    Frame *last_stashed_frame;
+    Window *oldest_window;
+    Window *bottom_window;
+    Window *top_window;
+    Window *first_window;
+    Window *focus_window;
+    bool has_client_list_changed;
+
+    /* these are always valid */
+    /* the work area last set on the root window */
+    Rectangle workarea;
+    /* the focus window at the start of the current cycle */
+    Window *old_focus_window;
+};
+
+/* the managed screens, the first is the screen named by `DISPLAY` */
+extern struct managed_screen *managed_screens;
+
+/* the number of managed screens */
+extern uint32_t number_of_managed_screens;
+
+/* the screen whose state is in the globals */
+extern struct managed_screen *current_screen;
+
+/* Add @xcb_screen with the screen number @number to the managed screens.
+ *
+ * The first screen added becomes the current screen.
+ */
+void add_managed_screen(xcb_screen_t *xcb_screen, int number);
+
+/* Stop managing the screen at @index.
+ *
+ * This must not be the current screen and it must be done before anything was
+ * created on it.
+ */
+void remove_managed_screen(uint32_t index);
+
+/* Store the globals into the current screen and load the ones of the screen at
+ * @index.
+ */
+void switch_screen(uint32_t index);
+
+/* Get the index of the current screen. */
+uint32_t get_current_screen_index(void);
+
+/* Switch to the screen with the root window @root.
+ *
+ * @return false if no managed screen has that root, the current screen stays.
+ */
+bool switch_to_root(xcb_window_t root);
+
+/* Switch to the screen @xcb_window is on, this may be a root window, a utility
+ * window or a managed window.
+ *
+ * @return false if no managed screen knows the window, the current screen
+ *         stays.
+ */
+bool switch_to_window_screen(xcb_window_t xcb_window);
+
+#endif
@@ -3,6 +3,9 @@
 
 #include "bits/frame_typedef.h"
 
+/* the last frame in the frame stashed linked list */
+extern Frame *last_stashed_frame;
+
 /* Take frame away from the screen, this leaves a singular empty frame.
  *
  * @frame is made into a completely empty frame as all children and windows are
@@ -22,6 +25,15 @@ Frame *stash_frame_later(Frame *frame);
  */
 void link_frame_into_stash(Frame *frame);
 
+/* Get the frame that was stashed last.
+ *
+ * The older stashed frames are reachable through `previous_stashed`. Note that
+ * the windows within may no longer exist.
+ *
+ * @return NULL when there are no stashed frames.
+ */
+Frame *get_last_stashed_frame(void);
+
 /* Take frame away from the screen, hiding all inner windows and leaves a
  * singular empty frame.
  *
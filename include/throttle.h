@@ -0,0 +1,53 @@
+#ifndef THROTTLE_H
+#define THROTTLE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* the number of events per second a window may send before it is throttled */
+#define THROTTLE_RATE 100
+
+/* the number of events a window may send at once */
+#define THROTTLE_BURST 200
+
+/* the number of milliseconds the events of a throttled window are deferred,
+ * they are merged and applied once at the end
+ */
+#define THROTTLE_INTERVAL 250
+
+/* A token bucket limiting the rate of one kind of events a window sends.
+ *
+ * Each event takes a token and the tokens are refilled at `THROTTLE_RATE` per
+ * second. When the bucket is empty, the window is throttled: all its events of
+ * that kind are deferred until `THROTTLE_INTERVAL` milliseconds passed and the
+ * caller merges them into a single update.
+ */
+struct throttle {
+    /* the number of events that may pass right now */
+    uint32_t tokens;
+    /* the time in milliseconds the tokens were last refilled, 0 if the bucket
+     * was never used
+     */
+    uint64_t refill_time;
+    /* the time in milliseconds until which events are deferred, 0 if the
+     * window is not throttled
+     */
+    uint64_t release_time;
+    /* the total number of deferred events */
+    uint64_t deferred_events;
+};
+
+/* Take a token for an event that happened at @now.
+ *
+ * @return false if the event should be deferred because the window is
+ *         throttled.
+ */
+bool take_throttle_token(struct throttle *throttle, uint64_t now);
+
+/* End the throttling if the interval is over at @now.
+ *
+ * @return true if the deferred events should be applied now.
+ */
+bool release_throttle(struct throttle *throttle, uint64_t now);
+
+#endif
@@ -103,6 +103,12 @@ typedef struct rectangle {
     uint32_t height;
 } Rectangle;
 
+/* Get the current monotonic time in milliseconds. */
+uint64_t get_monotonic_milliseconds(void);
+
+/* Get the current monotonic time in nanoseconds. */
+uint64_t get_monotonic_nanoseconds(void);
+
 /* Get the length of @string up to a maximum of @max_length. */
 size_t strnlen(const char *string, size_t max_length);
 
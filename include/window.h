@@ -7,7 +7,10 @@
 #include "bits/frame_typedef.h"
 
 #include "monitor.h"
+#include "throttle.h"
 #include "utility.h"
+#include "window_icon.h"
+#include "window_rules.h"
 #include "window_state.h"
 
 #include "x11_management.h"
@@ -24,16 +27,13 @@
 /* the number the first window gets assigned */
 #define FIRST_WINDOW_NUMBER 1
 
-/* A window is a wrapper around an X window, it is always part of a few global
- * linked list and has a unique id (number).
+/* The ICCCM and EWMH properties of a window and other data that is only needed
+ * when the window itself changes.
+ *
+ * These are kept apart from `struct window` so that walking over the window
+ * linked lists only touches the few fields that are needed for it.
  */
-struct window {
-    /* the server's view of the window */
-    XClient client;
-
-    /* window name */
-    utf8_t *name;
-
+struct window_properties {
     /* X size hints of the window */
     xcb_size_hints_t size_hints;
 
@@ -43,13 +43,12 @@ struct window {
     /* window strut (reserved region on the screen) */
     wm_strut_partial_t strut;
 
-    /* the window this window is transient for */
-    xcb_window_t transient_for;
-
     /* the protocols the window supports */
     xcb_atom_t *protocols;
 
-    /* the region the window should appear at as fullscreen window */
+    /* the region the window should appear at as fullscreen window, only valid
+     * if `LAZY_PROPERTY_FULLSCREEN_MONITORS` is not stale
+     */
     Extents fullscreen_monitors;
 
     /* the motif window manager hints */
@@ -58,24 +57,44 @@ struct window {
     /* the window states */
     xcb_atom_t *states;
 
-    /* the window state */
-    WindowState state;
-
-    /* current window position and size */
-    int32_t x;
-    int32_t y;
-    uint32_t width;
-    uint32_t height;
-
-    /* size and color of the border */
-    uint32_t border_size;
-    uint32_t border_color;
-
     /* position/size when the window was in floating mode */
     Rectangle floating;
 
-    /* the id of this window */
-    uint32_t number;
+    /* the frame a window rule put this window into, this is used when the
+     * window is shown for the first time
+     */
+    rule_frame_t rule_frame;
+
+    /* a point within the frame that was focused when the program of this
+     * window was started, only set if `has_launch_position` is true
+     */
+    Point launch_position;
+    bool has_launch_position;
+
+    /* the scaled down window icon, see `get_window_icon()` */
+    struct window_icon *icon;
+
+    /* rate limit of property changes */
+    struct throttle property_throttle;
+    /* rate limit of configure requests */
+    struct throttle configure_throttle;
+    /* the properties that changed while property changes were throttled */
+    xcb_atom_t *deferred_properties;
+    /* the number of deferred properties */
+    uint32_t number_of_deferred_properties;
+};
+
+/* A window is a wrapper around an X window, it is always part of a few global
+ * linked list and has a unique id (number).
+ *
+ * Only the fields needed when walking over the linked lists are within this
+ * struct, everything else is within `properties`. The links come right after
+ * the client so that looking up a window by its id reads one cache line per
+ * window.
+ */
+struct window {
+    /* the server's view of the window */
+    XClient client;
 
     /* All windows are part of the Z ordered linked list even when they are
      * hidden now.
@@ -94,6 +113,59 @@ struct window {
     /* The number linked list stores the windows sorted by their number. */
     /* the next window in the linked list */
     Window *next;
+
+    /* the window state */
+    WindowState state;
+
+    /* current window position and size */
+    int32_t x;
+    int32_t y;
+    uint32_t width;
+    uint32_t height;
+
+    /* the region including the border the window takes away from the free
+     * space, see `placement.h`
+     */
+    Rectangle occupied_space;
+
+    /* the id of this window */
+    uint32_t number;
+
+    /* size and color of the border */
+    uint32_t border_size;
+    uint32_t border_color;
+
+    /* the lazy properties that need to be loaded before they can be used, see
+     * `LAZY_PROPERTY_*`
+     */
+    uint32_t stale_properties;
+
+    /* the window this window is transient for */
+    xcb_window_t transient_for;
+
+    /* if the window accepts input focus through `WM_TAKE_FOCUS` or its hints,
+     * see `does_window_accept_focus()`
+     */
+    bool accepts_input;
+
+    /* if the window reserves space on the screen, see `properties->strut` */
+    bool has_strut;
+
+    /* if the property changes or configure requests of the window are
+     * throttled, see `properties->property_throttle`
+     */
+    bool is_throttled;
+
+    /* if the Z position changed while restacking was deferred, see
+     * `defer_window_layers()`
+     */
+    bool is_restack_pending;
+
+    /* window name, only valid if `LAZY_PROPERTY_NAME` is not stale */
+    utf8_t *name;
+
+    /* the properties that are rarely needed */
+    struct window_properties *properties;
 };
 
 /* the window that was created before any other */
@@ -111,9 +183,22 @@ extern Window *first_window;
 /* the currently focused window */
 extern Window *focus_window;
 
+/* Get the events selected on the windows fensterchef manages.
+ *
+ * The crossing events are only selected when focus follows mouse is enabled.
+ */
+uint32_t get_window_event_mask(void);
+
 /* Create a window struct and add it to the window list. */
 Window *create_window(xcb_window_t xcb);
 
+/* Change the number of @window and move it within the number linked list.
+ *
+ * This does not check if another window already has @number, the caller must
+ * make sure the numbers are unique once it is done.
+ */
+void set_window_number(Window *window, uint32_t number);
+
 /* time in seconds to wait for a second close */
 #define REQUEST_CLOSE_MAX_DURATION 3
 
@@ -129,18 +214,28 @@ void close_window(Window *window);
 void destroy_window(Window *window);
 
 /* Adjust given @x and @y such that it follows the @window_gravity. */
-void adjust_for_window_gravity(Monitor *monitor, int32_t *x, int32_t *y,
+void adjust_for_window_gravity(const Monitor *monitor, int32_t *x, int32_t *y,
         uint32_t width, uint32_t height, uint32_t window_gravity);
 
-/* Move the window such that it is in bounds of the screen. */
-void place_window_in_bounds(Window *window);
-
 /* Get the minimum size the window should have. */
 void get_minimum_window_size(const Window *window, Size *size);
 
 /* Get the maximum size the window should have. */
 void get_maximum_window_size(const Window *window, Size *size);
 
+/* Compute the position and size @window should have in its current mode when
+ * it is shown on @monitor.
+ *
+ * This considers the size hints, window gravity, strut and fullscreen monitors
+ * and the result is already clipped to the minimum and maximum window size.
+ * It only reads from @window and @monitor and has no side effects.
+ */
+void compute_window_geometry(const Window *window, const Monitor *monitor,
+        Rectangle *geometry);
+
+/* Move the window such that it is in bounds of the screen. */
+void place_window_in_bounds(Window *window);
+
 /* Set the position and size of a window.
  *
  * Note that this function clips the parameters using `get_minimum_size()` and
@@ -149,9 +244,25 @@ void get_maximum_window_size(const Window *window, Size *size);
 void set_window_size(Window *window, int32_t x, int32_t y, uint32_t width,
         uint32_t height);
 
+/* Set the position and size of a floating, fullscreen or dock window according
+ * to its mode using `compute_window_geometry()`.
+ */
+void update_window_size(Window *window);
+
 /* Put the window on the best suited Z stack position. */
 void update_window_layer(Window *window);
 
+/* Collect the Z stack changes made by `update_window_layer()` instead of
+ * sending them to the server right away.
+ */
+void defer_window_layers(void);
+
+/* Send the Z stack changes collected since `defer_window_layers()`.
+ *
+ * Each moved window is restacked only once no matter how often it moved.
+ */
+void flush_window_layers(void);
+
 /* Get the internal window that has the associated X window.
  *
  * @return NULL when none has this X window.
@@ -0,0 +1,61 @@
+#ifndef WINDOW_ICON_H
+#define WINDOW_ICON_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <xcb/render.h>
+
+#include "bits/window_typedef.h"
+
+/* the largest width or height an icon is scaled down to */
+#define WINDOW_ICON_MAXIMUM_SIZE 64
+
+/* the maximum number of bytes read from `_NET_WM_ICON` */
+#define WINDOW_ICON_MAXIMUM_PROPERTY_SIZE (4 * 1024 * 1024)
+
+/* the largest width or height of an icon within `_NET_WM_ICON` */
+#define WINDOW_ICON_MAXIMUM_SOURCE_SIZE 1024
+
+/* A window icon that was scaled down and uploaded to the server.
+ *
+ * The icon is read from `_NET_WM_ICON` only once in chunks and each pixel is
+ * added to the pixel of the scaled icon it falls into right away, so the full
+ * size icon is never held in memory. All icons are in a least recently used
+ * list and the oldest are freed when they take up more than the configured
+ * `icon-cache-size`. A freed icon is marked stale and loaded again when it is
+ * needed.
+ */
+struct window_icon {
+    /* the window this icon belongs to */
+    Window *window;
+    /* the picture on the server */
+    xcb_render_picture_t picture;
+    /* the size the icon was scaled for */
+    uint32_t size;
+    /* the actual size of the picture, the aspect ratio is kept */
+    uint32_t width;
+    uint32_t height;
+    /* the icons used more and less recently than this one */
+    struct window_icon *newer;
+    struct window_icon *older;
+};
+
+/* Get the icon of @window scaled down so it fits into @size times @size.
+ *
+ * The icon is only read again when `_NET_WM_ICON` changed, when it was freed to
+ * stay within the configured cache size or when @size differs.
+ *
+ * @return NULL if the window has no icon or icons are disabled.
+ */
+struct window_icon *get_window_icon(Window *window, uint32_t size);
+
+/* Free the icon of @window. */
+void free_window_icon(Window *window);
+
+/* Get the number of cached icons and the number of bytes they take up on the
+ * server.
+ */
+void get_window_icon_cache_usage(uint32_t *number_of_icons, size_t *size);
+
+#endif
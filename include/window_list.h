@@ -18,8 +18,11 @@ extern struct window_list {
 /* Create the window list. */
 int initialize_window_list(void);
 
-/* Handle an incoming event for the window list. */
-void handle_window_list_event(xcb_generic_event_t *event);
+/* Render the window list.
+ *
+ * This hides the window list if there are no windows to show.
+ */
+void render_window_list(void);
 
 /* Show the window list on screen.
  *
@@ -30,4 +33,10 @@ void handle_window_list_event(xcb_generic_event_t *event);
  */
 int show_window_list(void);
 
+/* Hide the window list.
+ *
+ * The focus goes back to the focused window unless a window was selected.
+ */
+void hide_window_list(void);
+
 #endif
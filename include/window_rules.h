@@ -0,0 +1,95 @@
+#ifndef WINDOW_RULES_H
+#define WINDOW_RULES_H
+
+#include <stdint.h>
+
+#include <xcb/xcb.h>
+
+#include "bits/frame_typedef.h"
+#include "bits/window_typedef.h"
+
+#include "window_state.h"
+
+/* Window rules are configured in the `[rules]` section, for example:
+ * ```
+ * [rules]
+ * class Firefox frame left
+ * instance pavucontrol mode floating
+ * type dialog mode floating
+ * title *YouTube* mode fullscreen
+ * ```
+ *
+ * Patterns without `*` or `?` are exact matches and are put into hash tables,
+ * all other patterns of the same matcher are compiled into a single automaton
+ * that runs over the string only once.
+ *
+ * The rules are evaluated within `create_window()` before the window is shown
+ * for the first time so the window is configured directly with its final mode
+ * and frame. The `frame` part of a rule only applies to windows that are not
+ * mapped yet.
+ */
+
+/* what a window rule matches on
+ *
+ * NOTE: After editing this enum, also edit `rule_match_strings[]` in
+ * `configuration_parser.c`.
+ */
+typedef enum rule_match {
+    /* the instance name, the first string in `WM_CLASS` */
+    RULE_MATCH_INSTANCE,
+    /* the class name, the second string in `WM_CLASS` */
+    RULE_MATCH_CLASS,
+    /* the window title */
+    RULE_MATCH_TITLE,
+    /* a window type in `_NET_WM_WINDOW_TYPE`, for example: dialog */
+    RULE_MATCH_TYPE,
+
+    /* the maximum value of a rule matcher */
+    RULE_MATCH_MAX
+} rule_match_t;
+
+/* the frame a window rule puts a new tiling window into
+ *
+ * NOTE: After editing this enum, also edit `rule_frame_strings[]` in
+ * `configuration_parser.c`.
+ */
+typedef enum rule_frame {
+    /* no frame was specified, use the focused frame */
+    RULE_FRAME_FOCUS,
+    /* the frame at the left edge of the focused monitor */
+    RULE_FRAME_LEFT,
+    /* the frame at the top edge of the focused monitor */
+    RULE_FRAME_UP,
+    /* the frame at the right edge of the focused monitor */
+    RULE_FRAME_RIGHT,
+    /* the frame at the bottom edge of the focused monitor */
+    RULE_FRAME_DOWN,
+} rule_frame_t;
+
+/* Translate a window type name like "dialog" or "dropdown-menu" to the
+ * corresponding atom constant.
+ *
+ * @return ATOM_MAX if there is no window type with that name.
+ */
+uint32_t translate_string_to_window_type(const char *name);
+
+/* Compile the rules of the current configuration into the hash tables and
+ * automatons used by `apply_window_rules()`.
+ */
+void compile_window_rules(void);
+
+/* Apply all matching rules to a window that was just created.
+ *
+ * @types is the list of window types of the window terminated by `XCB_NONE`,
+ *        it may be NULL.
+ *
+ * Rules are applied in the order they were configured, so a later rule
+ * overwrites what an earlier rule set. The mode is written into @mode.
+ */
+void apply_window_rules(Window *window, const xcb_atom_t *types,
+        window_mode_t *mode);
+
+/* Get the frame a tiling window should be put into when it is shown. */
+Frame *get_window_rule_frame(Window *window);
+
+#endif
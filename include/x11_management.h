@@ -73,6 +73,8 @@
     /* UTF8_STRING */ X(_NET_WM_NAME) \
     /* name of the icon */ \
     /* UTF8_STRING */ X(_NET_WM_ICON_NAME) \
+    /* icons of different sizes: width, height and the ARGB pixels */ \
+    /* CARDINAL[][2+n] */ X(_NET_WM_ICON) \
     /* the desktop the window is on */ \
     /* CARDINAL */ X(_NET_WM_DESKTOP) \
     /* list of window types `_NET_WM_WINDOW_TYPE_*` */ \
@@ -87,6 +89,8 @@
     /* CARDINAL[12] */ X(_NET_WM_STRUT_PARTIAL) \
     /* process id of the process where the window was created from */ \
     /* CARDINAL */ X(_NET_WM_PID) \
+    /* the startup identifier the window was started with */ \
+    /* UTF8_STRING */ X(_NET_STARTUP_ID) \
     /* set on a window to indicate the frame sizes */ \
     /* CARDINAL[4] */ X(_NET_FRAME_EXTENTS) \
     /* set on a window to indicate the fullscreen region */ \
@@ -288,6 +292,42 @@ typedef enum {
 /* a state should be toggled (removed if it exists and added otherwise) */
 #define _NET_WM_STATE_TOGGLE 2
 
+/* Window properties that are only loaded when they are first needed. These are
+ * not needed to decide the window mode, the short lived windows never need them
+ * at all.
+ */
+/* the window name: `_NET_WM_NAME` or `WM_NAME` */
+#define LAZY_PROPERTY_NAME (1 << 0)
+/* the region of a fullscreen window: `_NET_WM_FULLSCREEN_MONITORS` */
+#define LAZY_PROPERTY_FULLSCREEN_MONITORS (1 << 1)
+/* the window icon: `_NET_WM_ICON`, this is loaded by `get_window_icon()`
+ * because it depends on the size the icon is shown at
+ */
+#define LAZY_PROPERTY_ICON (1 << 2)
+/* all lazy properties */
+#define LAZY_PROPERTY_ALL (LAZY_PROPERTY_NAME | \
+        LAZY_PROPERTY_FULLSCREEN_MONITORS | LAZY_PROPERTY_ICON)
+
+/* the maximum number of bytes of a window name that are stored, longer names
+ * are cut off at a character boundary
+ */
+#define MAXIMUM_NAME_SIZE 1024
+
+/* the maximum number of atoms read from an atom list like `_NET_WM_STATE` */
+#define MAXIMUM_ATOM_LIST_LENGTH 64
+
+/* the number of bytes requested at once by `read_property_in_chunks()`, this
+ * must be a multiple of 4
+ */
+#define PROPERTY_CHUNK_SIZE 65536
+
+/* Called by `read_property_in_chunks()` for each chunk of @length bytes.
+ *
+ * @return false to stop reading.
+ */
+typedef bool (*property_chunk_handler_t)(void *data, const void *chunk,
+        uint32_t length);
+
 typedef struct x_client {
     /* the id of the window */
     xcb_window_t id;
@@ -313,7 +353,15 @@ extern int x_file_descriptor;
 /* general purpose values for xcb function calls */
 extern uint32_t general_values[7];
 
-/* the selected X screen */
+/* The sequence number of the last request that mapped, unmapped, moved,
+ * resized or restacked a window.
+ *
+ * Crossing events up to this request were caused by windows changing under the
+ * mouse and not by the mouse moving.
+ */
+extern uint32_t last_layout_sequence;
+
+/* the X screen of the current managed screen, see `switch_screen()` */
 extern xcb_screen_t *screen;
 
 /* supporting wm check window */
@@ -329,23 +377,34 @@ static inline bool is_strut_empty(wm_strut_partial_t *strut)
         strut->reserved.right == 0 && strut->reserved.bottom == 0;
 }
 
-/* Initialize the X connection and the X atoms. */
+/* Initialize the X connection, the X atoms and the managed screens, see
+ * `screen.h`.
+ *
+ * When `DISPLAY` names a screen, for example `:0.1`, only that screen is
+ * managed. Otherwise all screens of the display are managed.
+ */
 int initialize_x11(void);
 
-/* Try to take control of the window manager role (also initialize the
- * fensterchef windows).
+/* Try to take control of the window manager role on all screens (also
+ * initialize the fensterchef windows).
+ *
+ * Screens other than the one named by `DISPLAY` that are managed by another
+ * window manager are left alone.
  *
  * Call this after `initialize_x11()`
  */
 int take_control(void);
 
-/* Go through all already existing windows and manage them.
+/* Go through all already existing windows of the current screen and manage
+ * them.
+ *
+ * Windows that are already managed are skipped.
  *
  * Call this after `initialize_monitors()`.
  */
 void query_existing_windows(void);
 
-/* Set the initial root window properties. */
+/* Set the initial root window properties of the current screen. */
 void initialize_root_properties(void);
 
 /* Set the input focus to @window. This window may be `NULL`. */
@@ -364,15 +423,46 @@ void configure_client(XClient *client, int32_t x, int32_t y, uint32_t width,
 /* Set the border color of @client. */
 void change_client_attributes(XClient *client, uint32_t border_color);
 
-/* Initialize all properties within @window.
+/* Initialize the properties within @window that decide the window mode.
+ *
+ * The other properties are marked as stale and loaded on demand, see
+ * `load_window_properties()`. The configured window rules are applied on top of
+ * the predicted mode.
  *
  * @return the mode the window should be in initially.
  */
 window_mode_t initialize_window_properties(Window *window);
 
-/* Update the property with @properties corresponding to given atom. */
+/* Update the property with @properties corresponding to given atom.
+ *
+ * Lazy properties are only marked as stale.
+ */
 bool cache_window_property(Window *window, xcb_atom_t atom);
 
+/* Make sure given lazy @properties of @window are loaded.
+ *
+ * @properties is a combination of `LAZY_PROPERTY_*` bits.
+ */
+void load_window_properties(Window *window, uint32_t properties);
+
+/* Load the stale lazy @properties of all windows. The requests for all windows
+ * are sent at once before waiting for any reply.
+ */
+void load_all_window_properties(uint32_t properties);
+
+/* Read a property that can be genuinely large, for example `_NET_WM_ICON`.
+ *
+ * The property is requested in chunks of `PROPERTY_CHUNK_SIZE` bytes and each
+ * chunk is passed to @handler as soon as it arrives. Reading stops after
+ * @maximum_size bytes. All chunk requests are sent at once after the first
+ * reply tells how large the property is.
+ *
+ * @return ERROR if the property does not exist or has the wrong format.
+ */
+int read_property_in_chunks(xcb_window_t window, xcb_atom_t property,
+        xcb_atom_t type, uint8_t format, uint32_t maximum_size,
+        property_chunk_handler_t handler, void *data);
+
 /* Check if @properties includes @protocol. */
 bool supports_protocol(Window *window, xcb_atom_t protocol);
 
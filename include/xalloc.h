@@ -1,8 +1,91 @@
 #ifndef XALLOC_H
 #define XALLOC_H
 
+#include <stdio.h>
 #include <stdlib.h>
 
+/* Memory accounting: when compiled with `MEMORY_ACCOUNTING` defined, every
+ * allocation made through the functions below is recorded together with its
+ * size and a tag naming the subsystem it belongs to. `free()` is redirected to
+ * `xfree()` so that the records are removed again.
+ *
+ * Memory not allocated by these functions (for example replies from the X
+ * server) is not accounted but can still be freed with `free()`.
+ *
+ * Without `MEMORY_ACCOUNTING`, tagging does nothing and there is no overhead.
+ */
+
+/* the subsystems memory is accounted to
+ *
+ * NOTE: After editing this enum, also edit `memory_tag_strings[]` in
+ * `xalloc.c`.
+ */
+typedef enum memory_tag {
+    /* memory not belonging to any of the below */
+    MEMORY_TAG_OTHER,
+    /* the window structs */
+    MEMORY_TAG_WINDOWS,
+    /* window names */
+    MEMORY_TAG_NAMES,
+    /* atom lists and other property arrays of windows */
+    MEMORY_TAG_PROPERTIES,
+    /* frames within the tiling layout */
+    MEMORY_TAG_FRAMES,
+    /* frames within the stash */
+    MEMORY_TAG_STASH,
+    /* font faces and glyphs */
+    MEMORY_TAG_GLYPHS,
+    /* window icons and the buffers for scaling them */
+    MEMORY_TAG_ICONS,
+    /* the configuration and compiled window rules */
+    MEMORY_TAG_CONFIGURATION,
+
+    /* the maximum value of a memory tag */
+    MEMORY_TAG_MAX
+} memory_tag_t;
+
+#ifdef MEMORY_ACCOUNTING
+
+/* Set the tag all following allocations are accounted to.
+ *
+ * @return the previous tag so it can be restored.
+ */
+memory_tag_t set_memory_tag(memory_tag_t tag);
+
+/* Account the memory at @pointer to @tag, @pointer may be NULL. */
+void tag_memory(void *pointer, memory_tag_t tag);
+
+/* Like `free()` but also remove the accounting record. */
+void xfree(void *pointer);
+
+#define free(pointer) xfree(pointer)
+
+#else
+
+/* Set the tag all following allocations are accounted to. */
+static inline memory_tag_t set_memory_tag(memory_tag_t tag)
+{
+    return tag;
+}
+
+/* Account the memory at @pointer to @tag, @pointer may be NULL. */
+static inline void tag_memory(void *pointer, memory_tag_t tag)
+{
+    (void) pointer;
+    (void) tag;
+}
+
+#endif
+
+/* Get the number of allocations made so far.
+ *
+ * @return 0 if memory accounting is not available.
+ */
+size_t get_number_of_allocations(void);
+
+/* Write the live bytes and number of allocations of each tag to @file. */
+void dump_memory_usage(FILE *file);
+
 /* Like `malloc()` but exit when the allocation fails. */
 void *xmalloc(size_t size);
 
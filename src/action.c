@@ -1,3 +1,8 @@
+/* needed for `setenv()` and `popen()` */
+#define _POSIX_C_SOURCE 200112L
+
+#include <errno.h>
+#include <inttypes.h>
 #include <unistd.h>
 #include <string.h> // strcmp()
 #include <sys/wait.h> // wait()
@@ -7,8 +12,14 @@
 #include "event.h"
 #include "fensterchef.h"
 #include "frame.h"
+#include "launch.h"
+#include "layout.h"
 #include "log.h"
 #include "monitor.h"
+#include "probe.h"
+#include "render.h"
+#include "restart.h"
+#include "screen.h"
 #include "stash_frame.h"
 #include "tiling.h"
 #include "utility.h"
@@ -54,6 +65,10 @@ static const struct {
     [ACTION_SHOW_MESSAGE] = { "SHOW-MESSAGE", PARSER_DATA_TYPE_STRING },
     [ACTION_SHOW_MESSAGE_RUN] = { "SHOW-MESSAGE-RUN", PARSER_DATA_TYPE_STRING },
     [ACTION_RESIZE_BY] = { "RESIZE-BY", PARSER_DATA_TYPE_QUAD },
+    [ACTION_SAVE_LAYOUT] = { "SAVE-LAYOUT", PARSER_DATA_TYPE_STRING },
+    [ACTION_RESTORE_LAYOUT] = { "RESTORE-LAYOUT", PARSER_DATA_TYPE_STRING },
+    [ACTION_DUMP_MEMORY] = { "DUMP-MEMORY", PARSER_DATA_TYPE_STRING },
+    [ACTION_RESTART] = { "RESTART", PARSER_DATA_TYPE_VOID },
     [ACTION_QUIT] = { "QUIT", PARSER_DATA_TYPE_VOID },
 };
 
@@ -103,15 +118,68 @@ void free_actions(Action *actions, uint32_t number_of_actions)
     free(actions);
 }
 
-/* Run given shell program. */
+/* Start running multiple actions as one transaction. */
+void begin_action_transaction(void)
+{
+    defer_window_layers();
+    defer_notification();
+}
+
+/* Send all changes collected since `begin_action_transaction()`. */
+void end_action_transaction(void)
+{
+    flush_window_layers();
+    flush_notification();
+}
+
+/* Get the display name of the current screen, for example `:0.1`.
+ *
+ * @return NULL if `DISPLAY` can not be parsed.
+ */
+static char *get_screen_display(void)
+{
+    char *host;
+    int display_number;
+    char *display;
+
+    if (xcb_parse_display(NULL, &host, &display_number, NULL) == 0) {
+        return NULL;
+    }
+    display = xasprintf("%s:%d.%d", host, display_number,
+            current_screen->number);
+    free(host);
+    return display;
+}
+
+/* Run given shell program.
+ *
+ * The program is told its startup identifier through `DESKTOP_STARTUP_ID` so
+ * that its first window is put into the frame focused right now. `DISPLAY`
+ * names the current screen so the program opens its windows there.
+ */
 static void run_shell(const char *shell)
 {
+    const char *startup_id;
+    char *display;
+    int process_pipe[2];
     int child_process_id;
+    pid_t process_id;
+
+    startup_id = begin_launch();
+    display = get_screen_display();
+
+    /* the child sends the process id of the grandchild through this pipe */
+    if (pipe(process_pipe) == -1) {
+        LOG_ERROR("could not create pipe: %s\n", strerror(errno));
+        process_pipe[0] = -1;
+        process_pipe[1] = -1;
+    }
 
     /* using `fork()` twice and `_exit()` will give the child process to the
      * init system so we do not need to worry about cleaning up dead child
-     * processes; we want to run the shell in a new session
-     * TODO: explain why `setsid()` is needed
+     * processes; we want to run the shell in a new session so that it is
+     * detached from the terminal fensterchef was started in, otherwise closing
+     * that terminal or pressing Ctrl+C in it would also end the program
      */
 
     /* create a child process */
@@ -120,24 +188,55 @@ static void run_shell(const char *shell)
         /* this code is executed in the child */
 
         /* create a grandchild process */
-        if (fork() == 0) {
-            /* make a new session */
+        process_id = fork();
+        if (process_id == 0) {
+            /* make a new session, this only fails if the process already
+             * leads a process group which a new process never does
+             */
             if (setsid() == -1) {
-                /* TODO: when does this happen? */
                 exit(EXIT_FAILURE);
             }
             /* this code is executed in the grandchild process */
+            if (process_pipe[1] != -1) {
+                (void) close(process_pipe[0]);
+                (void) close(process_pipe[1]);
+            }
+            if (startup_id[0] != '\0') {
+                (void) setenv("DESKTOP_STARTUP_ID", startup_id, true);
+            }
+            if (display != NULL) {
+                (void) setenv("DISPLAY", display, true);
+            }
             (void) execl("/bin/sh", "sh", "-c", shell, (char*) NULL);
             /* this point is only reached if `execl()` failed */
             exit(EXIT_FAILURE);
         } else {
+            if (process_pipe[1] != -1 && process_id > 0 &&
+                    write(process_pipe[1], &process_id, sizeof(process_id)) !=
+                        sizeof(process_id)) {
+                LOG_ERROR("could not send the process id: %s\n",
+                        strerror(errno));
+            }
             /* exit the child process */
             _exit(0);
         }
     } else {
         /* wait until the child process exits */
         (void) waitpid(child_process_id, NULL, 0);
+        if (process_pipe[1] != -1) {
+            (void) close(process_pipe[1]);
+            /* `sh -c` replaces itself with simple commands, so this is
+             * usually the process id of the program
+             */
+            if (read(process_pipe[0], &process_id, sizeof(process_id)) ==
+                    sizeof(process_id)) {
+                set_launch_process(startup_id, process_id);
+            }
+            (void) close(process_pipe[0]);
+        }
     }
+
+    free(display);
 }
 
 /* Run a shell and get the output. */
@@ -169,6 +268,35 @@ static char *run_shell_and_get_output(const char *shell)
     return line;
 }
 
+/* Write the memory usage to the file at @file_name. */
+static void dump_memory_to_file(const char *file_name)
+{
+    FILE *file;
+    struct glyph_cache_statistics statistics;
+    uint32_t number_of_icons;
+    size_t icon_cache_size;
+
+    file = fopen(file_name, "w");
+    if (file == NULL) {
+        LOG_ERROR("could not open %s: %s\n", file_name, strerror(errno));
+        return;
+    }
+    dump_memory_usage(file);
+
+    get_glyph_cache_statistics(&statistics);
+    fprintf(file, "glyph cache: %" PRIu32 " glyphs, %zu bytes, "
+                "%" PRIu64 " hits, %" PRIu64 " misses, "
+                "%" PRIu64 " evictions\n",
+            statistics.number_of_glyphs, statistics.size,
+            statistics.hits, statistics.misses, statistics.evictions);
+
+    get_window_icon_cache_usage(&number_of_icons, &icon_cache_size);
+    fprintf(file, "icon cache: %" PRIu32 " icons, %zu bytes\n",
+            number_of_icons, icon_cache_size);
+    fclose(file);
+    LOG("dumped the memory usage to %s\n", file_name);
+}
+
 /* Resize the current window or current frame if it does not exist. */
 static void resize_frame_or_window_by(Window *window, int32_t left, int32_t top,
         int32_t right, int32_t bottom)
@@ -484,7 +612,14 @@ static void move_to_below_frame(Frame *relative, bool do_exchange)
 /* Do the given action. */
 void do_action(const Action *action, Window *window)
 {
+    /* the window might be gone after the action */
+    const xcb_window_t window_id = window == NULL ? XCB_NONE :
+        window->client.id;
     char *shell;
+    uint64_t start;
+
+    start = START_PROBE_TIMER(action__end);
+    PROBE2(action__start, action->code, window_id);
 
     switch (action->code) {
     /* invalid action value */
@@ -659,10 +794,34 @@ void do_action(const Action *action, Window *window)
     /* toggle visibility of the interactive window list */
     case ACTION_SHOW_WINDOW_LIST:
         if (show_window_list() == ERROR) {
-            unmap_client(&window_list.client);
+            hide_window_list();
         }
         break;
 
+    /* save the current frames */
+    case ACTION_SAVE_LAYOUT:
+        save_layout((char*) action->parameter.string);
+        break;
+
+    /* restore previously saved frames */
+    case ACTION_RESTORE_LAYOUT:
+        if (restore_layout((char*) action->parameter.string) != OK) {
+            set_notification((utf8_t*) "No such layout",
+                    focus_frame->x + focus_frame->width / 2,
+                    focus_frame->y + focus_frame->height / 2);
+        }
+        break;
+
+    /* write the memory usage of each subsystem to a file */
+    case ACTION_DUMP_MEMORY:
+        dump_memory_to_file((char*) action->parameter.string);
+        break;
+
+    /* restart fensterchef in place */
+    case ACTION_RESTART:
+        restart_fensterchef();
+        break;
+
     /* quit fensterchef */
     case ACTION_QUIT:
         is_fensterchef_running = false;
@@ -701,4 +860,49 @@ void do_action(const Action *action, Window *window)
     case ACTION_MAX:
         break;
     }
+
+    PROBE3(action__end, action->code, window_id, GET_PROBE_DURATION(start));
+}
+
+/* Check if repetitions of @action can be merged. */
+bool is_action_repeatable(const Action *action)
+{
+    switch (action->code) {
+    case ACTION_FOCUS_UP:
+    case ACTION_FOCUS_LEFT:
+    case ACTION_FOCUS_RIGHT:
+    case ACTION_FOCUS_DOWN:
+    case ACTION_NEXT_WINDOW:
+    case ACTION_PREVIOUS_WINDOW:
+    case ACTION_RESIZE_BY:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+/* Do @action @count times on the focused window as if it was a single action.
+ */
+void do_repeated_action(const Action *action, uint32_t count)
+{
+    Action summed;
+
+    switch (action->code) {
+    /* resize once by the sum of all deltas */
+    case ACTION_RESIZE_BY:
+        summed = *action;
+        for (uint32_t i = 0; i < SIZE(summed.parameter.quad); i++) {
+            summed.parameter.quad[i] *= (int32_t) count;
+        }
+        do_action(&summed, focus_window);
+        break;
+
+    /* moving the focus depends on the previous move */
+    default:
+        for (uint32_t i = 0; i < count; i++) {
+            do_action(action, focus_window);
+        }
+        break;
+    }
 }
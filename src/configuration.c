@@ -9,6 +9,7 @@
 #include "log.h"
 #include "monitor.h"
 #include "render.h"
+#include "screen.h"
 #include "utility.h"
 #include "window.h"
 #include "window_list.h"
@@ -46,6 +47,17 @@ static void duplicate_configuration_key_bindings(
     }
 }
 
+/* Copy the window rules of @duplicate into itself. */
+static void duplicate_configuration_rules(struct configuration *duplicate)
+{
+    duplicate->rules.rules = xmemdup(duplicate->rules.rules,
+            sizeof(*duplicate->rules.rules) * duplicate->rules.number_of_rules);
+    for (uint32_t i = 0; i < duplicate->rules.number_of_rules; i++) {
+        struct configuration_rule *const rule = &duplicate->rules.rules[i];
+        rule->pattern = (uint8_t*) xstrdup((char*) rule->pattern);
+    }
+}
+
 /* Create a deep copy of @duplicate and put it into itself. */
 void duplicate_configuration(struct configuration *duplicate)
 {
@@ -56,6 +68,7 @@ void duplicate_configuration(struct configuration *duplicate)
             duplicate->startup.number_of_actions);
     duplicate_configuration_button_bindings(duplicate);
     duplicate_configuration_key_bindings(duplicate);
+    duplicate_configuration_rules(duplicate);
 }
 
 /* Clear the resources given configuration occupies. */
@@ -79,6 +92,12 @@ void clear_configuration(struct configuration *configuration)
                 configuration->keyboard.keys[i].number_of_actions);
     }
     free(configuration->keyboard.keys);
+
+    /* free window rules */
+    for (uint32_t i = 0; i < configuration->rules.number_of_rules; i++) {
+        free(configuration->rules.rules[i].pattern);
+    }
+    free(configuration->rules.rules);
 }
 
 /* Load the user configuration and merge it into the current configuration. */
@@ -99,9 +118,11 @@ void reload_user_configuration(void)
         path = xstrdup(fensterchef_configuration);
     }
 
+    const memory_tag_t previous_tag = set_memory_tag(MEMORY_TAG_CONFIGURATION);
     if (load_configuration_file(path, &configuration) == OK) {
         set_configuration(&configuration);
     }
+    (void) set_memory_tag(previous_tag);
 
     free(path);
 }
@@ -131,16 +152,11 @@ struct configuration_button *find_configured_button(
     return NULL;
 }
 
-/* Grab the mousebindings so we receive MousePress/MouseRelease events for
- * them.
- */
-void grab_configured_buttons(void)
+/* Grab the mousebindings on @root. */
+static void grab_configured_buttons_on(xcb_window_t root)
 {
-    xcb_window_t root;
     struct configuration_button *button;
 
-    root = screen->root;
-
     /* remove all previously grabbed buttons so that we can overwrite them */
     xcb_ungrab_button(connection, XCB_GRAB_ANY, root, XCB_MOD_MASK_ANY);
 
@@ -175,6 +191,16 @@ void grab_configured_buttons(void)
     }
 }
 
+/* Grab the mousebindings so we receive MousePress/MouseRelease events for
+ * them.
+ */
+void grab_configured_buttons(void)
+{
+    for (uint32_t i = 0; i < number_of_managed_screens; i++) {
+        grab_configured_buttons_on(managed_screens[i].screen->root);
+    }
+}
+
 /* Get a key from key modifiers and a key symbol. */
 struct configuration_key *find_configured_key(
         struct configuration *configuration,
@@ -182,7 +208,10 @@ struct configuration_key *find_configured_key(
 {
     struct configuration_key *key;
 
-    modifiers &= ~configuration->keyboard.ignore_modifiers;
+    /* remove the ignored modifiers but also ~0xff which is all the mouse button
+     * masks and the keyboard group
+     */
+    modifiers &= ~(configuration->keyboard.ignore_modifiers | ~0xff);
     flags &= ~BINDING_FLAG_TRANSPARENT;
 
     /* find a matching key (the keysym AND modifiers must match up) */
@@ -196,16 +225,12 @@ struct configuration_key *find_configured_key(
     return NULL;
 }
 
-/* Grab the keybindings so we receive the KeyPress/KeyRelease events for them.
- */
-void grab_configured_keys(void)
+/* Grab the keybindings on @root. */
+static void grab_configured_keys_on(xcb_window_t root)
 {
-    xcb_window_t root;
     xcb_keycode_t *keycodes;
     uint16_t modifiers;
 
-    root = screen->root;
-
     /* remove all previously grabbed keys so that we can overwrite them */
     xcb_ungrab_key(connection, XCB_GRAB_ANY, root, XCB_MOD_MASK_ANY);
 
@@ -247,19 +272,22 @@ void grab_configured_keys(void)
     }
 }
 
-/* Compare the current configuration with the new configuration and set it. */
-void set_configuration(struct configuration *new_configuration)
+/* Grab the keybindings so we receive the KeyPress/KeyRelease events for them.
+ */
+void grab_configured_keys(void)
 {
-    struct configuration old_configuration;
-    xcb_render_color_t color;
-
-    old_configuration = configuration;
-    configuration = *new_configuration;
-
-    /* reload the font */
-    if (configuration.font.name != NULL) {
-        set_font(configuration.font.name);
+    for (uint32_t i = 0; i < number_of_managed_screens; i++) {
+        grab_configured_keys_on(managed_screens[i].screen->root);
     }
+}
+
+/* Apply the changes from @old_configuration to the current configuration to
+ * the windows and stock objects of the current screen.
+ */
+static void apply_configuration_changes(
+        const struct configuration *old_configuration)
+{
+    xcb_render_color_t color;
 
     /* refresh the border size and color of all windows */
     for (Window *window = first_window; window != NULL; window = window->next) {
@@ -271,6 +299,17 @@ void set_configuration(struct configuration *new_configuration)
         window->border_size = configuration.border.size;
     }
 
+    /* select or deselect the crossing events for focus follows mouse */
+    if (old_configuration->mouse.focus_follows_mouse !=
+            configuration.mouse.focus_follows_mouse) {
+        general_values[0] = get_window_event_mask();
+        for (Window *window = first_window; window != NULL;
+                window = window->next) {
+            xcb_change_window_attributes(connection, window->client.id,
+                    XCB_CW_EVENT_MASK, general_values);
+        }
+    }
+
     /* reload all frames */
     for (Monitor *monitor = first_monitor; monitor != NULL;
             monitor = monitor->next) {
@@ -293,23 +332,23 @@ void set_configuration(struct configuration *new_configuration)
             window_list.client.height, configuration.notification.border_size);
 
     /* check if notification background changed */
-    if (old_configuration.notification.background !=
+    if (old_configuration->notification.background !=
             configuration.notification.background) {
         convert_color_to_xcb_color(&color,
                 configuration.notification.background);
         set_pen_color(stock_objects[STOCK_WHITE_PEN], color);
     }
     /* check if notification foreground changed */
-    if (old_configuration.notification.foreground !=
+    if (old_configuration->notification.foreground !=
             configuration.notification.foreground) {
         convert_color_to_xcb_color(&color,
                 configuration.notification.foreground);
         set_pen_color(stock_objects[STOCK_BLACK_PEN], color);
     }
     /* check if notification foreground or background changed */
-    if (old_configuration.notification.foreground !=
+    if (old_configuration->notification.foreground !=
             configuration.notification.foreground ||
-            old_configuration.notification.background !=
+            old_configuration->notification.background !=
                 configuration.notification.background) {
         general_values[0] = configuration.notification.background;
         general_values[1] = configuration.notification.foreground;
@@ -321,11 +360,35 @@ void set_configuration(struct configuration *new_configuration)
         xcb_change_gc(connection, stock_objects[STOCK_INVERTED_GC],
                 XCB_GC_FOREGROUND | XCB_GC_BACKGROUND, general_values);
     }
+}
+
+/* Compare the current configuration with the new configuration and set it. */
+void set_configuration(struct configuration *new_configuration)
+{
+    struct configuration old_configuration;
+    const uint32_t current_index = get_current_screen_index();
+
+    old_configuration = configuration;
+    configuration = *new_configuration;
+
+    /* reload the font */
+    if (configuration.font.name != NULL) {
+        set_font(configuration.font.name);
+    }
+
+    for (uint32_t i = 0; i < number_of_managed_screens; i++) {
+        switch_screen(i);
+        apply_configuration_changes(&old_configuration);
+    }
+    switch_screen(current_index);
 
     /* re-grab all bindings */
     grab_configured_buttons();
     grab_configured_keys();
 
+    /* build the hash tables and automatons of the new rules */
+    compile_window_rules();
+
     /* free the resources of the old configuration */
     clear_configuration(&old_configuration);
 }
@@ -359,6 +422,9 @@ int load_configuration_file(const char *file_name,
     parser.configuration->mouse.number_of_buttons = 0;
     parser.configuration->keyboard.keys = NULL;
     parser.configuration->keyboard.number_of_keys = 0;
+    /* disregard all previous rules */
+    parser.configuration->rules.rules = NULL;
+    parser.configuration->rules.number_of_rules = 0;
     duplicate_configuration(parser.configuration);
 
     /* parse file line by line */
@@ -439,6 +505,14 @@ int load_configuration_file(const char *file_name,
         duplicate_configuration_key_bindings(parser.configuration);
     }
 
+    /* set the existing rules if no rules section is specified */
+    if (!parser.has_label[PARSER_LABEL_RULES]) {
+        parser.configuration->rules.rules = configuration.rules.rules;
+        parser.configuration->rules.number_of_rules =
+            configuration.rules.number_of_rules;
+        duplicate_configuration_rules(parser.configuration);
+    }
+
     LOG("successfully read configuration file: %s\n", file_name);
 
     return OK;
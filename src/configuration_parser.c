@@ -16,6 +16,7 @@ static const char *parser_error_strings[] = {
         STRINGIFY(PARSER_IDENTIFIER_LIMIT),
     [PARSER_ERROR_INVALID_LABEL] = "invalid label name",
     [PARSER_ERROR_MISSING_CLOSING] = "missing a closing ']'",
+    [PARSER_ERROR_MISSING_QUOTE] = "missing a closing '\"'",
     [PARSER_ERROR_NOT_IN_LABEL] = "not in a label yet, use `[<label>]` on a previous line",
     [PARSER_ERROR_INVALID_BOOLEAN] = "invalid boolean value",
     [PARSER_ERROR_INVALID_VARIABLE_NAME] = "the current label does not have that variable name",
@@ -28,6 +29,9 @@ static const char *parser_error_strings[] = {
     [PARSER_ERROR_INVALID_KEY_SYMBOL] = "invalid key symbol name",
     [PARSER_ERROR_MISSING_ACTION] = "action value is missing",
     [PARSER_ERROR_INVALID_ACTION] = "invalid action value",
+    [PARSER_ERROR_INVALID_RULE_MATCHER] = "invalid rule matcher (expect instance, class, title or type)",
+    [PARSER_ERROR_INVALID_WINDOW_TYPE] = "invalid window type",
+    [PARSER_ERROR_INVALID_RULE_EFFECT] = "invalid rule effect (expect mode <mode> or frame <frame>)",
     [PARSER_ERROR_UNEXPECTED] = "unexpected tokens"
 };
 
@@ -96,6 +100,31 @@ static const struct button_string {
      */
 };
 
+/* conversion from string to rule matcher */
+static const char *rule_match_strings[] = {
+    [RULE_MATCH_INSTANCE] = "instance",
+    [RULE_MATCH_CLASS] = "class",
+    [RULE_MATCH_TITLE] = "title",
+    [RULE_MATCH_TYPE] = "type",
+};
+
+/* conversion from string to window mode */
+static const char *window_mode_strings[] = {
+    [WINDOW_MODE_TILING] = "tiling",
+    [WINDOW_MODE_FLOATING] = "floating",
+    [WINDOW_MODE_FULLSCREEN] = "fullscreen",
+    [WINDOW_MODE_DOCK] = "dock",
+};
+
+/* conversion from string to rule frame */
+static const char *rule_frame_strings[] = {
+    [RULE_FRAME_FOCUS] = "focus",
+    [RULE_FRAME_LEFT] = "left",
+    [RULE_FRAME_UP] = "up",
+    [RULE_FRAME_RIGHT] = "right",
+    [RULE_FRAME_DOWN] = "down",
+};
+
 /* The void data type is just a placeholder, it expects nothing. */
 static parser_error_t parse_void(Parser *parser)
 {
@@ -167,6 +196,9 @@ static parser_error_t parse_mouse_binding(Parser *parser);
 /* Parse a binding for the keyboard. */
 static parser_error_t parse_keyboard_binding(Parser *parser);
 
+/* Parse a window rule. */
+static parser_error_t parse_window_rule(Parser *parser);
+
 /* variables in the form <name> <value> */
 static const struct parser_label_name {
     /* the string representation of the label */
@@ -211,6 +243,8 @@ static const struct parser_label_name {
         "font", NULL, {
         { "name", PARSER_DATA_TYPE_STRING,
             offsetof(struct configuration, font.name) },
+        { "cache-size", PARSER_DATA_TYPE_INTEGER,
+            offsetof(struct configuration, font.cache_size) },
         /* null terminate the end */
         { NULL, 0, 0 } }
     },
@@ -251,6 +285,8 @@ static const struct parser_label_name {
             offsetof(struct configuration, notification.background) },
         { "foreground", PARSER_DATA_TYPE_COLOR,
             offsetof(struct configuration, notification.foreground) },
+        { "icon-cache-size", PARSER_DATA_TYPE_INTEGER,
+            offsetof(struct configuration, notification.icon_cache_size) },
         /* null terminate the end */
         { NULL, 0, 0 } }
     },
@@ -259,6 +295,10 @@ static const struct parser_label_name {
         "mouse", parse_mouse_binding, {
         { "resize-tolerance", PARSER_DATA_TYPE_INTEGER,
             offsetof(struct configuration, mouse.resize_tolerance) },
+        { "focus-follows-mouse", PARSER_DATA_TYPE_BOOLEAN,
+            offsetof(struct configuration, mouse.focus_follows_mouse) },
+        { "focus-delay", PARSER_DATA_TYPE_INTEGER,
+            offsetof(struct configuration, mouse.focus_delay) },
         { "modifiers", PARSER_DATA_TYPE_MODIFIERS,
             offsetof(struct configuration, mouse.modifiers) },
         { "ignore-modifiers", PARSER_DATA_TYPE_MODIFIERS,
@@ -276,6 +316,12 @@ static const struct parser_label_name {
         /* null terminate the end */
         { NULL, 0, 0 } }
     },
+
+    [PARSER_LABEL_RULES] = {
+        "rules", parse_window_rule, {
+        /* null terminate the end */
+        { NULL, 0, 0 } }
+    },
 };
 
 /* Merges the default mousebindings into the current parser mousebindings. */
@@ -365,6 +411,23 @@ static uint16_t translate_string_to_modifier(const char *string)
     return INVALID_MODIFIER;
 }
 
+/* Find @string within @strings.
+ *
+ * @return the index of the string or @number_of_strings if it is not found.
+ */
+static uint32_t translate_string_to_index(const char **strings,
+        uint32_t number_of_strings, const char *string)
+{
+    uint32_t i;
+
+    for (i = 0; i < number_of_strings; i++) {
+        if (strcasecmp(strings[i], string) == 0) {
+            break;
+        }
+    }
+    return i;
+}
+
 /* Converts @error to a string. */
 const char *parser_string_error(parser_error_t error)
 {
@@ -963,6 +1026,150 @@ static parser_error_t parse_keyboard_binding(Parser *parser)
     return PARSER_SUCCESS;
 }
 
+/* Parse the effects of a window rule, e.g.: `mode floating frame left`. */
+static parser_error_t parse_rule_effects(Parser *parser)
+{
+    parser_error_t error;
+    struct configuration_rule *const rule = &parser->rule;
+
+    rule->mode = WINDOW_MODE_MAX;
+    rule->frame = RULE_FRAME_FOCUS;
+
+    /* a rule without any effect is pointless */
+    skip_space(parser);
+    if (parser->line[parser->column] == '\0') {
+        return PARSER_ERROR_PREMATURE_LINE_END;
+    }
+
+    while (skip_space(parser), parser->line[parser->column] != '\0') {
+        error = parse_identifier(parser);
+        if (error != PARSER_SUCCESS) {
+            return error;
+        }
+
+        if (strcasecmp(parser->identifier, "mode") == 0) {
+            error = parse_identifier(parser);
+            if (error != PARSER_SUCCESS) {
+                return error;
+            }
+            rule->mode = translate_string_to_index(window_mode_strings,
+                    SIZE(window_mode_strings), parser->identifier);
+            if (rule->mode == SIZE(window_mode_strings)) {
+                return PARSER_ERROR_INVALID_RULE_EFFECT;
+            }
+        } else if (strcasecmp(parser->identifier, "frame") == 0) {
+            error = parse_identifier(parser);
+            if (error != PARSER_SUCCESS) {
+                return error;
+            }
+            rule->frame = translate_string_to_index(rule_frame_strings,
+                    SIZE(rule_frame_strings), parser->identifier);
+            if (rule->frame == SIZE(rule_frame_strings)) {
+                return PARSER_ERROR_INVALID_RULE_EFFECT;
+            }
+        } else {
+            return PARSER_ERROR_INVALID_RULE_EFFECT;
+        }
+    }
+    return PARSER_SUCCESS;
+}
+
+/* Parse the pattern of a window rule into @parser->rule.pattern.
+ *
+ * The pattern goes until the next space. It may be put into double quotes to
+ * include spaces and a backslash takes the next character literally, e.g.:
+ * `"Mozilla Firefox"` or `Mozilla\ Firefox`.
+ */
+static parser_error_t parse_pattern(Parser *parser)
+{
+    bool is_quoted = false;
+    char *pattern;
+    size_t length = 0;
+    char character;
+
+    skip_space(parser);
+    parser->item_start_column = parser->column;
+
+    if (parser->line[parser->column] == '"') {
+        is_quoted = true;
+        parser->column++;
+    }
+
+    /* the pattern is never longer than the rest of the line */
+    pattern = xmalloc(strlen(&parser->line[parser->column]) + 1);
+    while (character = parser->line[parser->column], character != '\0') {
+        if (is_quoted ? character == '"' : isspace(character)) {
+            break;
+        }
+        if (character == '\\' && parser->line[parser->column + 1] != '\0') {
+            parser->column++;
+            character = parser->line[parser->column];
+        }
+        pattern[length++] = character;
+        parser->column++;
+    }
+
+    if (is_quoted) {
+        if (parser->line[parser->column] != '"') {
+            free(pattern);
+            return PARSER_ERROR_MISSING_QUOTE;
+        }
+        parser->column++;
+    }
+
+    if (length == 0) {
+        free(pattern);
+        return PARSER_ERROR_PREMATURE_LINE_END;
+    }
+
+    pattern[length] = '\0';
+    parser->rule.pattern = (uint8_t*) pattern;
+    return PARSER_SUCCESS;
+}
+
+/* Parse a window rule, e.g.: `class Firefox frame left`. */
+static parser_error_t parse_window_rule(Parser *parser)
+{
+    parser_error_t error;
+    struct configuration_rule *const rule = &parser->rule;
+
+    error = parse_identifier(parser);
+    if (error != PARSER_SUCCESS) {
+        return error;
+    }
+    rule->match = translate_string_to_index(rule_match_strings,
+            SIZE(rule_match_strings), parser->identifier);
+    if (rule->match == RULE_MATCH_MAX) {
+        return PARSER_ERROR_INVALID_RULE_MATCHER;
+    }
+
+    error = parse_pattern(parser);
+    if (error != PARSER_SUCCESS) {
+        return error;
+    }
+
+    /* window types are known in advance */
+    if (rule->match == RULE_MATCH_TYPE &&
+            translate_string_to_window_type((char*) rule->pattern) ==
+                ATOM_MAX) {
+        free(rule->pattern);
+        return PARSER_ERROR_INVALID_WINDOW_TYPE;
+    }
+
+    error = parse_rule_effects(parser);
+    if (error != PARSER_SUCCESS) {
+        free(rule->pattern);
+        return error;
+    }
+
+    RESIZE(parser->configuration->rules.rules,
+            parser->configuration->rules.number_of_rules + 1);
+    parser->configuration->rules.rules[
+        parser->configuration->rules.number_of_rules] = *rule;
+    parser->configuration->rules.number_of_rules++;
+    return PARSER_SUCCESS;
+}
+
 /* Parses and handles given textual line. */
 parser_error_t parse_line(Parser *parser)
 {
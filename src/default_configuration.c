@@ -19,9 +19,10 @@ static const struct configuration default_configuration = {
         .auto_fill_void = true
     },
 
-    /* default font settings: Mono */
+    /* default font settings: Mono with 256 KiB for the glyphs */
     .font = {
-        .name = (utf8_t*) "Mono"
+        .name = (utf8_t*) "Mono",
+        .cache_size = 256
     },
 
     /* default border settings: no borders */
@@ -35,7 +36,7 @@ static const struct configuration default_configuration = {
         .outer = { 0, 0, 0, 0 }
     },
 
-    /* default notification settings */
+    /* default notification settings: 256 KiB for the window icons */
     .notification = {
         .duration = 2,
         .padding = 6,
@@ -43,6 +44,7 @@ static const struct configuration default_configuration = {
         .border_size = 1,
         .foreground = 0x000000,
         .background = 0xffffff,
+        .icon_cache_size = 256,
     },
 
     /* default mouse settings: Mod4 as main modifier, see
@@ -50,6 +52,8 @@ static const struct configuration default_configuration = {
      */
     .mouse = {
         .resize_tolerance = 8,
+        .focus_follows_mouse = false,
+        .focus_delay = 0,
         .modifiers = XCB_MOD_MASK_4,
         .ignore_modifiers = XCB_MOD_MASK_LOCK | XCB_MOD_MASK_2 |
             XCB_MOD_MASK_3 | XCB_MOD_MASK_5,
@@ -249,6 +253,10 @@ void merge_with_default_key_bindings(struct configuration *configuration)
                     "[ -n \"$TERMINAL\" ] && exec \"$TERMINAL\" || exec xterm"
             } } },
 
+        /* restart fensterchef without losing the layout */
+        { XCB_MOD_MASK_CONTROL | XCB_MOD_MASK_SHIFT, 0, XK_r,
+            { .code = ACTION_RESTART } },
+
         /* quit fensterchef */
         { XCB_MOD_MASK_CONTROL | XCB_MOD_MASK_SHIFT, 0, XK_e,
             { .code = ACTION_QUIT } }
@@ -305,6 +313,9 @@ void merge_with_default_key_bindings(struct configuration *configuration)
 void load_default_configuration(void)
 {
     struct configuration configuration;
+    memory_tag_t previous_tag;
+
+    previous_tag = set_memory_tag(MEMORY_TAG_CONFIGURATION);
 
     /* create a duplicate of the default configuration */
     configuration = default_configuration;
@@ -315,4 +326,6 @@ void load_default_configuration(void)
     merge_with_default_key_bindings(&configuration);
 
     set_configuration(&configuration);
+
+    (void) set_memory_tag(previous_tag);
 }
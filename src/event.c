@@ -5,6 +5,7 @@
 #include <unistd.h>
 
 #include <xcb/randr.h>
+#include <xcb/xcb_event.h>
 
 #include "configuration.h"
 #include "event.h"
@@ -13,6 +14,9 @@
 #include "keymap.h"
 #include "log.h"
 #include "monitor.h"
+#include "placement.h"
+#include "probe.h"
+#include "screen.h"
 #include "tiling.h"
 #include "utility.h"
 #include "window.h"
@@ -54,6 +58,101 @@ static struct {
     Point start;
 } move_resize;
 
+/* focus follows mouse state, crossing events only remember the window and the
+ * focus is given once at the end of a cycle or after the focus delay
+ */
+static struct {
+    /* the window the mouse moved into, `XCB_NONE` if there is none */
+    xcb_window_t window;
+    /* the monotonic time in milliseconds at which `window` gets the focus */
+    uint64_t focus_time;
+} pointer_focus;
+
+/* the number of events in one cycle at which load shedding starts */
+#define LOAD_SHEDDING_START_THRESHOLD 512
+
+/* the number of events in one cycle at which load shedding stops */
+#define LOAD_SHEDDING_STOP_THRESHOLD 64
+
+/* the maximum number of events taken out of the queue in one cycle */
+#define MAXIMUM_EVENTS_PER_CYCLE 4096
+
+/* the events taken out of the queue in the current cycle */
+static struct {
+    /* the events, handled events are set to NULL */
+    xcb_generic_event_t **events;
+    /* the number of events in `events` */
+    uint32_t number_of_events;
+    /* the number of allocated events */
+    uint32_t capacity;
+    /* the index of the next event to handle */
+    uint32_t position;
+    /* if there were more events than `MAXIMUM_EVENTS_PER_CYCLE` */
+    bool is_truncated;
+    /* if only input events are taken out of the batch, this is set while the
+     * input events are handled first, see `handle_event_batch()`
+     */
+    bool is_input_only;
+} event_batch;
+
+/* When a client floods the server with events, the window manager is in load
+ * shedding mode: input events are handled before all other events, property
+ * notifications that are overwritten later in the same cycle are skipped and
+ * redrawing the window list and writing the client list are deferred until
+ * the flood ends.
+ */
+static bool is_shedding_load;
+
+/* a property of a window, used to find overwritten property notifications */
+struct property_key {
+    /* the window the property is on, `XCB_NONE` for an empty slot */
+    xcb_window_t window;
+    /* the changed property */
+    xcb_atom_t atom;
+};
+
+/* a configure request merged from all requests of a window within one batch of
+ * events
+ */
+struct configure_request {
+    /* the window that requested a new geometry */
+    xcb_window_t window;
+    /* if the window was managed when the request came in */
+    bool is_managed;
+    /* if the window is throttled and the request is kept for a later cycle */
+    bool is_deferred;
+    /* which of the values below are set */
+    uint16_t value_mask;
+    /* the requested position and size */
+    int32_t x;
+    int32_t y;
+    uint32_t width;
+    uint32_t height;
+};
+
+/* the configure requests collected during the current batch of events */
+static struct {
+    /* the pending requests */
+    struct configure_request *requests;
+    /* the number of pending requests */
+    uint32_t number_of_requests;
+    /* the number of allocated requests */
+    uint32_t capacity;
+} pending_configures;
+
+/* the registered handlers of a specific event type */
+struct event_dispatch {
+    /* the handlers to call, the first is called first */
+    event_handler_t handlers[EVENT_HANDLERS_MAX];
+    /* the number of registered handlers */
+    uint32_t number_of_handlers;
+    /* how many events of this type were received */
+    uint64_t count;
+};
+
+/* the event handlers indexed by the event type */
+static struct event_dispatch event_dispatch_table[EVENT_TYPE_MAX];
+
 /* Handle an incoming alarm. */
 static void alarm_handler(int signal)
 {
@@ -128,14 +227,17 @@ void synchronize_client_list(void)
 /* Synchronize the local data with the X server. */
 void synchronize_with_server(void)
 {
-    /* the old work area */
-    static Rectangle workarea;
-
+    Rectangle *const workarea = &current_screen->workarea;
     Monitor *monitor;
     Rectangle rectangle;
 
     xcb_atom_t state_atom;
 
+    uint64_t start;
+
+    start = START_PROBE_TIMER(synchronize__end);
+    PROBE(synchronize__start);
+
     /**
      * since the strut of a monitor might have changed because a window with
      * strut got hidden or shown, we need to recompute those
@@ -155,34 +257,34 @@ void synchronize_with_server(void)
     rectangle.height = 0;
     /* recompute all struts */
     for (Window *window = first_window; window != NULL; window = window->next) {
-        if (!window->state.is_visible) {
+        if (!window->state.is_visible || !window->has_strut) {
             continue;
         }
         monitor = get_monitor_from_rectangle_or_primary(window->x,
                 window->y, window->width, window->height);
 
-        monitor->strut.left += window->strut.reserved.left;
-        monitor->strut.top += window->strut.reserved.top;
-        monitor->strut.right += window->strut.reserved.right;
-        monitor->strut.bottom += window->strut.reserved.bottom;
+        monitor->strut.left += window->properties->strut.reserved.left;
+        monitor->strut.top += window->properties->strut.reserved.top;
+        monitor->strut.right += window->properties->strut.reserved.right;
+        monitor->strut.bottom += window->properties->strut.reserved.bottom;
 
-        rectangle.x += window->strut.reserved.left;
-        rectangle.y += window->strut.reserved.top;
-        rectangle.width += window->strut.reserved.right;
-        rectangle.height += window->strut.reserved.bottom;
+        rectangle.x += window->properties->strut.reserved.left;
+        rectangle.y += window->properties->strut.reserved.top;
+        rectangle.width += window->properties->strut.reserved.right;
+        rectangle.height += window->properties->strut.reserved.bottom;
     }
 
     /* set the work area if it changed */
     rectangle.width = screen->width_in_pixels - rectangle.x - rectangle.width;
     rectangle.height = screen->height_in_pixels - rectangle.y -
         rectangle.height;
-    if (rectangle.x != workarea.x ||
-            rectangle.y != workarea.y ||
-            rectangle.width != workarea.width ||
-            rectangle.height != workarea.height) {
-        workarea = rectangle;
+    if (rectangle.x != workarea->x ||
+            rectangle.y != workarea->y ||
+            rectangle.width != workarea->width ||
+            rectangle.height != workarea->height) {
+        *workarea = rectangle;
         xcb_change_property(connection, XCB_PROP_MODE_REPLACE, screen->root,
-                ATOM(_NET_WORKAREA), XCB_ATOM_CARDINAL, 32, 4, &workarea);
+                ATOM(_NET_WORKAREA), XCB_ATOM_CARDINAL, 32, 4, workarea);
     }
 
     /* resize all frames to their according size */
@@ -208,26 +310,599 @@ void synchronize_with_server(void)
         state_atom = ATOM(_NET_WM_STATE_HIDDEN);
         remove_window_states(window, &state_atom, 1);
         map_client(&window->client);
+        update_window_free_space(window);
     }
 
     /* unmap all invisible windows */
     for (Window *window = bottom_window; window != NULL;
             window = window->above) {
         if (!window->state.is_visible) {
+            update_window_free_space(window);
             state_atom = ATOM(_NET_WM_STATE_HIDDEN);
             add_window_states(window, &state_atom, 1);
             unmap_client(&window->client);
         }
     }
+
+    PROBE1(synchronize__end, GET_PROBE_DURATION(start));
+}
+
+/* Find the pending configure request of @xcb_window or create a new one. */
+static struct configure_request *get_configure_request(xcb_window_t xcb_window)
+{
+    struct configure_request *request;
+
+    for (uint32_t i = 0; i < pending_configures.number_of_requests; i++) {
+        request = &pending_configures.requests[i];
+        if (request->window == xcb_window) {
+            return request;
+        }
+    }
+
+    if (pending_configures.number_of_requests ==
+            pending_configures.capacity) {
+        pending_configures.capacity *= 2;
+        pending_configures.capacity += 8;
+        RESIZE(pending_configures.requests, pending_configures.capacity);
+    }
+
+    request = &pending_configures.requests[
+        pending_configures.number_of_requests++];
+    request->window = xcb_window;
+    request->is_deferred = false;
+    request->value_mask = 0;
+    return request;
+}
+
+/* Apply the configure requests of unmanaged and floating windows collected
+ * during the last batch of events.
+ */
+static void apply_configure_requests(void)
+{
+    const uint64_t now = get_monotonic_milliseconds();
+    struct configure_request *request;
+    Window *window;
+    int value_index;
+
+    for (uint32_t i = 0; i < pending_configures.number_of_requests; i++) {
+        request = &pending_configures.requests[i];
+        window = switch_to_window_screen(request->window) ?
+            get_window_of_xcb_window(request->window) : NULL;
+
+        /* keep the merged request of a throttled window until its interval
+         * is over
+         */
+        request->is_deferred = window != NULL &&
+            window->properties->configure_throttle.release_time != 0 &&
+            !release_throttle(&window->properties->configure_throttle, now);
+        if (request->is_deferred) {
+            continue;
+        }
+
+        /* the window is now managed, let the tiling decide the size */
+        if (window != NULL) {
+            if (window->state.mode != WINDOW_MODE_FLOATING) {
+                continue;
+            }
+            set_window_size(window,
+                    (request->value_mask & XCB_CONFIG_WINDOW_X) ?
+                        request->x : window->x,
+                    (request->value_mask & XCB_CONFIG_WINDOW_Y) ?
+                        request->y : window->y,
+                    (request->value_mask & XCB_CONFIG_WINDOW_WIDTH) ?
+                        request->width : window->width,
+                    (request->value_mask & XCB_CONFIG_WINDOW_HEIGHT) ?
+                        request->height : window->height);
+            continue;
+        }
+
+        /* the window got destroyed in the meantime */
+        if (request->is_managed) {
+            continue;
+        }
+
+        value_index = 0;
+        if ((request->value_mask & XCB_CONFIG_WINDOW_X)) {
+            general_values[value_index++] = request->x;
+        }
+        if ((request->value_mask & XCB_CONFIG_WINDOW_Y)) {
+            general_values[value_index++] = request->y;
+        }
+        if ((request->value_mask & XCB_CONFIG_WINDOW_WIDTH)) {
+            general_values[value_index++] = request->width;
+        }
+        if ((request->value_mask & XCB_CONFIG_WINDOW_HEIGHT)) {
+            general_values[value_index++] = request->height;
+        }
+        last_layout_sequence = xcb_configure_window(connection,
+                request->window, request->value_mask, general_values).sequence;
+    }
+}
+
+/* Send a synthetic ConfigureNotify to all windows whose configure request was
+ * denied. This must be called after the windows were synchronized with the
+ * server so the final geometry is reported.
+ *
+ * According to the ICCCM, a client must receive a ConfigureNotify even when the
+ * window manager decides not to change the window. Some clients keep asking
+ * otherwise.
+ */
+static void answer_configure_requests(void)
+{
+    uint32_t number_of_deferred = 0;
+    struct configure_request *request;
+    Window *window;
+    char event_data[32];
+    xcb_configure_notify_event_t *event;
+
+    for (uint32_t i = 0; i < pending_configures.number_of_requests; i++) {
+        request = &pending_configures.requests[i];
+        if (request->is_deferred) {
+            pending_configures.requests[number_of_deferred++] = *request;
+            continue;
+        }
+
+        window = switch_to_window_screen(request->window) ?
+            get_window_of_xcb_window(request->window) : NULL;
+        if (window == NULL ||
+                window->state.mode == WINDOW_MODE_FLOATING) {
+            continue;
+        }
+
+        LOG("sending synthetic configure notify to %W\n", window);
+
+        /* bake an event telling the window its actual position and size */
+        event = (xcb_configure_notify_event_t*) event_data;
+        memset(event_data, 0, sizeof(event_data));
+        event->response_type = XCB_CONFIGURE_NOTIFY;
+        event->event = window->client.id;
+        event->window = window->client.id;
+        event->above_sibling = XCB_NONE;
+        event->x = window->client.x;
+        event->y = window->client.y;
+        event->width = window->client.width;
+        event->height = window->client.height;
+        event->border_width = window->client.border_width;
+        event->override_redirect = false;
+        xcb_send_event(connection, false, window->client.id,
+                XCB_EVENT_MASK_STRUCTURE_NOTIFY, event_data);
+    }
+    /* the deferred requests were moved to the front */
+    pending_configures.number_of_requests = number_of_deferred;
+}
+
+/* Get the window an event is about for the probes.
+ *
+ * @return XCB_NONE if the event is not about a window.
+ */
+static xcb_window_t get_event_window(const xcb_generic_event_t *event)
+{
+    switch (event->response_type & ~0x80) {
+    /* these all have the same layout as a key press event */
+    case XCB_KEY_PRESS:
+    case XCB_KEY_RELEASE:
+    case XCB_BUTTON_PRESS:
+    case XCB_BUTTON_RELEASE:
+    case XCB_MOTION_NOTIFY:
+    case XCB_ENTER_NOTIFY:
+    case XCB_LEAVE_NOTIFY:
+        return ((xcb_key_press_event_t*) event)->event;
+
+    /* focus changes of a window */
+    case XCB_FOCUS_IN:
+    case XCB_FOCUS_OUT:
+        return ((xcb_focus_in_event_t*) event)->event;
+
+    /* events that tell about a specific window */
+    case XCB_EXPOSE:
+        return ((xcb_expose_event_t*) event)->window;
+    case XCB_CREATE_NOTIFY:
+        return ((xcb_create_notify_event_t*) event)->window;
+    case XCB_DESTROY_NOTIFY:
+        return ((xcb_destroy_notify_event_t*) event)->window;
+    case XCB_UNMAP_NOTIFY:
+        return ((xcb_unmap_notify_event_t*) event)->window;
+    case XCB_MAP_NOTIFY:
+        return ((xcb_map_notify_event_t*) event)->window;
+    case XCB_MAP_REQUEST:
+        return ((xcb_map_request_event_t*) event)->window;
+    case XCB_REPARENT_NOTIFY:
+        return ((xcb_reparent_notify_event_t*) event)->window;
+    case XCB_CONFIGURE_NOTIFY:
+        return ((xcb_configure_notify_event_t*) event)->window;
+    case XCB_CONFIGURE_REQUEST:
+        return ((xcb_configure_request_event_t*) event)->window;
+    case XCB_PROPERTY_NOTIFY:
+        return ((xcb_property_notify_event_t*) event)->window;
+    case XCB_CLIENT_MESSAGE:
+        return ((xcb_client_message_event_t*) event)->window;
+    }
+    return XCB_NONE;
+}
+
+/* Check if @event is input of the user. */
+static bool is_input_event(const xcb_generic_event_t *event)
+{
+    switch (event->response_type & ~0x80) {
+    case XCB_KEY_PRESS:
+    case XCB_KEY_RELEASE:
+    case XCB_BUTTON_PRESS:
+    case XCB_BUTTON_RELEASE:
+        return true;
+    }
+    return false;
+}
+
+/* Take the next event out of the current batch, if the batch is exhausted, take
+ * it out of the queue.
+ *
+ * While `event_batch.is_input_only` is set, other events are left within the
+ * batch and the queue is not touched because all events in the batch come
+ * before the queued ones.
+ *
+ * @return NULL if there is no event.
+ */
+static xcb_generic_event_t *take_next_event(void)
+{
+    xcb_generic_event_t *event;
+
+    while (event_batch.position < event_batch.number_of_events) {
+        event = event_batch.events[event_batch.position];
+        event_batch.position++;
+        if (event == NULL) {
+            continue;
+        }
+        if (event_batch.is_input_only && !is_input_event(event)) {
+            continue;
+        }
+        event_batch.events[event_batch.position - 1] = NULL;
+        return event;
+    }
+
+    if (event_batch.is_input_only) {
+        return NULL;
+    }
+
+    event = xcb_poll_for_event(connection);
+    if (event != NULL) {
+        PROBE2(event__receive, event->response_type & ~0x80,
+                get_event_window(event));
+    }
+    return event;
+}
+
+/* Take all queued events out of the queue and put them into the batch. */
+static void collect_events(void)
+{
+    xcb_generic_event_t *event;
+
+    event_batch.number_of_events = 0;
+    event_batch.position = 0;
+    while (event_batch.number_of_events < MAXIMUM_EVENTS_PER_CYCLE &&
+            (event = xcb_poll_for_event(connection)) != NULL) {
+        PROBE2(event__receive, event->response_type & ~0x80,
+                get_event_window(event));
+        if (event_batch.number_of_events == event_batch.capacity) {
+            event_batch.capacity += 64;
+            RESIZE(event_batch.events, event_batch.capacity);
+        }
+        event_batch.events[event_batch.number_of_events++] = event;
+    }
+    event_batch.is_truncated =
+        event_batch.number_of_events == MAXIMUM_EVENTS_PER_CYCLE;
+}
+
+/* Start or stop load shedding depending on the number of events in the batch.
+ */
+static void update_load_shedding(void)
+{
+    const uint32_t count = event_batch.number_of_events;
+
+    if (!is_shedding_load && count >= LOAD_SHEDDING_START_THRESHOLD) {
+        LOG("received %" PRIu32 " events in one cycle, shedding load\n",
+                count);
+        is_shedding_load = true;
+    } else if (is_shedding_load && count < LOAD_SHEDDING_STOP_THRESHOLD) {
+        LOG("received %" PRIu32 " events in one cycle, "
+                "stopped shedding load\n", count);
+        is_shedding_load = false;
+    }
+}
+
+/* Drop property notifications of the batch that are followed by another
+ * notification for the same property of the same window.
+ */
+static void drop_overwritten_property_notifications(void)
+{
+    static struct property_key *keys;
+    static uint32_t keys_capacity;
+    uint32_t capacity;
+    uint32_t index;
+    xcb_property_notify_event_t *event;
+
+    /* keep the load factor at 0.5 or below */
+    for (capacity = 64; capacity < event_batch.number_of_events * 2;
+            capacity *= 2) {
+        /* nothing */
+    }
+    if (capacity > keys_capacity) {
+        RESIZE(keys, capacity);
+        keys_capacity = capacity;
+    }
+    memset(keys, 0, sizeof(*keys) * capacity);
+
+    /* go backwards so the last notification of each property is kept */
+    for (uint32_t i = event_batch.number_of_events; i > 0; i--) {
+        event = (xcb_property_notify_event_t*) event_batch.events[i - 1];
+        if (event == NULL ||
+                (event->response_type & ~0x80) != XCB_PROPERTY_NOTIFY) {
+            continue;
+        }
+
+        index = ((event->window * 31) ^ event->atom) & (capacity - 1);
+        while (keys[index].window != XCB_NONE &&
+                (keys[index].window != event->window ||
+                 keys[index].atom != event->atom)) {
+            index = (index + 1) & (capacity - 1);
+        }
+
+        if (keys[index].window != XCB_NONE) {
+            free(event);
+            event_batch.events[i - 1] = NULL;
+        } else {
+            keys[index].window = event->window;
+            keys[index].atom = event->atom;
+        }
+    }
+}
+
+/* Handle a single event of the batch. */
+static void handle_batch_event(xcb_generic_event_t *event)
+{
+    handle_event(event);
+
+    if (is_reload_requested) {
+        reload_user_configuration();
+        is_reload_requested = false;
+    }
+
+    free(event);
+}
+
+/* Handle all events of the batch, when shedding load, the input events are
+ * handled first.
+ */
+static void handle_event_batch(void)
+{
+    xcb_generic_event_t *event;
+
+    if (is_shedding_load) {
+        drop_overwritten_property_notifications();
+
+        /* handlers looking ahead, like the merging of key repeats, only get
+         * the input events following this one, the other events are handled
+         * in order afterwards
+         */
+        event_batch.is_input_only = true;
+        for (uint32_t i = 0; i < event_batch.number_of_events; i++) {
+            event = event_batch.events[i];
+            if (event == NULL || !is_input_event(event)) {
+                continue;
+            }
+
+            event_batch.events[i] = NULL;
+            event_batch.position = i + 1;
+            handle_batch_event(event);
+        }
+        event_batch.is_input_only = false;
+        event_batch.position = 0;
+    }
+
+    while (event_batch.position < event_batch.number_of_events) {
+        event = take_next_event();
+        if (event == NULL) {
+            break;
+        }
+        handle_batch_event(event);
+    }
+}
+
+/* Remember that @atom of @window changed while its property changes are
+ * throttled.
+ */
+static void defer_window_property(Window *window, xcb_atom_t atom)
+{
+    struct window_properties *const properties = window->properties;
+
+    /* merge multiple changes of the same property */
+    for (uint32_t i = 0; i < properties->number_of_deferred_properties; i++) {
+        if (properties->deferred_properties[i] == atom) {
+            return;
+        }
+    }
+
+    RESIZE(properties->deferred_properties,
+            properties->number_of_deferred_properties + 1);
+    tag_memory(properties->deferred_properties, MEMORY_TAG_PROPERTIES);
+    properties->deferred_properties[
+        properties->number_of_deferred_properties++] = atom;
+}
+
+/* Apply the deferred properties of all windows whose throttle interval is
+ * over.
+ */
+static void apply_deferred_properties(void)
+{
+    const uint64_t now = get_monotonic_milliseconds();
+
+    for (Window *window = first_window; window != NULL;
+            window = window->next) {
+        if (!window->is_throttled) {
+            continue;
+        }
+
+        struct window_properties *const properties = window->properties;
+        if (!release_throttle(&properties->property_throttle, now)) {
+            continue;
+        }
+
+        for (uint32_t i = 0; i < properties->number_of_deferred_properties;
+                i++) {
+            (void) cache_window_property(window,
+                    properties->deferred_properties[i]);
+        }
+        properties->number_of_deferred_properties = 0;
+    }
+}
+
+/* Log how many events of @window were deferred and reset the counts. */
+void log_deferred_events(Window *window)
+{
+    struct window_properties *const properties = window->properties;
+
+    if (properties->property_throttle.deferred_events == 0 &&
+            properties->configure_throttle.deferred_events == 0) {
+        return;
+    }
+
+    LOG("deferred %" PRIu64 " property change(s) and %" PRIu64
+            " configure request(s) of throttled window %W\n",
+            properties->property_throttle.deferred_events,
+            properties->configure_throttle.deferred_events, window);
+
+    properties->property_throttle.deferred_events = 0;
+    properties->configure_throttle.deferred_events = 0;
+}
+
+/* Set @release_time to the earliest release time of the throttles of @window
+ * if it comes before it, a throttled window whose intervals are over is no
+ * longer marked as throttled.
+ */
+static void update_release_time(Window *window, uint64_t *release_time)
+{
+    const struct throttle *const property_throttle =
+        &window->properties->property_throttle;
+    const struct throttle *const configure_throttle =
+        &window->properties->configure_throttle;
+
+    /* both intervals are over */
+    if (property_throttle->release_time == 0 &&
+            configure_throttle->release_time == 0) {
+        window->is_throttled = false;
+        log_deferred_events(window);
+        return;
+    }
+
+    if (property_throttle->release_time != 0 &&
+            (*release_time == 0 ||
+             property_throttle->release_time < *release_time)) {
+        *release_time = property_throttle->release_time;
+    }
+    if (configure_throttle->release_time != 0 &&
+            (*release_time == 0 ||
+             configure_throttle->release_time < *release_time)) {
+        *release_time = configure_throttle->release_time;
+    }
+}
+
+/* Get the time until the next throttle interval of any window on any screen is
+ * over.
+ *
+ * @return the number of milliseconds or -1 if no window is throttled.
+ */
+static int32_t get_remaining_throttle_time(void)
+{
+    const uint64_t now = get_monotonic_milliseconds();
+    uint64_t release_time = 0;
+
+    for (uint32_t i = 0; i < number_of_managed_screens; i++) {
+        switch_screen(i);
+        for (Window *window = first_window; window != NULL;
+                window = window->next) {
+            if (window->is_throttled) {
+                update_release_time(window, &release_time);
+            }
+        }
+    }
+
+    if (release_time == 0) {
+        return -1;
+    }
+    if (now >= release_time) {
+        return 0;
+    }
+    return release_time - now;
+}
+
+/* Get the time until the window the mouse moved into should get the focus.
+ *
+ * @return the number of milliseconds or -1 if no window is waiting.
+ */
+static int32_t get_remaining_focus_delay(void)
+{
+    uint64_t now;
+
+    if (pointer_focus.window == XCB_NONE) {
+        return -1;
+    }
+
+    now = get_monotonic_milliseconds();
+    if (now >= pointer_focus.focus_time) {
+        return 0;
+    }
+    return pointer_focus.focus_time - now;
+}
+
+/* Give the focus to the window the mouse moved into if the focus delay passed.
+ */
+static void focus_pointer_window(void)
+{
+    Window *window;
+
+    if (get_remaining_focus_delay() != 0) {
+        return;
+    }
+
+    window = switch_to_window_screen(pointer_focus.window) ?
+        get_window_of_xcb_window(pointer_focus.window) : NULL;
+    pointer_focus.window = XCB_NONE;
+    if (window == NULL || window == focus_window ||
+            !window->state.is_visible || !does_window_accept_focus(window)) {
+        return;
+    }
+
+    LOG("focusing %W because the mouse moved into it\n", window);
+    set_focus_window_with_frame(window);
+}
+
+/* Update the window list, the client list and the focus of the current screen
+ * after the events of a cycle were handled.
+ */
+static void finish_screen_cycle(void)
+{
+    /* update the window list to reflect the changes of this cycle */
+    if (window_list.client.is_mapped && !is_shedding_load) {
+        render_window_list();
+    }
+
+    /* update the client list properties */
+    if (has_client_list_changed && !is_shedding_load) {
+        synchronize_client_list();
+        has_client_list_changed = false;
+    }
+
+    if (current_screen->old_focus_window != focus_window) {
+        set_input_focus(focus_window);
+    }
 }
 
 /* Run the next cycle of the event loop. */
 int next_cycle(void)
 {
     int connection_error;
-    Window *old_focus_window;
-    xcb_generic_event_t *event;
     fd_set set;
+    int32_t remaining, throttle_remaining;
+    struct timeval timeout;
 
     connection_error = xcb_connection_has_error(connection);
     if (!is_fensterchef_running || connection_error > 0) {
@@ -237,45 +912,77 @@ int next_cycle(void)
         return ERROR;
     }
 
-    old_focus_window = focus_window;
+    /* remember the focus of each screen to see which changed */
+    for (uint32_t i = 0; i < number_of_managed_screens; i++) {
+        switch_screen(i);
+        current_screen->old_focus_window = focus_window;
+    }
 
     /* prepare `set` for `select()` */
     FD_ZERO(&set);
     FD_SET(x_file_descriptor, &set);
 
+    /* wake up when the window under the mouse should get the focus or when
+     * the updates of a throttled window need to be applied
+     */
+    remaining = get_remaining_focus_delay();
+    throttle_remaining = get_remaining_throttle_time();
+    if (remaining < 0 || (throttle_remaining >= 0 &&
+                throttle_remaining < remaining)) {
+        remaining = throttle_remaining;
+    }
+    /* do not wait if events were left in the queue */
+    if (event_batch.is_truncated) {
+        remaining = 0;
+    }
+    if (remaining >= 0) {
+        timeout.tv_sec = remaining / 1000;
+        timeout.tv_usec = (remaining % 1000) * 1000;
+    }
+
     /* using select here is key: select will block until data on the file
-     * descriptor for the X connection arrives; when a signal is received,
-     * `select()` will however also unblock and return -1
+     * descriptor for the X connection arrives or the timeout expires; when a
+     * signal is received, `select()` will however also unblock and return -1
      */
-    if (select(x_file_descriptor + 1, &set, NULL, NULL, NULL) > 0) {
+    if (select(x_file_descriptor + 1, &set, NULL, NULL,
+                remaining >= 0 ? &timeout : NULL) >= 0) {
         /* handle all received events */
-        while (event = xcb_poll_for_event(connection), event != NULL) {
-            handle_window_list_event(event);
+        collect_events();
+        update_load_shedding();
+        handle_event_batch();
 
-            handle_event(event);
+        /* apply the keyboard mapping changes of this cycle */
+        flush_keymap_refresh();
 
-            if (is_reload_requested) {
-                reload_user_configuration();
-                is_reload_requested = false;
-            }
+        /* focus the last window the mouse moved into */
+        focus_pointer_window();
 
-            free(event);
+        /* apply the merged changes of throttled windows */
+        for (uint32_t i = 0; i < number_of_managed_screens; i++) {
+            switch_screen(i);
+            apply_deferred_properties();
         }
 
-        synchronize_with_server();
-        /* update the client list properties */
-        if (has_client_list_changed) {
-            synchronize_client_list();
-            has_client_list_changed = false;
+        apply_configure_requests();
+
+        for (uint32_t i = 0; i < number_of_managed_screens; i++) {
+            switch_screen(i);
+            synchronize_with_server();
         }
 
-        if (old_focus_window != focus_window) {
-            set_input_focus(focus_window);
+        answer_configure_requests();
+
+        for (uint32_t i = 0; i < number_of_managed_screens; i++) {
+            switch_screen(i);
+            finish_screen_cycle();
         }
     }
 
     if (has_timer_expired) {
-        unmap_client(&notification);
+        for (uint32_t i = 0; i < number_of_managed_screens; i++) {
+            switch_screen(i);
+            unmap_client(&notification);
+        }
         has_timer_expired = false;
     }
 
@@ -427,31 +1134,228 @@ static void cancel_window_move_resize(void)
     move_resize.window = NULL;
 }
 
-/* Key press events are sent when a grabbed key is pressed. */
-static void handle_key_press(xcb_key_press_event_t *event)
+/* Check if a crossing event was caused by the mouse moving from one window to
+ * another.
+ */
+static bool is_mouse_crossing(xcb_enter_notify_event_t *event)
+{
+    /* ignore crossings caused by grabs and the mouse moving between a window
+     * and its inferiors
+     */
+    if (event->mode != XCB_NOTIFY_MODE_NORMAL ||
+            event->detail == XCB_NOTIFY_DETAIL_INFERIOR) {
+        return false;
+    }
+
+    /* windows appearing, moving or going away under the mouse also cause
+     * crossings, the server generates them while handling our request so they
+     * carry the sequence number of that request or an earlier one
+     */
+    if ((int16_t) (event->sequence - (uint16_t) last_layout_sequence) <= 0) {
+        return false;
+    }
+    return true;
+}
+
+/* Enter notifications are sent when the mouse moves into a window.
+ *
+ * Only the window is remembered, the focus is given by `focus_pointer_window()`
+ * so that crossing many windows in one swipe changes the focus only once.
+ */
+static void handle_enter_notify(xcb_generic_event_t *generic_event)
+{
+    xcb_enter_notify_event_t *const event =
+        (xcb_enter_notify_event_t*) generic_event;
+
+    if (!configuration.mouse.focus_follows_mouse ||
+            move_resize.window != NULL || !is_mouse_crossing(event)) {
+        return;
+    }
+
+    /* restart the delay for every window the mouse moves into */
+    pointer_focus.window = event->event;
+    pointer_focus.focus_time = get_monotonic_milliseconds() +
+        configuration.mouse.focus_delay;
+}
+
+/* Leave notifications are sent when the mouse moves out of a window. */
+static void handle_leave_notify(xcb_generic_event_t *generic_event)
+{
+    xcb_leave_notify_event_t *const event =
+        (xcb_leave_notify_event_t*) generic_event;
+
+    if (!configuration.mouse.focus_follows_mouse ||
+            !is_mouse_crossing(event)) {
+        return;
+    }
+
+    /* the mouse left before the delay passed */
+    if (pointer_focus.window == event->event) {
+        pointer_focus.window = XCB_NONE;
+    }
+}
+
+/* Check if the repeats of @key can be merged into a single run. */
+static bool is_key_repeatable(const struct configuration_key *key)
+{
+    /* every repeat of a transparent key needs to be replayed */
+    if ((key->flags & BINDING_FLAG_TRANSPARENT)) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < key->number_of_actions; i++) {
+        if (!is_action_repeatable(&key->actions[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Take the autorepeats of the key of @event out of the event queue.
+ *
+ * Each repeat is either a release and press pair with the same time or only a
+ * press when the server uses detectable autorepeat, see `initialize_keymap()`.
+ *
+ * The keyboard must be thawed before calling this, otherwise the server holds
+ * back all repeats.
+ *
+ * @leftover receives the events that were taken out of the queue but are no
+ *           repeats, they need to be handled afterwards.
+ *
+ * @return the number of repeats, this is 0 if the key was already released
+ *         because then all queued repeats are stale.
+ */
+static uint32_t take_key_repeats(xcb_key_press_event_t *event,
+        xcb_generic_event_t *leftover[2], uint32_t *number_of_leftover)
+{
+    uint32_t repeats = 0;
+    xcb_generic_event_t *next;
+    xcb_key_press_event_t *press;
+    xcb_key_release_event_t *release;
+
+    *number_of_leftover = 0;
+    while (next = take_next_event(), next != NULL) {
+        switch (next->response_type & ~0x80) {
+        /* a repeat without a release */
+        case XCB_KEY_PRESS:
+            press = (xcb_key_press_event_t*) next;
+            if (press->detail != event->detail ||
+                    press->state != event->state) {
+                leftover[(*number_of_leftover)++] = next;
+                return repeats;
+            }
+            break;
+
+        /* either the first half of a repeat or the actual release */
+        case XCB_KEY_RELEASE:
+            release = (xcb_key_release_event_t*) next;
+            if (release->detail != event->detail) {
+                leftover[(*number_of_leftover)++] = next;
+                return repeats;
+            }
+
+            next = take_next_event();
+            press = (xcb_key_press_event_t*) next;
+            if (next == NULL ||
+                    (next->response_type & ~0x80) != XCB_KEY_PRESS ||
+                    press->detail != event->detail ||
+                    press->time != release->time) {
+                leftover[(*number_of_leftover)++] = (xcb_generic_event_t*)
+                    release;
+                if (next != NULL) {
+                    leftover[(*number_of_leftover)++] = next;
+                }
+                /* the key was released while the repeats were queued */
+                if (repeats > 0) {
+                    LOG("dropping %" PRIu32 " stale key repeat(s)\n", repeats);
+                }
+                return 0;
+            }
+            free(release);
+            break;
+
+        /* any other event ends the repeats */
+        default:
+            leftover[(*number_of_leftover)++] = next;
+            return repeats;
+        }
+
+        /* without detectable autorepeat, the press of the repeat activated the
+         * synchronous grab again and froze the keyboard, its handlers do not
+         * run so thaw it here and send the request right away so that the
+         * server can send the next repeat
+         */
+        xcb_allow_events(connection, XCB_ALLOW_ASYNC_KEYBOARD, press->time);
+        xcb_flush(connection);
+        free(next);
+        repeats++;
+    }
+    return repeats;
+}
+
+/* Key press events are sent when a grabbed key is pressed.
+ *
+ * Repeats of keys bound to repeatable actions that are already queued are
+ * merged into a single run of the actions.
+ */
+static void handle_key_press(xcb_generic_event_t *generic_event)
 {
+    xcb_key_press_event_t *const event = (xcb_key_press_event_t*) generic_event;
     struct configuration_key *key;
+    uint32_t repeats;
+    xcb_generic_event_t *leftover[2];
+    uint32_t number_of_leftover;
 
     key = find_configured_key(&configuration, event->state,
             get_keysym(event->detail), 0);
-    if (key != NULL) {
-        LOG("performing action(s): %A\n", key->number_of_actions,
-                key->actions);
+    if (key == NULL) {
+        return;
+    }
+
+    if (is_key_repeatable(key)) {
+        /* the synchronous grab froze the keyboard, no repeat is sent until it
+         * is thawed
+         */
+        xcb_allow_events(connection, XCB_ALLOW_ASYNC_KEYBOARD, event->time);
+        xcb_flush(connection);
+
+        repeats = take_key_repeats(event, leftover, &number_of_leftover);
+        LOG("performing action(s) %" PRIu32 " time(s): %A\n", repeats + 1,
+                key->number_of_actions, key->actions);
+        begin_action_transaction();
         for (uint32_t i = 0; i < key->number_of_actions; i++) {
-            do_action(&key->actions[i], focus_window);
+            do_repeated_action(&key->actions[i], repeats + 1);
         }
+        end_action_transaction();
 
-        /* make the event pass through to the focused client */
-        if ((key->flags & BINDING_FLAG_TRANSPARENT)) {
-            xcb_allow_events(connection, XCB_ALLOW_REPLAY_KEYBOARD,
-                    event->time);
+        /* handle the events that came after the repeats */
+        for (uint32_t i = 0; i < number_of_leftover; i++) {
+            handle_event(leftover[i]);
+            free(leftover[i]);
         }
+        return;
+    }
+
+    LOG("performing action(s): %A\n", key->number_of_actions,
+            key->actions);
+    begin_action_transaction();
+    for (uint32_t i = 0; i < key->number_of_actions; i++) {
+        do_action(&key->actions[i], focus_window);
+    }
+    end_action_transaction();
+
+    /* make the event pass through to the focused client */
+    if ((key->flags & BINDING_FLAG_TRANSPARENT)) {
+        xcb_allow_events(connection, XCB_ALLOW_REPLAY_KEYBOARD,
+                event->time);
     }
 }
 
 /* Key release events are sent when a grabbed key is released. */
-static void handle_key_release(xcb_key_release_event_t *event)
+static void handle_key_release(xcb_generic_event_t *generic_event)
 {
+    xcb_key_release_event_t *const event =
+        (xcb_key_release_event_t*) generic_event;
     struct configuration_key *key;
 
     key = find_configured_key(&configuration, event->state,
@@ -459,9 +1363,11 @@ static void handle_key_release(xcb_key_release_event_t *event)
     if (key != NULL) {
         LOG("performing action(s): %A\n", key->number_of_actions,
                 key->actions);
+        begin_action_transaction();
         for (uint32_t i = 0; i < key->number_of_actions; i++) {
             do_action(&key->actions[i], focus_window);
         }
+        end_action_transaction();
 
         /* make the event pass through to the focused client */
         if ((key->flags & BINDING_FLAG_TRANSPARENT)) {
@@ -472,8 +1378,10 @@ static void handle_key_release(xcb_key_release_event_t *event)
 }
 
 /* Button press events are sent when a grabbed button is pressed. */
-static void handle_button_press(xcb_button_press_event_t *event)
+static void handle_button_press(xcb_generic_event_t *generic_event)
 {
+    xcb_button_press_event_t *const event =
+        (xcb_button_press_event_t*) generic_event;
     Window *window;
     struct configuration_button *button;
 
@@ -496,9 +1404,11 @@ static void handle_button_press(xcb_button_press_event_t *event)
     if (button != NULL) {
         LOG("performing action(s): %A\n", button->number_of_actions,
                 button->actions);
+        begin_action_transaction();
         for (uint32_t i = 0; i < button->number_of_actions; i++) {
             do_action(&button->actions[i], window);
         }
+        end_action_transaction();
 
         /* make the event pass through to the underlying window */
         if ((button->flags & BINDING_FLAG_TRANSPARENT)) {
@@ -508,8 +1418,10 @@ static void handle_button_press(xcb_button_press_event_t *event)
 }
 
 /* Button releases are sent when a grabbed button is released. */
-static void handle_button_release(xcb_button_release_event_t *event)
+static void handle_button_release(xcb_generic_event_t *generic_event)
 {
+    xcb_button_release_event_t *const event =
+        (xcb_button_release_event_t*) generic_event;
     Window *window;
     struct configuration_button *button;
 
@@ -533,9 +1445,11 @@ static void handle_button_release(xcb_button_release_event_t *event)
     if (button != NULL) {
         LOG("performing action(s): %A\n", button->number_of_actions,
                 button->actions);
+        begin_action_transaction();
         for (uint32_t i = 0; i < button->number_of_actions; i++) {
             do_action(&button->actions[i], window);
         }
+        end_action_transaction();
 
         /* make the event pass through to the underlying window */
         if ((button->flags & BINDING_FLAG_TRANSPARENT)) {
@@ -547,8 +1461,10 @@ static void handle_button_release(xcb_button_release_event_t *event)
 /* Motion notifications (mouse move events) are only sent when we grabbed them.
  * This only happens when a floating window is being moved.
  */
-static void handle_motion_notify(xcb_motion_notify_event_t *event)
+static void handle_motion_notify(xcb_generic_event_t *generic_event)
 {
+    xcb_motion_notify_event_t *const event =
+        (xcb_motion_notify_event_t*) generic_event;
     Rectangle new_geometry;
     Size minimum, maximum;
     int32_t delta_x, delta_y;
@@ -687,8 +1603,10 @@ static void handle_motion_notify(xcb_motion_notify_event_t *event)
 /* Unmap notifications are sent after a window decided it wanted to not be seen
  * anymore.
  */
-static void handle_unmap_notify(xcb_unmap_notify_event_t *event)
+static void handle_unmap_notify(xcb_generic_event_t *generic_event)
 {
+    xcb_unmap_notify_event_t *const event =
+        (xcb_unmap_notify_event_t*) generic_event;
     Window *window;
 
     window = get_window_of_xcb_window(event->window);
@@ -712,8 +1630,10 @@ static void handle_unmap_notify(xcb_unmap_notify_event_t *event)
  * is also where we register new windows and wrap them into the internal
  * Window struct.
  */
-static void handle_map_request(xcb_map_request_event_t *event)
+static void handle_map_request(xcb_generic_event_t *generic_event)
 {
+    xcb_map_request_event_t *const event =
+        (xcb_map_request_event_t*) generic_event;
     Window *window;
 
     window = get_window_of_xcb_window(event->window);
@@ -733,8 +1653,10 @@ static void handle_map_request(xcb_map_request_event_t *event)
 /* Destroy notifications are sent when a window leaves the X server.
  * Good bye to that window!
  */
-static void handle_destroy_notify(xcb_destroy_notify_event_t *event)
+static void handle_destroy_notify(xcb_generic_event_t *generic_event)
 {
+    xcb_destroy_notify_event_t *const event =
+        (xcb_destroy_notify_event_t*) generic_event;
     Window *window;
 
     window = get_window_of_xcb_window(event->window);
@@ -744,57 +1666,89 @@ static void handle_destroy_notify(xcb_destroy_notify_event_t *event)
 }
 
 /* Property notifications are sent when a window property changes. */
-static void handle_property_notify(xcb_property_notify_event_t *event)
+static void handle_property_notify(xcb_generic_event_t *generic_event)
 {
+    xcb_property_notify_event_t *const event =
+        (xcb_property_notify_event_t*) generic_event;
     Window *window;
 
     window = get_window_of_xcb_window(event->window);
     if (window == NULL) {
         return;
     }
+
+    /* defer the change if the window changes its properties too often */
+    if (!take_throttle_token(&window->properties->property_throttle,
+                get_monotonic_milliseconds())) {
+        if (window->properties->number_of_deferred_properties == 0) {
+            LOG("throttling property changes of %W\n", window);
+        }
+        window->is_throttled = true;
+        defer_window_property(window, event->atom);
+        return;
+    }
     cache_window_property(window, event->atom);
 }
 
 /* Configure requests are received when a window wants to choose its own
  * position and size. We allow this for unmanaged windows and floating windows.
+ *
+ * The requests are not applied immediately but merged with other requests of
+ * the same window that come in the same batch of events, see
+ * `apply_configure_requests()`.
  */
-static void handle_configure_request(xcb_configure_request_event_t *event)
+static void handle_configure_request(xcb_generic_event_t *generic_event)
 {
+    xcb_configure_request_event_t *const event =
+        (xcb_configure_request_event_t*) generic_event;
     Window *window;
-    int value_index = 0;
-    uint32_t mask = 0;
+    struct configure_request *request;
 
     window = get_window_of_xcb_window(event->window);
-    if (window != NULL && window->state.mode != WINDOW_MODE_FLOATING) {
-        return;
+
+    /* the request is merged into the pending one and kept until the interval
+     * is over if the window sends too many requests
+     */
+    if (window != NULL) {
+        struct throttle *const throttle =
+            &window->properties->configure_throttle;
+        const bool was_throttled = throttle->release_time != 0;
+        if (!take_throttle_token(throttle, get_monotonic_milliseconds())) {
+            if (!was_throttled) {
+                LOG("throttling configure requests of %W\n", window);
+            }
+            window->is_throttled = true;
+        }
     }
 
+    request = get_configure_request(event->window);
+    request->is_managed = window != NULL;
+
     if ((event->value_mask & XCB_CONFIG_WINDOW_X)) {
-        general_values[value_index++] = event->x;
-        mask |= XCB_CONFIG_WINDOW_X;
+        request->x = event->x;
     }
     if ((event->value_mask & XCB_CONFIG_WINDOW_Y)) {
-        general_values[value_index++] = event->y;
-        mask |= XCB_CONFIG_WINDOW_Y;
+        request->y = event->y;
     }
     if ((event->value_mask & XCB_CONFIG_WINDOW_WIDTH)) {
-        general_values[value_index++] = event->width;
-        mask |= XCB_CONFIG_WINDOW_WIDTH;
+        request->width = event->width;
     }
     if ((event->value_mask & XCB_CONFIG_WINDOW_HEIGHT)) {
-        general_values[value_index++] = event->height;
-        mask |= XCB_CONFIG_WINDOW_HEIGHT;
+        request->height = event->height;
     }
     /* ignore border width, stacking etc. */
-
-    xcb_configure_window(connection, event->window, mask, general_values);
+    request->value_mask |= event->value_mask & (XCB_CONFIG_WINDOW_X |
+            XCB_CONFIG_WINDOW_Y | XCB_CONFIG_WINDOW_WIDTH |
+            XCB_CONFIG_WINDOW_HEIGHT);
 }
 
 /* Client messages are sent by a client to our window manager to request certain
  * things.
  */
-static void handle_client_message(xcb_client_message_event_t *event)
+static void handle_client_message(xcb_generic_event_t *generic_event)
 {
+    xcb_client_message_event_t *const event =
+        (xcb_client_message_event_t*) generic_event;
     Window *window;
     int32_t x, y;
     uint32_t width, height;
@@ -881,17 +1835,26 @@ static void handle_client_message(xcb_client_message_event_t *event)
 
 /* Mapping notifications are sent when the modifier keys or keyboard mapping
  * changes.
+ *
+ * They come in bursts (for example when running `setxkbmap`), the keymap is
+ * refreshed once at the end of the cycle.
  */
-static void handle_mapping_notify(xcb_mapping_notify_event_t *event)
+static void handle_mapping_notify(xcb_generic_event_t *generic_event)
 {
-    refresh_keymap(event);
+    xcb_mapping_notify_event_t *const event =
+        (xcb_mapping_notify_event_t*) generic_event;
+
+    queue_keymap_refresh(event);
 }
 
 /* Screen change notifications are sent when the screen configurations is
  * changed, this can include position, size etc.
  */
-static void handle_screen_change(xcb_randr_screen_change_notify_event_t *event)
+static void handle_screen_change(xcb_generic_event_t *generic_event)
 {
+    xcb_randr_screen_change_notify_event_t *const event =
+        (xcb_randr_screen_change_notify_event_t*) generic_event;
+
     screen->width_in_pixels = event->width;
     screen->height_in_pixels = event->height;
     screen->width_in_millimeters = event->mwidth;
@@ -899,108 +1862,226 @@ static void handle_screen_change(xcb_randr_screen_change_notify_event_t *event)
     merge_monitors(query_monitors());
 }
 
-/* Handle the given xcb event.
- *
- * Descriptions for each event are above each handler.
+/* Continue processing keyboard events normally, we need to do this because we
+ * use SYNC when grabbing keys so that we can handle the events ourself but may
+ * also decide to replay it to the client it was actually meant for, the
+ * replaying is done within the key handlers.
  */
-void handle_event(xcb_generic_event_t *event)
+static void allow_keyboard_events(xcb_generic_event_t *generic_event)
 {
-    uint8_t type;
+    xcb_key_press_event_t *const event = (xcb_key_press_event_t*) generic_event;
 
-    /* remove the most significant bit, this gets the actual event type */
-    type = (event->response_type & ~0x80);
+    xcb_allow_events(connection, XCB_ALLOW_ASYNC_KEYBOARD, event->time);
+}
 
-    /* log these events as verbose because they are not helpful mostly */
-    if (type == XCB_MOTION_NOTIFY ||
-            (type == XCB_CLIENT_MESSAGE &&
-             ((xcb_client_message_event_t*) event)->type ==
-                ATOM(_NET_WM_USER_TIME))) {
-        LOG_VERBOSE("%V\n", event);
-    } else {
-        LOG("%V\n", event);
+/* Continue processing pointer events normally, see `allow_keyboard_events()`.
+ */
+static void allow_pointer_events(xcb_generic_event_t *generic_event)
+{
+    xcb_button_press_event_t *const event =
+        (xcb_button_press_event_t*) generic_event;
+
+    xcb_allow_events(connection, XCB_ALLOW_ASYNC_POINTER, event->time);
+}
+
+/* Register the event handlers of the window manager core. */
+void initialize_event_handlers(void)
+{
+    /* continue processing keyboard and pointer events, these are registered
+     * first so they run after the actual handlers
+     */
+    register_event_handler(XCB_KEY_PRESS, allow_keyboard_events);
+    register_event_handler(XCB_KEY_RELEASE, allow_keyboard_events);
+    register_event_handler(XCB_BUTTON_PRESS, allow_pointer_events);
+    register_event_handler(XCB_BUTTON_RELEASE, allow_pointer_events);
+
+    /* a key was pressed */
+    register_event_handler(XCB_KEY_PRESS, handle_key_press);
+    /* a key was released */
+    register_event_handler(XCB_KEY_RELEASE, handle_key_release);
+    /* a mouse button was pressed */
+    register_event_handler(XCB_BUTTON_PRESS, handle_button_press);
+    /* a mouse button was released */
+    register_event_handler(XCB_BUTTON_RELEASE, handle_button_release);
+    /* the mouse was moved */
+    register_event_handler(XCB_MOTION_NOTIFY, handle_motion_notify);
+    /* a window was destroyed */
+    register_event_handler(XCB_DESTROY_NOTIFY, handle_destroy_notify);
+    /* a window was removed from the screen */
+    register_event_handler(XCB_UNMAP_NOTIFY, handle_unmap_notify);
+    /* a window wants to appear on the screen */
+    register_event_handler(XCB_MAP_REQUEST, handle_map_request);
+    /* a window wants to configure itself */
+    register_event_handler(XCB_CONFIGURE_REQUEST, handle_configure_request);
+    /* a window changed a property */
+    register_event_handler(XCB_PROPERTY_NOTIFY, handle_property_notify);
+    /* a client sent us a message */
+    register_event_handler(XCB_CLIENT_MESSAGE, handle_client_message);
+    /* keyboard mapping changed */
+    register_event_handler(XCB_MAPPING_NOTIFY, handle_mapping_notify);
+    /* the mouse moved into or out of a window */
+    register_event_handler(XCB_ENTER_NOTIFY, handle_enter_notify);
+    register_event_handler(XCB_LEAVE_NOTIFY, handle_leave_notify);
+
+    /* the screen configuration changed, the randr event numbers are only known
+     * at runtime
+     */
+    if (randr_event_base > 0) {
+        register_event_handler(
+                randr_event_base + XCB_RANDR_SCREEN_CHANGE_NOTIFY,
+                handle_screen_change);
     }
+}
+
+/* Add @handler to the handlers of events with given @type. */
+void register_event_handler(uint8_t type, event_handler_t handler)
+{
+    struct event_dispatch *const dispatch = &event_dispatch_table[type];
 
-    if (randr_event_base > 0 &&
-            type == randr_event_base + XCB_RANDR_SCREEN_CHANGE_NOTIFY) {
-        handle_screen_change((xcb_randr_screen_change_notify_event_t*) event);
+    if (dispatch->number_of_handlers == SIZE(dispatch->handlers)) {
+        LOG_ERROR("too many handlers for event type %" PRIu8 "\n", type);
         return;
     }
 
-    switch (type) {
-    /* a key was pressed */
-    case XCB_KEY_PRESS:
-        handle_key_press((xcb_key_press_event_t*) event);
-        /* continue processing keyboard events normally, we need to do this
-         * because we use SYNC when grabbing keys/buttons so that we can handle
-         * the events ourself but may also decide to replay it to the client it
-         * was actually meant for, the replaying is done within the handlers
-         */
-        xcb_allow_events(connection, XCB_ALLOW_ASYNC_KEYBOARD,
-                ((xcb_key_press_event_t*) event)->time);
-        break;
+    /* move the other handlers back so the new handler is called first */
+    memmove(&dispatch->handlers[1], &dispatch->handlers[0],
+            sizeof(*dispatch->handlers) * dispatch->number_of_handlers);
+    dispatch->handlers[0] = handler;
+    dispatch->number_of_handlers++;
+}
 
-    /* a key was released */
-    case XCB_KEY_RELEASE:
-        handle_key_release((xcb_key_release_event_t*) event);
-        /* continue processing keyboard events normally */
-        xcb_allow_events(connection, XCB_ALLOW_ASYNC_KEYBOARD,
-                ((xcb_key_release_event_t*) event)->time);
-        break;
+/* Remove @handler from the handlers of events with given @type. */
+void unregister_event_handler(uint8_t type, event_handler_t handler)
+{
+    struct event_dispatch *const dispatch = &event_dispatch_table[type];
 
-    /* a mouse button was pressed */
-    case XCB_BUTTON_PRESS:
-        handle_button_press((xcb_button_press_event_t*) event);
-        /* continue processing pointer events normally */
-        xcb_allow_events(connection, XCB_ALLOW_ASYNC_POINTER,
-                ((xcb_button_press_event_t*) event)->time);
-        break;
+    for (uint32_t i = 0; i < dispatch->number_of_handlers; i++) {
+        if (dispatch->handlers[i] != handler) {
+            continue;
+        }
+        dispatch->number_of_handlers--;
+        memmove(&dispatch->handlers[i], &dispatch->handlers[i + 1],
+                sizeof(*dispatch->handlers) *
+                    (dispatch->number_of_handlers - i));
+        return;
+    }
+}
 
-    /* a mouse button was released */
-    case XCB_BUTTON_RELEASE:
-        handle_button_release((xcb_button_release_event_t*) event);
-        /* continue processing pointer events normally */
-        xcb_allow_events(connection, XCB_ALLOW_ASYNC_POINTER,
-                ((xcb_button_release_event_t*) event)->time);
-        break;
+/* Log how many events of each type were handled and which windows were
+ * throttled.
+ */
+void log_event_statistics(void)
+{
+    const char *label;
 
-    /* the mouse was moved */
-    case XCB_MOTION_NOTIFY:
-        handle_motion_notify((xcb_motion_notify_event_t*) event);
-        break;
+    for (uint32_t type = 0; type < SIZE(event_dispatch_table); type++) {
+        if (event_dispatch_table[type].count == 0) {
+            continue;
+        }
+        /* extension events have no label */
+        label = xcb_event_get_label(type);
+        if (label == NULL) {
+            label = "extension event";
+        }
+        LOG("handled %" PRIu64 " event(s) of type %s (%" PRIu32 ")\n",
+                event_dispatch_table[type].count, label, type);
+    }
 
-    /* a window was destroyed */
-    case XCB_DESTROY_NOTIFY:
-        handle_destroy_notify((xcb_destroy_notify_event_t*) event);
-        break;
+    /* report the clients that are still throttled, the others were reported
+     * when their throttling ended or when they were destroyed
+     */
+    for (uint32_t i = 0; i < number_of_managed_screens; i++) {
+        switch_screen(i);
+        for (Window *window = first_window; window != NULL;
+                window = window->next) {
+            log_deferred_events(window);
+        }
+    }
+}
 
-    /* a window was removed from the screen */
-    case XCB_UNMAP_NOTIFY:
-        handle_unmap_notify((xcb_unmap_notify_event_t*) event);
+/* Switch to the screen @event happened on. */
+static void switch_to_event_screen(const xcb_generic_event_t *event)
+{
+    xcb_window_t root = XCB_NONE;
+
+    switch (event->response_type & ~0x80) {
+    /* these all have the same layout as a key press event */
+    case XCB_KEY_PRESS:
+    case XCB_KEY_RELEASE:
+    case XCB_BUTTON_PRESS:
+    case XCB_BUTTON_RELEASE:
+    case XCB_MOTION_NOTIFY:
+    case XCB_ENTER_NOTIFY:
+    case XCB_LEAVE_NOTIFY:
+        root = ((xcb_key_press_event_t*) event)->root;
         break;
 
-    /* a window wants to appear on the screen */
+    /* new windows are not known yet, their parent is the root */
+    case XCB_CREATE_NOTIFY:
+        root = ((xcb_create_notify_event_t*) event)->parent;
+        break;
     case XCB_MAP_REQUEST:
-        handle_map_request((xcb_map_request_event_t*) event);
+        root = ((xcb_map_request_event_t*) event)->parent;
         break;
-
-    /* a window wants to configure itself */
     case XCB_CONFIGURE_REQUEST:
-        handle_configure_request((xcb_configure_request_event_t*) event);
+        root = ((xcb_configure_request_event_t*) event)->parent;
         break;
 
-    /* a window changed a property */
-    case XCB_PROPERTY_NOTIFY:
-        handle_property_notify((xcb_property_notify_event_t*) event);
+    default:
+        if (randr_event_base > 0 && event->response_type ==
+                randr_event_base + XCB_RANDR_SCREEN_CHANGE_NOTIFY) {
+            root = ((xcb_randr_screen_change_notify_event_t*) event)->root;
+        }
         break;
+    }
 
-    /* a client sent us a message */
-    case XCB_CLIENT_MESSAGE:
-        handle_client_message((xcb_client_message_event_t*) event);
-        break;
+    if (root != XCB_NONE && switch_to_root(root)) {
+        return;
+    }
+    (void) switch_to_window_screen(get_event_window(event));
+}
 
-    /* keyboard mapping changed */
-    case XCB_MAPPING_NOTIFY:
-        handle_mapping_notify((xcb_mapping_notify_event_t*) event);
-        break;
+/* Handle the given xcb event.
+ *
+ * Descriptions for each event are above each handler.
+ */
+void handle_event(xcb_generic_event_t *event)
+{
+    uint8_t type;
+    struct event_dispatch *dispatch;
+    event_handler_t handlers[EVENT_HANDLERS_MAX];
+    uint32_t number_of_handlers;
+    uint64_t start;
+
+    start = START_PROBE_TIMER(event__handle);
+
+    /* remove the most significant bit, this gets the actual event type */
+    type = (event->response_type & ~0x80);
+
+    switch_to_event_screen(event);
+
+    /* log these events as verbose because they are not helpful mostly */
+    if (type == XCB_MOTION_NOTIFY || type == XCB_ENTER_NOTIFY ||
+            type == XCB_LEAVE_NOTIFY ||
+            (type == XCB_CLIENT_MESSAGE &&
+             ((xcb_client_message_event_t*) event)->type ==
+                ATOM(_NET_WM_USER_TIME))) {
+        LOG_VERBOSE("%V\n", event);
+    } else {
+        LOG("%V\n", event);
     }
+
+    dispatch = &event_dispatch_table[type];
+    dispatch->count++;
+
+    /* copy the handlers because a handler might unregister itself */
+    number_of_handlers = dispatch->number_of_handlers;
+    memcpy(handlers, dispatch->handlers,
+            sizeof(*handlers) * number_of_handlers);
+    for (uint32_t i = 0; i < number_of_handlers; i++) {
+        handlers[i](event);
+    }
+
+    PROBE3(event__handle, type, get_event_window(event),
+            GET_PROBE_DURATION(start));
 }
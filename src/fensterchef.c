@@ -1,10 +1,12 @@
 #include <unistd.h>
 
 #include "configuration.h"
+#include "event.h"
 #include "fensterchef.h"
 #include "log.h"
 #include "render.h"
 #include "x11_management.h"
+#include "xalloc.h"
 
 /* true while the window manager is running */
 bool is_fensterchef_running;
@@ -12,12 +14,24 @@ bool is_fensterchef_running;
 /* the path of the configuration file */
 const char *fensterchef_configuration = FENSTERCHEF_CONFIGURATION;
 
+/* the notification to show once it is no longer deferred */
+static struct {
+    /* if notifications are collected instead of being shown */
+    bool is_deferred;
+    /* the last message, NULL if there is none */
+    uint8_t *message;
+    /* the center position of the message */
+    int32_t x;
+    int32_t y;
+} deferred_notification;
+
 /* Close the connection to the X server and exit the program with given exit
  * code.
  */
 void quit_fensterchef(int exit_code)
 {
     LOG("quitting fensterchef with exit code: %d\n", exit_code);
+    log_event_statistics();
     xcb_disconnect(connection);
     exit(exit_code);
 }
@@ -34,6 +48,15 @@ void set_notification(const uint8_t *message, int32_t x, int32_t y)
         return;
     }
 
+    /* only keep the last message */
+    if (deferred_notification.is_deferred) {
+        free(deferred_notification.message);
+        deferred_notification.message = (uint8_t*) xstrdup((char*) message);
+        deferred_notification.x = x;
+        deferred_notification.y = y;
+        return;
+    }
+
     /* measure the text for centering the text */
     message_length = strlen((char*) message);
     measure_text(message, message_length, &measure);
@@ -75,3 +98,21 @@ void set_notification(const uint8_t *message, int32_t x, int32_t y)
     /* set an alarm to trigger after @configuration.notification.duration */
     alarm(configuration.notification.duration);
 }
+
+/* Collect notifications instead of showing them right away. */
+void defer_notification(void)
+{
+    deferred_notification.is_deferred = true;
+}
+
+/* Show the last notification collected since `defer_notification()`. */
+void flush_notification(void)
+{
+    deferred_notification.is_deferred = false;
+    if (deferred_notification.message != NULL) {
+        set_notification(deferred_notification.message,
+                deferred_notification.x, deferred_notification.y);
+        free(deferred_notification.message);
+        deferred_notification.message = NULL;
+    }
+}
@@ -71,18 +71,14 @@ void resize_frame(Frame *frame, int32_t x, int32_t y,
     switch (frame->split_direction) {
     /* left to right split */
     case FRAME_SPLIT_HORIZONTALLY:
-        /* keep ration when resizing or use the default 1/2 ratio */
-        left_size = left->width == 0 || right->width == 0 ? width / 2 :
-            width * left->width / (left->width + right->width);
+        left_size = (uint64_t) width * frame->ratio / FRAME_RATIO_ONE;
         resize_frame(left, x, y, left_size, height);
         resize_frame(right, x + left_size, y, width - left_size, height);
         break;
 
     /* top to bottom split */
     case FRAME_SPLIT_VERTICALLY:
-        /* keep ratio when resizing or use the default 1/2 ratio */
-        left_size = left->height == 0 || right->height == 0 ? height / 2 :
-            height * left->height / (left->height + right->height);
+        left_size = (uint64_t) height * frame->ratio / FRAME_RATIO_ONE;
         resize_frame(left, x, y, width, left_size);
         resize_frame(right, x, y + left_size, width, height - left_size);
         break;
@@ -95,6 +91,7 @@ void replace_frame(Frame *frame, Frame *with)
     /* reparent the child frames */
     if (with->left != NULL) {
         frame->split_direction = with->split_direction;
+        frame->ratio = with->ratio;
         frame->left = with->left;
         frame->right = with->right;
         frame->left->parent = frame;
@@ -102,16 +99,27 @@ void replace_frame(Frame *frame, Frame *with)
 
         with->left = NULL;
         with->right = NULL;
+        with->is_minimum_size_valid = false;
     } else {
         frame->window = with->window;
 
         with->window = NULL;
     }
 
+    invalidate_frame_minimum_size(frame);
+
     /* reload the frame recursively */
     resize_frame(frame, frame->x, frame->y, frame->width, frame->height);
 }
 
+/* Mark the cached minimum size of @frame and all its parents as outdated. */
+void invalidate_frame_minimum_size(Frame *frame)
+{
+    for (; frame != NULL; frame = frame->parent) {
+        frame->is_minimum_size_valid = false;
+    }
+}
+
 /* Get the gaps the frame applies to its inner window. */
 void get_frame_gaps(Frame *frame, Extents *gaps)
 {
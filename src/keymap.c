@@ -1,11 +1,77 @@
+#include <inttypes.h>
+#include <string.h>
+
+#include <xcb/xkb.h>
+
 #include "configuration.h"
 #include "keymap.h"
+#include "log.h"
 #include "utility.h"
 #include "x11_management.h"
+#include "xalloc.h"
 
 /* symbol translation table */
 static xcb_key_symbols_t *key_symbols;
 
+/* if a keyboard mapping notification arrived that was not applied yet */
+static bool is_keymap_refresh_pending;
+
+/* the last keyboard mapping notification that arrived */
+static xcb_mapping_notify_event_t pending_mapping_notify;
+
+/* Ask the server to send key repeats as presses only.
+ *
+ * Without detectable autorepeat, each repeat is a release followed by a press.
+ * The release ends the synchronous key grab and the press starts it again, so
+ * the keyboard freezes for every single repeat until it is thawed.
+ */
+static void enable_detectable_autorepeat(void)
+{
+    const xcb_query_extension_reply_t *extension;
+    xcb_xkb_use_extension_cookie_t use_cookie;
+    xcb_xkb_use_extension_reply_t *use;
+    xcb_xkb_per_client_flags_cookie_t flags_cookie;
+    xcb_xkb_per_client_flags_reply_t *flags;
+    xcb_generic_error_t *error;
+
+    extension = xcb_get_extension_data(connection, &xcb_xkb_id);
+    if (!extension->present) {
+        LOG_ERROR("the XKB extension is missing\n");
+        return;
+    }
+
+    use_cookie = xcb_xkb_use_extension(connection, XCB_XKB_MAJOR_VERSION,
+            XCB_XKB_MINOR_VERSION);
+    use = xcb_xkb_use_extension_reply(connection, use_cookie, &error);
+    if (use == NULL) {
+        LOG_ERROR("could not use the XKB extension: %E\n", error);
+        free(error);
+        return;
+    }
+    if (!use->supported) {
+        LOG_ERROR("XKB %" PRIu16 ".%" PRIu16 " is not supported\n",
+                XCB_XKB_MAJOR_VERSION, XCB_XKB_MINOR_VERSION);
+        free(use);
+        return;
+    }
+    free(use);
+
+    flags_cookie = xcb_xkb_per_client_flags(connection,
+            XCB_XKB_ID_USE_CORE_KBD,
+            XCB_XKB_PER_CLIENT_FLAG_DETECTABLE_AUTO_REPEAT,
+            XCB_XKB_PER_CLIENT_FLAG_DETECTABLE_AUTO_REPEAT, 0, 0, 0);
+    flags = xcb_xkb_per_client_flags_reply(connection, flags_cookie, &error);
+    if (flags == NULL) {
+        LOG_ERROR("could not set the XKB client flags: %E\n", error);
+        free(error);
+        return;
+    }
+    if (!(flags->value & XCB_XKB_PER_CLIENT_FLAG_DETECTABLE_AUTO_REPEAT)) {
+        LOG_ERROR("detectable autorepeat is not supported\n");
+    }
+    free(flags);
+}
+
 /* Initializes the key symbol table so the below functions can be used. */
 int initialize_keymap(void)
 {
@@ -13,20 +79,96 @@ int initialize_keymap(void)
     if (key_symbols == NULL) {
         return ERROR;
     }
+    enable_detectable_autorepeat();
     return OK;
 }
 
-/* Refresh the keymap if a mapping notify event arrives. */
-void refresh_keymap(xcb_mapping_notify_event_t *event)
+/* Remember that the keymap needs to be refreshed because of @event. */
+void queue_keymap_refresh(xcb_mapping_notify_event_t *event)
 {
-    (void) xcb_refresh_keyboard_mapping(key_symbols, event);
-    /* regrab all keys */
-    grab_configured_keys();
+    if (event->request != XCB_MAPPING_KEYBOARD) {
+        return;
+    }
+
+    /* the symbol table reloads the entire mapping no matter which keycodes
+     * the event names, so only the last event needs to be kept
+     */
+    pending_mapping_notify = *event;
+    is_keymap_refresh_pending = true;
+}
+
+/* Get the keycodes of all bound key symbols in configuration order, each list
+ * is terminated by `XCB_NO_SYMBOL`.
+ *
+ * @number_of_keycodes receives the length of the returned list.
+ */
+static xcb_keycode_t *get_bound_keycodes(uint32_t *number_of_keycodes)
+{
+    xcb_keycode_t *bound_keycodes = NULL;
+    uint32_t length = 0;
+    xcb_keycode_t *keycodes;
+    uint32_t count;
+
+    for (uint32_t i = 0; i < configuration.keyboard.number_of_keys; i++) {
+        keycodes = xcb_key_symbols_get_keycode(key_symbols,
+                configuration.keyboard.keys[i].key_symbol);
+        count = 0;
+        if (keycodes != NULL) {
+            while (keycodes[count] != XCB_NO_SYMBOL) {
+                count++;
+            }
+        }
+
+        bound_keycodes = xreallocarray(bound_keycodes, length + count + 1,
+                sizeof(*bound_keycodes));
+        if (count > 0) {
+            memcpy(&bound_keycodes[length], keycodes,
+                    sizeof(*keycodes) * count);
+        }
+        length += count;
+        bound_keycodes[length++] = XCB_NO_SYMBOL;
+        free(keycodes);
+    }
+
+    *number_of_keycodes = length;
+    return bound_keycodes;
+}
+
+/* Refresh the keymap if a refresh was queued. */
+void flush_keymap_refresh(void)
+{
+    xcb_keycode_t *old_keycodes, *new_keycodes;
+    uint32_t old_length, new_length;
+
+    if (!is_keymap_refresh_pending) {
+        return;
+    }
+    is_keymap_refresh_pending = false;
+
+    old_keycodes = get_bound_keycodes(&old_length);
+
+    (void) xcb_refresh_keyboard_mapping(key_symbols, &pending_mapping_notify);
+
+    new_keycodes = get_bound_keycodes(&new_length);
+
+    /* the grabs are by keycode, they only need to be renewed if a bound key
+     * symbol moved to other keycodes
+     */
+    if (old_length != new_length || (new_length > 0 &&
+                memcmp(old_keycodes, new_keycodes,
+                    sizeof(*new_keycodes) * new_length) != 0)) {
+        LOG("keycodes of bound keys changed, grabbing the keys again\n");
+        grab_configured_keys();
+    }
+
+    free(new_keycodes);
+    free(old_keycodes);
 }
 
 /* Get a keysym from a keycode. */
 xcb_keysym_t get_keysym(xcb_keycode_t keycode)
 {
+    flush_keymap_refresh();
     return xcb_key_symbols_get_keysym(key_symbols, keycode, 0);
 }
 
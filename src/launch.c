@@ -0,0 +1,198 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "fensterchef.h"
+#include "frame.h"
+#include "launch.h"
+#include "log.h"
+#include "screen.h"
+#include "utility.h"
+#include "window.h"
+#include "x11_management.h"
+
+/* a program started by the `RUN` action that did not show a window yet */
+struct launch {
+    /* the startup identifier, empty if this launch is not used */
+    char id[LAUNCH_ID_SIZE];
+    /* the process id of the shell running the program, 0 if it is unknown */
+    pid_t process_id;
+    /* the number of the screen the program was started on */
+    int screen_number;
+    /* the center of the frame that was focused when the program started */
+    Point position;
+    /* the time in milliseconds the program started */
+    uint64_t time;
+};
+
+/* all programs waiting for their first window */
+static struct launch launches[MAXIMUM_PENDING_LAUNCHES];
+
+/* the number of startup identifiers created so far */
+static uint32_t launch_counter;
+
+/* Check if @launch is used and not timed out at @now. */
+static bool is_launch_pending(const struct launch *launch, uint64_t now)
+{
+    return launch->id[0] != '\0' && now - launch->time < LAUNCH_TIMEOUT;
+}
+
+/* Remember the focused frame for a program that is about to start. */
+const char *begin_launch(void)
+{
+    const uint64_t now = get_monotonic_milliseconds();
+    struct launch *launch;
+
+    /* take an unused slot or the one of the oldest launch */
+    launch = &launches[0];
+    for (uint32_t i = 0; i < SIZE(launches); i++) {
+        if (!is_launch_pending(&launches[i], now)) {
+            launch = &launches[i];
+            break;
+        }
+        if (launches[i].time < launch->time) {
+            launch = &launches[i];
+        }
+    }
+
+    launch_counter++;
+    (void) snprintf(launch->id, sizeof(launch->id),
+            FENSTERCHEF_NAME "-%ld-%" PRIu32, (long) getpid(),
+            launch_counter);
+    launch->process_id = 0;
+    launch->time = now;
+    launch->screen_number = current_screen->number;
+    if (focus_frame != NULL) {
+        launch->position.x = focus_frame->x + focus_frame->width / 2;
+        launch->position.y = focus_frame->y + focus_frame->height / 2;
+    } else {
+        /* without frame, the window goes into the focused frame of the time it
+         * is shown
+         */
+        launch->id[0] = '\0';
+    }
+    return launch->id;
+}
+
+/* Set the process id of the program started with the startup identifier @id.
+ */
+void set_launch_process(const char *id, pid_t process_id)
+{
+    for (uint32_t i = 0; i < SIZE(launches); i++) {
+        if (strcmp(launches[i].id, id) == 0) {
+            launches[i].process_id = process_id;
+            break;
+        }
+    }
+}
+
+/* Find the launch of the current screen that is pending at @now and whose
+ * startup identifier is the @id_length long @id or, if there is none, whose
+ * process id is @process_id.
+ */
+static struct launch *find_launch(const char *id, size_t id_length,
+        pid_t process_id, uint64_t now)
+{
+    struct launch *launch;
+
+    /* the startup identifier is unique, a process id might be reused or be the
+     * one of a shell that started multiple programs
+     */
+    for (uint32_t i = 0; i < SIZE(launches) && id_length > 0; i++) {
+        launch = &launches[i];
+        if (is_launch_pending(launch, now) &&
+                launch->screen_number == current_screen->number &&
+                id_length == strlen(launch->id) &&
+                memcmp(launch->id, id, id_length) == 0) {
+            return launch;
+        }
+    }
+
+    for (uint32_t i = 0; i < SIZE(launches) && process_id != 0; i++) {
+        launch = &launches[i];
+        if (is_launch_pending(launch, now) &&
+                launch->screen_number == current_screen->number &&
+                launch->process_id == process_id) {
+            return launch;
+        }
+    }
+    return NULL;
+}
+
+/* Take the launch with the startup identifier @id or the process id
+ * @process_id.
+ */
+bool take_launch(const char *id, size_t id_length, pid_t process_id,
+        uint64_t now, Point *position)
+{
+    struct launch *launch;
+
+    launch = find_launch(id, id_length, process_id, now);
+    if (launch == NULL) {
+        return false;
+    }
+
+    LOG("taking launch %s\n", launch->id);
+    *position = launch->position;
+    /* only the first window of a program is placed */
+    launch->id[0] = '\0';
+    return true;
+}
+
+/* Match the new @window to a pending launch and take over its frame. */
+void match_window_to_launch(Window *window)
+{
+    const uint64_t now = get_monotonic_milliseconds();
+    bool has_pending = false;
+    xcb_get_property_cookie_t startup_id_cookie;
+    xcb_get_property_cookie_t pid_cookie;
+    xcb_get_property_reply_t *startup_id;
+    xcb_get_property_reply_t *pid;
+    const char *id = NULL;
+    size_t id_length = 0;
+    pid_t process_id = 0;
+
+    /* the launch frame is only used when the window is shown the first time */
+    if (window->client.is_mapped) {
+        return;
+    }
+
+    /* avoid the round trip when no program is waiting for a window */
+    for (uint32_t i = 0; i < SIZE(launches); i++) {
+        if (is_launch_pending(&launches[i], now)) {
+            has_pending = true;
+            break;
+        }
+    }
+    if (!has_pending) {
+        return;
+    }
+
+    startup_id_cookie = xcb_get_property(connection, false, window->client.id,
+            ATOM(_NET_STARTUP_ID), XCB_GET_PROPERTY_TYPE_ANY, 0,
+            LAUNCH_ID_SIZE / 4);
+    pid_cookie = xcb_get_property(connection, false, window->client.id,
+            ATOM(_NET_WM_PID), XCB_ATOM_CARDINAL, 0, 1);
+    startup_id = xcb_get_property_reply(connection, startup_id_cookie, NULL);
+    pid = xcb_get_property_reply(connection, pid_cookie, NULL);
+
+    /* the startup identifier is not null terminated in the property */
+    if (startup_id != NULL && startup_id->format == 8) {
+        id = xcb_get_property_value(startup_id);
+        id_length = xcb_get_property_value_length(startup_id);
+    }
+    if (pid != NULL && pid->format == 32 &&
+            xcb_get_property_value_length(pid) == sizeof(uint32_t)) {
+        process_id = *(uint32_t*) xcb_get_property_value(pid);
+    }
+
+    if (take_launch(id, id_length, process_id, now,
+                &window->properties->launch_position)) {
+        LOG("window %W belongs to a launch\n", window);
+        window->properties->has_launch_position = true;
+    }
+
+    free(pid);
+    free(startup_id);
+}
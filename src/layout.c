@@ -0,0 +1,762 @@
+#include <errno.h>
+#include <inttypes.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "frame.h"
+#include "layout.h"
+#include "log.h"
+#include "monitor.h"
+#include "stash_frame.h"
+#include "window.h"
+#include "xalloc.h"
+
+/* The on disk format is a text file with one frame per line in pre-order:
+ *
+ * monitor <length> <name>
+ * split <horizontal|vertical> <ratio>
+ * window <length> <instance> <length> <class>
+ * empty
+ * ...
+ *
+ * Strings are prefixed by their length in bytes so they may contain any
+ * character. The ratio is relative to `FRAME_RATIO_ONE`.
+ *
+ * X window ids are only valid while the X server runs, so the windows are
+ * stored by their `WM_CLASS` on disk. Layouts saved by this process still
+ * know the exact windows and prefer them.
+ */
+
+/* the maximum depth of a frame tree within a layout file */
+#define LAYOUT_MAXIMUM_DEPTH 256
+
+/* the maximum length of a string within a layout file */
+#define LAYOUT_MAXIMUM_STRING_LENGTH 4096
+
+/* a frame within a layout */
+struct layout_frame {
+    /* the X window within the frame, this is `XCB_NONE` for empty frames and
+     * layouts loaded from disk
+     */
+    xcb_window_t window;
+    /* the instance and class name of the window, NULL for empty frames or if
+     * the window has no `WM_CLASS`
+     */
+    char *instance_name;
+    char *class_name;
+    /* the direction the frame was split in */
+    frame_split_direction_t split_direction;
+    /* the ratio the space is split in, see `Frame.ratio` */
+    uint32_t ratio;
+    /* left child and right child of the frame */
+    struct layout_frame *left;
+    struct layout_frame *right;
+};
+
+/* the frame tree of a monitor within a layout */
+struct layout_monitor {
+    /* name of the monitor */
+    char *name;
+    /* the root frame */
+    struct layout_frame *frame;
+};
+
+/* a saved layout */
+struct layout {
+    /* the name of the layout */
+    char *name;
+    /* the monitors in this layout */
+    struct layout_monitor *monitors;
+    /* the number of monitors */
+    uint32_t number_of_monitors;
+    /* the next layout in the linked list */
+    struct layout *next;
+};
+
+/* all layouts in memory */
+static struct layout *first_layout;
+
+/* Free @frame and all its children. */
+static void free_layout_frame(struct layout_frame *frame)
+{
+    if (frame == NULL) {
+        return;
+    }
+    free_layout_frame(frame->left);
+    free_layout_frame(frame->right);
+    free(frame->instance_name);
+    free(frame->class_name);
+    free(frame);
+}
+
+/* Free @layout and all its monitors. */
+static void free_layout(struct layout *layout)
+{
+    for (uint32_t i = 0; i < layout->number_of_monitors; i++) {
+        free(layout->monitors[i].name);
+        free_layout_frame(layout->monitors[i].frame);
+    }
+    free(layout->monitors);
+    free(layout->name);
+    free(layout);
+}
+
+/* Put @layout into the layout list, replacing a layout with the same name. */
+static void add_layout(struct layout *layout)
+{
+    struct layout **pointer;
+
+    for (pointer = &first_layout; *pointer != NULL;
+            pointer = &(*pointer)->next) {
+        if (strcmp((*pointer)->name, layout->name) == 0) {
+            layout->next = (*pointer)->next;
+            free_layout(*pointer);
+            *pointer = layout;
+            return;
+        }
+    }
+    layout->next = first_layout;
+    first_layout = layout;
+}
+
+/* Get the path of the layout file with given name.
+ *
+ * @return NULL if the name is not usable as file name.
+ */
+static char *get_layout_path(const char *name)
+{
+    const char *home;
+
+    /* do not allow leaving the layout directory */
+    if (name[0] == '\0' || name[0] == '.' || strchr(name, '/') != NULL) {
+        LOG_ERROR("invalid layout name %s\n", name);
+        return NULL;
+    }
+
+    home = getenv("HOME");
+    if (home == NULL) {
+        LOG_ERROR("could not get home directory ($HOME is unset)\n");
+        return NULL;
+    }
+    return xasprintf("%s/%s/%s", home, &FENSTERCHEF_LAYOUT_DIRECTORY[2], name);
+}
+
+/* Copy @frame and all its children into a layout frame tree.
+ *
+ * @leaves receives the layout frames with a window in pre-order, it must have
+ *         room for all windows.
+ */
+static struct layout_frame *copy_frame(const Frame *frame,
+        struct layout_frame **leaves, uint32_t *number_of_leaves)
+{
+    struct layout_frame *copy;
+
+    copy = xcalloc(1, sizeof(*copy));
+    if (frame->left != NULL) {
+        copy->split_direction = frame->split_direction;
+        copy->ratio = frame->ratio;
+        copy->left = copy_frame(frame->left, leaves, number_of_leaves);
+        copy->right = copy_frame(frame->right, leaves, number_of_leaves);
+    } else if (frame->window != NULL) {
+        copy->window = frame->window->client.id;
+        leaves[(*number_of_leaves)++] = copy;
+    }
+    return copy;
+}
+
+/* Get the instance and class names of the windows within @leaves.
+ *
+ * All requests are sent before waiting for the first reply.
+ */
+static void get_leaf_classes(struct layout_frame **leaves,
+        uint32_t number_of_leaves)
+{
+    xcb_get_property_cookie_t *cookies;
+    xcb_icccm_get_wm_class_reply_t class;
+
+    cookies = xreallocarray(NULL, number_of_leaves, sizeof(*cookies));
+    for (uint32_t i = 0; i < number_of_leaves; i++) {
+        cookies[i] = xcb_icccm_get_wm_class(connection, leaves[i]->window);
+    }
+    for (uint32_t i = 0; i < number_of_leaves; i++) {
+        if (!xcb_icccm_get_wm_class_reply(connection, cookies[i], &class,
+                    NULL)) {
+            continue;
+        }
+        leaves[i]->instance_name = xstrdup(class.instance_name);
+        leaves[i]->class_name = xstrdup(class.class_name);
+        xcb_icccm_get_wm_class_reply_wipe(&class);
+    }
+    free(cookies);
+}
+
+/* Write @string prefixed by its length to @file. */
+static void write_layout_string(FILE *file, const char *string)
+{
+    fprintf(file, "%zu %s", strlen(string), string);
+}
+
+/* Write @frame and all its children to @file. */
+static void write_layout_frame(FILE *file, const struct layout_frame *frame)
+{
+    if (frame->left != NULL) {
+        fprintf(file, "split %s %" PRIu32 "\n",
+                frame->split_direction == FRAME_SPLIT_HORIZONTALLY ?
+                    "horizontal" : "vertical",
+                frame->ratio);
+        write_layout_frame(file, frame->left);
+        write_layout_frame(file, frame->right);
+    } else if (frame->instance_name != NULL) {
+        fputs("window ", file);
+        write_layout_string(file, frame->instance_name);
+        fputc(' ', file);
+        write_layout_string(file, frame->class_name);
+        fputc('\n', file);
+    } else {
+        fputs("empty\n", file);
+    }
+}
+
+/* Create the directory @path and all its parents that do not exist yet. */
+static int create_directories(char *path)
+{
+    char *slash;
+
+    slash = path;
+    do {
+        slash = strchr(&slash[1], '/');
+        if (slash != NULL) {
+            slash[0] = '\0';
+        }
+        if (mkdir(path, 0755) != 0 && errno != EEXIST) {
+            LOG_ERROR("could not create the directory %s: %s\n",
+                    path, strerror(errno));
+            if (slash != NULL) {
+                slash[0] = '/';
+            }
+            return ERROR;
+        }
+        if (slash != NULL) {
+            slash[0] = '/';
+        }
+    } while (slash != NULL);
+    return OK;
+}
+
+/* Write @layout to disk. */
+static int write_layout_file(const struct layout *layout)
+{
+    char *path;
+    char *slash;
+    FILE *file;
+
+    path = get_layout_path(layout->name);
+    if (path == NULL) {
+        return ERROR;
+    }
+
+    /* create the layout directory if it does not exist yet */
+    slash = strrchr(path, '/');
+    slash[0] = '\0';
+    if (create_directories(path) != OK) {
+        free(path);
+        return ERROR;
+    }
+    slash[0] = '/';
+
+    file = fopen(path, "w");
+    if (file == NULL) {
+        LOG_ERROR("could not open layout file %s: %s\n",
+                path, strerror(errno));
+        free(path);
+        return ERROR;
+    }
+
+    for (uint32_t i = 0; i < layout->number_of_monitors; i++) {
+        fputs("monitor ", file);
+        write_layout_string(file, layout->monitors[i].name);
+        fputc('\n', file);
+        write_layout_frame(file, layout->monitors[i].frame);
+    }
+
+    fclose(file);
+    free(path);
+    return OK;
+}
+
+/* Read a string prefixed by its length from @file.
+ *
+ * @return NULL if the file is malformed.
+ */
+static char *read_layout_string(FILE *file)
+{
+    uint32_t length;
+    char *string;
+
+    if (fscanf(file, " %" SCNu32, &length) != 1 ||
+            length > LAYOUT_MAXIMUM_STRING_LENGTH || fgetc(file) != ' ') {
+        return NULL;
+    }
+
+    string = xmalloc(length + 1);
+    if (fread(string, 1, length, file) != length ||
+            memchr(string, '\0', length) != NULL) {
+        free(string);
+        return NULL;
+    }
+    string[length] = '\0';
+    return string;
+}
+
+/* Read a frame and all its children from @file.
+ *
+ * @return NULL if the file is malformed.
+ */
+static struct layout_frame *read_layout_frame(FILE *file, uint32_t depth)
+{
+    char kind[16];
+    char direction[16];
+    struct layout_frame *frame;
+
+    if (depth > LAYOUT_MAXIMUM_DEPTH || fscanf(file, " %15s", kind) != 1) {
+        return NULL;
+    }
+
+    frame = xcalloc(1, sizeof(*frame));
+    if (strcmp(kind, "window") == 0) {
+        frame->instance_name = read_layout_string(file);
+        if (frame->instance_name != NULL) {
+            frame->class_name = read_layout_string(file);
+        }
+        if (frame->class_name == NULL) {
+            free_layout_frame(frame);
+            return NULL;
+        }
+    } else if (strcmp(kind, "empty") == 0) {
+        /* nothing to read */
+    } else if (strcmp(kind, "split") == 0) {
+        if (fscanf(file, " %15s %" SCNu32, direction, &frame->ratio) != 2 ||
+                frame->ratio > FRAME_RATIO_ONE) {
+            free(frame);
+            return NULL;
+        }
+        if (strcmp(direction, "horizontal") == 0) {
+            frame->split_direction = FRAME_SPLIT_HORIZONTALLY;
+        } else if (strcmp(direction, "vertical") == 0) {
+            frame->split_direction = FRAME_SPLIT_VERTICALLY;
+        } else {
+            free(frame);
+            return NULL;
+        }
+        frame->left = read_layout_frame(file, depth + 1);
+        if (frame->left != NULL) {
+            frame->right = read_layout_frame(file, depth + 1);
+        }
+        if (frame->right == NULL) {
+            free_layout_frame(frame);
+            return NULL;
+        }
+    } else {
+        free(frame);
+        return NULL;
+    }
+    return frame;
+}
+
+/* Load the layout with given name from disk.
+ *
+ * @return NULL if the layout does not exist or is malformed.
+ */
+static struct layout *read_layout_file(const char *name)
+{
+    char *path;
+    FILE *file;
+    struct layout *layout;
+    char word[16];
+    char *monitor_name;
+    struct layout_frame *frame;
+
+    path = get_layout_path(name);
+    if (path == NULL) {
+        return NULL;
+    }
+
+    file = fopen(path, "r");
+    if (file == NULL) {
+        LOG_ERROR("could not open layout file %s: %s\n",
+                path, strerror(errno));
+        free(path);
+        return NULL;
+    }
+
+    layout = xcalloc(1, sizeof(*layout));
+    layout->name = xstrdup(name);
+    while (fscanf(file, " %15s", word) == 1) {
+        if (strcmp(word, "monitor") != 0) {
+            break;
+        }
+
+        monitor_name = read_layout_string(file);
+        if (monitor_name == NULL) {
+            break;
+        }
+
+        frame = read_layout_frame(file, 0);
+        if (frame == NULL) {
+            free(monitor_name);
+            break;
+        }
+
+        RESIZE(layout->monitors, layout->number_of_monitors + 1);
+        layout->monitors[layout->number_of_monitors].name = monitor_name;
+        layout->monitors[layout->number_of_monitors].frame = frame;
+        layout->number_of_monitors++;
+    }
+
+    /* check if the file was read completely */
+    if (!feof(file)) {
+        LOG_ERROR("layout file %s is malformed\n", path);
+        free_layout(layout);
+        layout = NULL;
+    }
+
+    fclose(file);
+    free(path);
+    return layout;
+}
+
+/* Save the frames of all monitors under @name. */
+int save_layout(const char *name)
+{
+    struct layout *layout;
+    uint32_t count = 0;
+    struct layout_frame **leaves;
+    uint32_t number_of_leaves = 0;
+
+    layout = xcalloc(1, sizeof(*layout));
+    layout->name = xstrdup(name);
+
+    for (Monitor *monitor = first_monitor; monitor != NULL;
+            monitor = monitor->next) {
+        count++;
+    }
+    layout->monitors = xreallocarray(NULL, count, sizeof(*layout->monitors));
+
+    /* there can not be more windows in frames than there are windows */
+    count = 0;
+    for (Window *window = first_window; window != NULL;
+            window = window->next) {
+        count++;
+    }
+    leaves = xreallocarray(NULL, count, sizeof(*leaves));
+
+    for (Monitor *monitor = first_monitor; monitor != NULL;
+            monitor = monitor->next) {
+        struct layout_monitor *const layout_monitor =
+            &layout->monitors[layout->number_of_monitors++];
+        layout_monitor->name = xstrdup(monitor->name);
+        layout_monitor->frame = copy_frame(monitor->frame, leaves,
+                &number_of_leaves);
+    }
+
+    get_leaf_classes(leaves, number_of_leaves);
+    free(leaves);
+
+    add_layout(layout);
+
+    LOG("saved layout %s\n", name);
+
+    return write_layout_file(layout);
+}
+
+/* a hidden tiling window that can be put into a frame of a layout */
+struct layout_candidate {
+    /* the window */
+    Window *window;
+    /* the `WM_CLASS` of the window */
+    xcb_icccm_get_wm_class_reply_t class;
+    /* if `class` was received */
+    bool has_class;
+};
+
+/* Get all hidden tiling windows with their instance and class names.
+ *
+ * @number_of_candidates receives the number of returned candidates.
+ */
+static struct layout_candidate *get_candidates(uint32_t *number_of_candidates)
+{
+    uint32_t count = 0;
+    struct layout_candidate *candidates;
+    xcb_get_property_cookie_t *cookies;
+
+    for (Window *window = first_window; window != NULL;
+            window = window->next) {
+        if (window->state.mode == WINDOW_MODE_TILING &&
+                !window->state.is_visible) {
+            count++;
+        }
+    }
+
+    candidates = xreallocarray(NULL, count, sizeof(*candidates));
+    cookies = xreallocarray(NULL, count, sizeof(*cookies));
+
+    /* send all requests before waiting for the first reply */
+    count = 0;
+    for (Window *window = first_window; window != NULL;
+            window = window->next) {
+        if (window->state.mode == WINDOW_MODE_TILING &&
+                !window->state.is_visible) {
+            candidates[count].window = window;
+            cookies[count] = xcb_icccm_get_wm_class(connection,
+                    window->client.id);
+            count++;
+        }
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        candidates[i].has_class = xcb_icccm_get_wm_class_reply(connection,
+                cookies[i], &candidates[i].class, NULL);
+    }
+    free(cookies);
+
+    *number_of_candidates = count;
+    return candidates;
+}
+
+/* Free @candidates and their class names. */
+static void free_candidates(struct layout_candidate *candidates,
+        uint32_t number_of_candidates)
+{
+    for (uint32_t i = 0; i < number_of_candidates; i++) {
+        if (candidates[i].has_class) {
+            xcb_icccm_get_wm_class_reply_wipe(&candidates[i].class);
+        }
+    }
+    free(candidates);
+}
+
+/* Build real frames from @layout_frame.
+ *
+ * Only the windows of this process that are within @candidates are put into
+ * the frames, they are marked as visible. Frames whose window is not found are
+ * left empty, see `fill_frame_by_class()`.
+ */
+static Frame *build_frame(const struct layout_frame *layout_frame,
+        struct layout_candidate *candidates, uint32_t number_of_candidates)
+{
+    Frame *frame;
+    Window *window;
+
+    frame = xcalloc(1, sizeof(*frame));
+    tag_memory(frame, MEMORY_TAG_FRAMES);
+    if (layout_frame->left != NULL) {
+        frame->split_direction = layout_frame->split_direction;
+        frame->ratio = layout_frame->ratio;
+        frame->left = build_frame(layout_frame->left, candidates,
+                number_of_candidates);
+        frame->right = build_frame(layout_frame->right, candidates,
+                number_of_candidates);
+        frame->left->parent = frame;
+        frame->right->parent = frame;
+    } else if (layout_frame->window != XCB_NONE) {
+        for (uint32_t i = 0; i < number_of_candidates; i++) {
+            window = candidates[i].window;
+            if (window->client.id == layout_frame->window) {
+                if (!window->state.is_visible) {
+                    frame->window = window;
+                    window->state.is_visible = true;
+                }
+                break;
+            }
+        }
+    }
+    return frame;
+}
+
+/* Put the first candidate with the instance and class name of the window in
+ * @layout_frame into the empty frames of @frame.
+ *
+ * This is done after all frames were built so that the exact windows of
+ * `build_frame()` are not taken by another frame.
+ */
+static void fill_frame_by_class(Frame *frame,
+        const struct layout_frame *layout_frame,
+        struct layout_candidate *candidates, uint32_t number_of_candidates)
+{
+    struct layout_candidate *candidate;
+
+    if (frame->left != NULL) {
+        fill_frame_by_class(frame->left, layout_frame->left, candidates,
+                number_of_candidates);
+        fill_frame_by_class(frame->right, layout_frame->right, candidates,
+                number_of_candidates);
+        return;
+    }
+
+    if (frame->window != NULL || layout_frame->instance_name == NULL) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < number_of_candidates; i++) {
+        candidate = &candidates[i];
+        if (!candidate->has_class || candidate->window->state.is_visible ||
+                strcmp(candidate->class.instance_name,
+                    layout_frame->instance_name) != 0 ||
+                strcmp(candidate->class.class_name,
+                    layout_frame->class_name) != 0) {
+            continue;
+        }
+        frame->window = candidate->window;
+        frame->window->state.is_visible = true;
+        break;
+    }
+}
+
+/* Take the windows that were put into another frame out of @frame.
+ *
+ * @return the number of windows left in @frame.
+ */
+static uint32_t remove_placed_windows(Frame *frame)
+{
+    if (frame->left != NULL) {
+        return remove_placed_windows(frame->left) +
+            remove_placed_windows(frame->right);
+    }
+    if (frame->window == NULL) {
+        return 0;
+    }
+    if (frame->window->state.is_visible) {
+        frame->window = NULL;
+        return 0;
+    }
+    return 1;
+}
+
+/* Free @frame and all its children. */
+static void free_frame_recursively(Frame *frame)
+{
+    if (frame->left != NULL) {
+        free_frame_recursively(frame->left);
+        free_frame_recursively(frame->right);
+    }
+    free(frame);
+}
+
+/* Hide all windows within @frame and its children. */
+static void hide_inner_windows(Frame *frame)
+{
+    if (frame->left != NULL) {
+        hide_inner_windows(frame->left);
+        hide_inner_windows(frame->right);
+    } else if (frame->window != NULL) {
+        hide_window_abruptly(frame->window);
+    }
+}
+
+/* Get the monitor with given name.
+ *
+ * @return NULL if no monitor has that name.
+ */
+static Monitor *get_monitor_by_name(const char *name)
+{
+    for (Monitor *monitor = first_monitor; monitor != NULL;
+            monitor = monitor->next) {
+        if (strcmp(monitor->name, name) == 0) {
+            return monitor;
+        }
+    }
+    return NULL;
+}
+
+/* Restore the layout with given @name. */
+int restore_layout(const char *name)
+{
+    struct layout *layout;
+    Monitor *monitor;
+    Frame *frame;
+    int32_t center_x, center_y;
+    Frame **old_frames;
+    struct layout_candidate *candidates;
+    uint32_t number_of_candidates;
+
+    for (layout = first_layout; layout != NULL; layout = layout->next) {
+        if (strcmp(layout->name, name) == 0) {
+            break;
+        }
+    }
+
+    if (layout == NULL) {
+        layout = read_layout_file(name);
+        if (layout == NULL) {
+            return ERROR;
+        }
+        add_layout(layout);
+    }
+
+    center_x = focus_frame->x + focus_frame->width / 2;
+    center_y = focus_frame->y + focus_frame->height / 2;
+
+    /* first take the frames out of the affected monitors and hide their
+     * windows so they can move to a different frame or monitor, they are only
+     * unmapped on the next synchronization if no frame takes them
+     */
+    old_frames = xcalloc(layout->number_of_monitors, sizeof(*old_frames));
+    for (uint32_t i = 0; i < layout->number_of_monitors; i++) {
+        monitor = get_monitor_by_name(layout->monitors[i].name);
+        if (monitor != NULL) {
+            hide_inner_windows(monitor->frame);
+            old_frames[i] = stash_frame_later(monitor->frame);
+        }
+    }
+
+    candidates = get_candidates(&number_of_candidates);
+
+    /* then build the frames, the windows are not sized yet */
+    for (uint32_t i = 0; i < layout->number_of_monitors; i++) {
+        monitor = get_monitor_by_name(layout->monitors[i].name);
+        /* also skip monitors appearing twice */
+        if (monitor == NULL || monitor->frame->left != NULL ||
+                monitor->frame->window != NULL) {
+            continue;
+        }
+
+        frame = build_frame(layout->monitors[i].frame, candidates,
+                number_of_candidates);
+        fill_frame_by_class(frame, layout->monitors[i].frame, candidates,
+                number_of_candidates);
+        /* this sizes all frames and windows in one pass */
+        replace_frame(monitor->frame, frame);
+        free(frame);
+    }
+
+    free_candidates(candidates, number_of_candidates);
+
+    /* only stash the windows the layout did not place */
+    for (uint32_t i = 0; i < layout->number_of_monitors; i++) {
+        if (old_frames[i] == NULL) {
+            continue;
+        }
+        if (remove_placed_windows(old_frames[i]) > 0) {
+            link_frame_into_stash(old_frames[i]);
+        } else {
+            free_frame_recursively(old_frames[i]);
+        }
+    }
+    free(old_frames);
+
+    /* the old focus frame might be in the stash now */
+    frame = get_frame_at_position(center_x, center_y);
+    if (frame == NULL) {
+        frame = first_monitor->frame;
+        while (frame->left != NULL) {
+            frame = frame->left;
+        }
+    }
+    focus_frame = frame;
+    if (focus_window == NULL ||
+            focus_window->state.mode == WINDOW_MODE_TILING) {
+        set_focus_window(frame->window);
+    }
+
+    LOG("restored layout %s\n", name);
+    return OK;
+}
@@ -7,6 +7,8 @@
 #include "monitor.h"
 #include "program_options.h"
 #include "render.h"
+#include "restart.h"
+#include "screen.h"
 #include "window.h"
 #include "x11_management.h"
 #include "xalloc.h"
@@ -14,6 +16,11 @@
 /* FENSTERCHEF main entry point. */
 int main(int argc, char **argv)
 {
+    bool is_restored;
+
+    /* keep the original arguments for restarting */
+    save_restart_arguments(argc, argv);
+
     /* parse the program arguments */
     if (parse_program_arguments(argc, argv) != OK) {
         exit(EXIT_FAILURE);
@@ -23,7 +30,7 @@ int main(int argc, char **argv)
     LOG("the configuration file may reside in %s\n", fensterchef_configuration);
     LOG("parsed arguments, starting to log\n");
 
-    /* initialize the X connection and X atoms */
+    /* initialize the X connection, X atoms and the screens to manage */
     if (initialize_x11() != OK) {
         quit_fensterchef(EXIT_FAILURE);
     }
@@ -39,7 +46,7 @@ int main(int argc, char **argv)
         quit_fensterchef(EXIT_FAILURE);
     }
 
-    /* initialize graphical stock objects used for rendering */
+    /* initialize the picture formats and the font */
     if (initialize_renderer() != OK) {
         quit_fensterchef(EXIT_FAILURE);
     }
@@ -49,11 +56,23 @@ int main(int argc, char **argv)
         quit_fensterchef(EXIT_FAILURE);
     }
 
-    /* initialize randr if possible and the initial frames */
-    initialize_monitors();
+    for (uint32_t i = 0; i < number_of_managed_screens; i++) {
+        switch_screen(i);
+
+        /* initialize graphical stock objects used for rendering */
+        if (create_stock_objects() != OK) {
+            quit_fensterchef(EXIT_FAILURE);
+        }
+
+        /* initialize randr if possible and the initial frames */
+        initialize_monitors();
+
+        /* set the X properties on the root window */
+        initialize_root_properties();
+    }
 
-    /* set the X properties on the root window */
-    initialize_root_properties();
+    /* register the event handlers, this needs the randr event base */
+    initialize_event_handlers();
 
     /* load the default configuration and the user configuration, this also
      * initializes the bindings and font
@@ -61,20 +80,43 @@ int main(int argc, char **argv)
     load_default_configuration();
     reload_user_configuration();
 
-    /* manage the windows that are already there */
+    /* take over the layout of a previous fensterchef process on all screens,
+     * the startup actions already ran in that process
+     */
+    switch_screen(0);
+    is_restored = restore_from_snapshot() == OK;
+
+    /* manage the windows that are already there, after a restore these are
+     * the windows that are not in the snapshot, for example the ones mapped
+     * while the new process was starting
+     */
     query_existing_windows();
 
-    /* run all startup actions */
-    LOG("running startup actions: %A\n",
-            configuration.startup.number_of_actions,
-            configuration.startup.actions);
-    for (uint32_t i = 0; i < configuration.startup.number_of_actions; i++) {
-        do_action(&configuration.startup.actions[i], focus_window);
+    if (!is_restored) {
+        /* run all startup actions */
+        LOG("running startup actions: %A\n",
+                configuration.startup.number_of_actions,
+                configuration.startup.actions);
+        begin_action_transaction();
+        for (uint32_t i = 0; i < configuration.startup.number_of_actions;
+                i++) {
+            do_action(&configuration.startup.actions[i], focus_window);
+        }
+        end_action_transaction();
     }
 
-    /* do an inital synchronization */
-    synchronize_with_server();
-    synchronize_client_list();
+    for (uint32_t i = 0; i < number_of_managed_screens; i++) {
+        switch_screen(i);
+
+        /* manage the windows that are already on the other screens */
+        if (i > 0) {
+            query_existing_windows();
+        }
+
+        /* do an inital synchronization */
+        synchronize_with_server();
+        synchronize_client_list();
+    }
 
     /* before entering the loop, flush all the initialization calls */
     xcb_flush(connection);
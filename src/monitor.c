@@ -32,8 +32,8 @@ static Monitor *create_monitor(const char *name, uint32_t name_len)
     return monitor;
 }
 
-/* Try to initialize randr. */
-void initialize_monitors(void)
+/* Check if the randr extension is there and get its event base. */
+static void query_randr_extension(void)
 {
     const xcb_query_extension_reply_t *extension;
     xcb_generic_error_t *error;
@@ -58,7 +58,20 @@ void initialize_monitors(void)
 
         randr_enabled = true;
         randr_event_base = extension->first_event;
+    }
+}
+
+/* Try to initialize randr. */
+void initialize_monitors(void)
+{
+    static bool is_randr_queried;
+
+    if (!is_randr_queried) {
+        query_randr_extension();
+        is_randr_queried = true;
+    }
 
+    if (randr_enabled) {
         xcb_randr_select_input(connection, screen->root,
                 XCB_RANDR_NOTIFY_MASK_SCREEN_CHANGE |
                 XCB_RANDR_NOTIFY_MASK_OUTPUT_CHANGE |
@@ -352,6 +365,7 @@ void merge_monitors(Monitor *monitors)
             stash_frame(monitor->frame);
             free(monitor->frame);
         }
+        free(monitor->free_rectangles);
         free(monitor->name);
         free(monitor);
     }
@@ -0,0 +1,522 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "log.h"
+#include "placement.h"
+#include "window.h"
+
+/* the rectangles split off while occupying or releasing space */
+static struct {
+    /* the rectangles */
+    Rectangle *rectangles;
+    /* the number of rectangles in `rectangles` */
+    uint32_t number_of_rectangles;
+    /* the allocated length of `rectangles` */
+    uint32_t capacity;
+} pieces;
+
+/* an occupied region taken away from the pieces */
+struct obstacle {
+    /* the occupied region */
+    Rectangle rectangle;
+    /* the distance to the released region */
+    uint32_t distance;
+};
+
+/* the occupied regions sorted by their distance to the released region */
+static struct {
+    /* the obstacles */
+    struct obstacle *obstacles;
+    /* the allocated length of `obstacles` */
+    uint32_t capacity;
+} obstacles;
+
+/* Check if the two rectangles are the same. */
+static inline bool is_rectangle_equal(const Rectangle *first,
+        const Rectangle *second)
+{
+    return first->x == second->x && first->y == second->y &&
+        first->width == second->width && first->height == second->height;
+}
+
+/* Check if @inner is completely within @outer. */
+static inline bool is_rectangle_contained(const Rectangle *inner,
+        const Rectangle *outer)
+{
+    return inner->x >= outer->x && inner->y >= outer->y &&
+        inner->x + (int32_t) inner->width <=
+            outer->x + (int32_t) outer->width &&
+        inner->y + (int32_t) inner->height <=
+            outer->y + (int32_t) outer->height;
+}
+
+/* Check if the two rectangles intersect. */
+static inline bool is_rectangle_overlapping(const Rectangle *first,
+        const Rectangle *second)
+{
+    return first->x < second->x + (int32_t) second->width &&
+        second->x < first->x + (int32_t) first->width &&
+        first->y < second->y + (int32_t) second->height &&
+        second->y < first->y + (int32_t) first->height;
+}
+
+/* Check if @first comes before @second in the free rectangles of a monitor.
+ *
+ * They are ordered by area, then from top to bottom, then from left to right
+ * and last by width.
+ */
+static bool is_rectangle_before(const Rectangle *first,
+        const Rectangle *second)
+{
+    const uint64_t first_area = (uint64_t) first->width * first->height;
+    const uint64_t second_area = (uint64_t) second->width * second->height;
+
+    if (first_area != second_area) {
+        return first_area < second_area;
+    }
+    if (first->y != second->y) {
+        return first->y < second->y;
+    }
+    if (first->x != second->x) {
+        return first->x < second->x;
+    }
+    return first->width < second->width;
+}
+
+/* Get the index of the first free rectangle of @monitor that does not come
+ * before @rectangle.
+ */
+static uint32_t find_free_rectangle(const Monitor *monitor,
+        const Rectangle *rectangle)
+{
+    uint32_t low = 0, high = monitor->number_of_free_rectangles;
+    uint32_t middle;
+
+    while (low < high) {
+        middle = low + (high - low) / 2;
+        if (is_rectangle_before(&monitor->free_rectangles[middle],
+                    rectangle)) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+/* Insert @rectangle into the ordered free rectangles of @monitor. */
+static void insert_free_rectangle(Monitor *monitor, const Rectangle *rectangle)
+{
+    uint32_t index;
+
+    if (monitor->number_of_free_rectangles ==
+            monitor->free_rectangles_capacity) {
+        monitor->free_rectangles_capacity *= 2;
+        monitor->free_rectangles_capacity += 8;
+        RESIZE(monitor->free_rectangles, monitor->free_rectangles_capacity);
+    }
+
+    index = find_free_rectangle(monitor, rectangle);
+    memmove(&monitor->free_rectangles[index + 1],
+            &monitor->free_rectangles[index],
+            sizeof(*monitor->free_rectangles) *
+                (monitor->number_of_free_rectangles - index));
+    monitor->free_rectangles[index] = *rectangle;
+    monitor->number_of_free_rectangles++;
+}
+
+/* Remove the free rectangles of @monitor marked with a width of 0, this keeps
+ * the order.
+ */
+static void remove_marked_free_rectangles(Monitor *monitor)
+{
+    uint32_t count = 0;
+
+    for (uint32_t i = 0; i < monitor->number_of_free_rectangles; i++) {
+        if (monitor->free_rectangles[i].width > 0) {
+            monitor->free_rectangles[count++] = monitor->free_rectangles[i];
+        }
+    }
+    monitor->number_of_free_rectangles = count;
+}
+
+/* Add @rectangle to the split off pieces. */
+static void add_piece(const Rectangle *rectangle)
+{
+    if (pieces.number_of_rectangles == pieces.capacity) {
+        pieces.capacity *= 2;
+        pieces.capacity += 8;
+        RESIZE(pieces.rectangles, pieces.capacity);
+    }
+    pieces.rectangles[pieces.number_of_rectangles++] = *rectangle;
+}
+
+/* Add the up to four parts of @space around @occupied to the pieces. */
+static void split_rectangle(const Rectangle *space, const Rectangle *occupied)
+{
+    Rectangle split;
+
+    /* the part on the left */
+    if (occupied->x > space->x) {
+        split = *space;
+        split.width = occupied->x - space->x;
+        add_piece(&split);
+    }
+
+    /* the part on the right */
+    if (occupied->x + (int32_t) occupied->width <
+            space->x + (int32_t) space->width) {
+        split = *space;
+        split.x = occupied->x + occupied->width;
+        split.width = space->x + space->width - split.x;
+        add_piece(&split);
+    }
+
+    /* the part above */
+    if (occupied->y > space->y) {
+        split = *space;
+        split.height = occupied->y - space->y;
+        add_piece(&split);
+    }
+
+    /* the part below */
+    if (occupied->y + (int32_t) occupied->height <
+            space->y + (int32_t) space->height) {
+        split = *space;
+        split.y = occupied->y + occupied->height;
+        split.height = space->y + space->height - split.y;
+        add_piece(&split);
+    }
+}
+
+/* Check if piece @index is contained in another piece, for equal pieces only
+ * the first one is not contained.
+ */
+static bool is_piece_contained(uint32_t index)
+{
+    const Rectangle *const piece = &pieces.rectangles[index];
+
+    for (uint32_t i = 0; i < pieces.number_of_rectangles; i++) {
+        if (i == index || !is_rectangle_contained(piece,
+                    &pieces.rectangles[i])) {
+            continue;
+        }
+        if (i < index || !is_rectangle_equal(piece, &pieces.rectangles[i])) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Take @occupied away from the free space of @monitor.
+ *
+ * Only the rectangles split off the free rectangles overlapping @occupied can
+ * be non maximal, all other free rectangles stay as they are.
+ */
+static void occupy_free_space(Monitor *monitor, const Rectangle *occupied)
+{
+    Rectangle *space;
+    const Rectangle *piece;
+    uint32_t i, j;
+
+    pieces.number_of_rectangles = 0;
+    for (i = 0; i < monitor->number_of_free_rectangles; i++) {
+        space = &monitor->free_rectangles[i];
+        if (!is_rectangle_overlapping(space, occupied)) {
+            continue;
+        }
+        split_rectangle(space, occupied);
+        /* mark the rectangle as removed */
+        space->width = 0;
+    }
+
+    remove_marked_free_rectangles(monitor);
+
+    for (i = 0; i < pieces.number_of_rectangles; i++) {
+        piece = &pieces.rectangles[i];
+        if (is_piece_contained(i)) {
+            continue;
+        }
+        /* only rectangles that are not smaller can contain the piece */
+        for (j = find_free_rectangle(monitor, piece);
+                j < monitor->number_of_free_rectangles; j++) {
+            if (is_rectangle_contained(piece, &monitor->free_rectangles[j])) {
+                break;
+            }
+        }
+        if (j == monitor->number_of_free_rectangles) {
+            insert_free_rectangle(monitor, piece);
+        }
+    }
+}
+
+/* Get the distance between the two rectangles along the axis where they are
+ * further apart, this is 0 if they touch or intersect.
+ */
+static uint32_t get_rectangle_distance(const Rectangle *first,
+        const Rectangle *second)
+{
+    int32_t horizontal, vertical;
+
+    horizontal = MAX(first->x - second->x - (int32_t) second->width,
+            second->x - first->x - (int32_t) first->width);
+    vertical = MAX(first->y - second->y - (int32_t) second->height,
+            second->y - first->y - (int32_t) first->height);
+    return MAX(MAX(horizontal, vertical), 0);
+}
+
+/* Compare two obstacles by their distance. */
+static int compare_obstacles(const void *first, const void *second)
+{
+    const struct obstacle *const first_obstacle = first;
+    const struct obstacle *const second_obstacle = second;
+
+    if (first_obstacle->distance < second_obstacle->distance) {
+        return -1;
+    }
+    return first_obstacle->distance > second_obstacle->distance;
+}
+
+/* Take @occupied away from the pieces but drop every piece that does not
+ * intersect @released or that is not maximal.
+ */
+static void subtract_from_pieces(const Rectangle *occupied,
+        const Rectangle *released)
+{
+    const uint32_t count = pieces.number_of_rectangles;
+    uint32_t index;
+    bool was_split = false;
+
+    for (uint32_t i = 0; i < count; i++) {
+        if (!is_rectangle_overlapping(&pieces.rectangles[i], occupied)) {
+            continue;
+        }
+        split_rectangle(&pieces.rectangles[i], occupied);
+        /* mark the piece as removed */
+        pieces.rectangles[i].width = 0;
+        was_split = true;
+    }
+
+    if (!was_split) {
+        return;
+    }
+
+    index = 0;
+    for (uint32_t i = 0; i < pieces.number_of_rectangles; i++) {
+        if (pieces.rectangles[i].width > 0 &&
+                is_rectangle_overlapping(&pieces.rectangles[i], released)) {
+            pieces.rectangles[index++] = pieces.rectangles[i];
+        }
+    }
+    pieces.number_of_rectangles = index;
+
+    index = 0;
+    for (uint32_t i = 0; i < pieces.number_of_rectangles; i++) {
+        if (!is_piece_contained(i)) {
+            pieces.rectangles[index++] = pieces.rectangles[i];
+        }
+    }
+    pieces.number_of_rectangles = index;
+}
+
+/* Give @released back to the free space of @monitor.
+ *
+ * The maximal empty rectangles that intersect @released are computed from the
+ * region of the free space by taking away all occupied regions but dropping
+ * every piece that does not intersect @released. Then all free rectangles
+ * within these are replaced by them.
+ *
+ * The occupied regions closest to @released are taken away first, they cut
+ * off most of the pieces early.
+ */
+static void release_free_space(Monitor *monitor, const Rectangle *released)
+{
+    const Rectangle *occupied;
+    uint32_t number_of_obstacles = 0;
+    uint32_t end;
+    uint32_t i, j;
+
+    if (!is_rectangle_overlapping(&monitor->free_space_bounds, released)) {
+        return;
+    }
+
+    for (Window *window = first_window; window != NULL;
+            window = window->next) {
+        occupied = &window->occupied_space;
+        if (occupied->width == 0) {
+            continue;
+        }
+
+        if (number_of_obstacles == obstacles.capacity) {
+            obstacles.capacity *= 2;
+            obstacles.capacity += 8;
+            RESIZE(obstacles.obstacles, obstacles.capacity);
+        }
+        obstacles.obstacles[number_of_obstacles].rectangle = *occupied;
+        obstacles.obstacles[number_of_obstacles].distance =
+            get_rectangle_distance(occupied, released);
+        number_of_obstacles++;
+    }
+    qsort(obstacles.obstacles, number_of_obstacles,
+            sizeof(*obstacles.obstacles), compare_obstacles);
+
+    pieces.number_of_rectangles = 0;
+    add_piece(&monitor->free_space_bounds);
+    for (i = 0; i < number_of_obstacles; i++) {
+        subtract_from_pieces(&obstacles.obstacles[i].rectangle, released);
+    }
+
+    /* remove the free rectangles that grew into one of the pieces, only
+     * rectangles that are not larger than a piece can be within it
+     */
+    end = 0;
+    for (i = 0; i < pieces.number_of_rectangles; i++) {
+        end = MAX(end, find_free_rectangle(monitor, &pieces.rectangles[i]) + 1);
+    }
+    end = MIN(end, monitor->number_of_free_rectangles);
+    for (i = 0; i < end; i++) {
+        for (j = 0; j < pieces.number_of_rectangles; j++) {
+            if (is_rectangle_contained(&monitor->free_rectangles[i],
+                        &pieces.rectangles[j])) {
+                monitor->free_rectangles[i].width = 0;
+                break;
+            }
+        }
+    }
+    remove_marked_free_rectangles(monitor);
+
+    for (i = 0; i < pieces.number_of_rectangles; i++) {
+        insert_free_rectangle(monitor, &pieces.rectangles[i]);
+    }
+}
+
+/* Make sure the free space of @monitor is built for its current strut. */
+static void prepare_free_space(Monitor *monitor)
+{
+    Rectangle bounds;
+
+    /* the area the monitor has without the strut */
+    bounds.x = monitor->x + monitor->strut.left;
+    bounds.y = monitor->y + monitor->strut.top;
+    bounds.width = monitor->width - monitor->strut.left -
+        monitor->strut.right;
+    bounds.height = monitor->height - monitor->strut.top -
+        monitor->strut.bottom;
+
+    if (monitor->is_free_space_valid &&
+            is_rectangle_equal(&bounds, &monitor->free_space_bounds)) {
+        return;
+    }
+
+    /* rebuild the free space from the regions the windows occupy */
+    monitor->number_of_free_rectangles = 0;
+    monitor->free_space_bounds = bounds;
+    if (bounds.width > 0 && bounds.height > 0) {
+        insert_free_rectangle(monitor, &bounds);
+    }
+
+    for (Window *window = first_window; window != NULL;
+            window = window->next) {
+        if (window->occupied_space.width > 0) {
+            occupy_free_space(monitor, &window->occupied_space);
+        }
+    }
+
+    monitor->is_free_space_valid = true;
+}
+
+/* Let @window occupy @occupied instead of the region it occupied before. */
+static void set_occupied_space(Window *window, const Rectangle *occupied)
+{
+    Rectangle released;
+
+    if (is_rectangle_equal(&window->occupied_space, occupied)) {
+        return;
+    }
+
+    released = window->occupied_space;
+    window->occupied_space = *occupied;
+
+    for (Monitor *monitor = first_monitor; monitor != NULL;
+            monitor = monitor->next) {
+        prepare_free_space(monitor);
+        if (released.width > 0) {
+            release_free_space(monitor, &released);
+        }
+        if (occupied->width > 0) {
+            occupy_free_space(monitor, occupied);
+        }
+    }
+}
+
+/* Update the region @window occupies in the free space. */
+void update_window_free_space(Window *window)
+{
+    Rectangle occupied;
+
+    if (window->state.is_visible &&
+            window->state.mode != WINDOW_MODE_TILING) {
+        occupied.x = window->x;
+        occupied.y = window->y;
+        occupied.width = window->width + window->border_size * 2;
+        occupied.height = window->height + window->border_size * 2;
+    } else {
+        occupied.x = 0;
+        occupied.y = 0;
+        occupied.width = 0;
+        occupied.height = 0;
+    }
+    set_occupied_space(window, &occupied);
+}
+
+/* Give the region @window occupies back to the free space. */
+void release_window_free_space(Window *window)
+{
+    const Rectangle nothing = { 0, 0, 0, 0 };
+
+    set_occupied_space(window, &nothing);
+}
+
+/* Move @geometry of @window into the free space of @monitor. */
+bool place_in_free_space(Window *window, Monitor *monitor,
+        Rectangle *geometry)
+{
+    const Rectangle *space;
+    Rectangle occupied;
+    uint32_t index;
+
+    prepare_free_space(monitor);
+
+    occupied.x = INT32_MIN;
+    occupied.y = INT32_MIN;
+    occupied.width = geometry->width + window->border_size * 2;
+    occupied.height = geometry->height + window->border_size * 2;
+
+    /* find the smallest free rectangle the window fits into, rectangles that
+     * are more to the top left come first for the same area
+     */
+    for (index = find_free_rectangle(monitor, &occupied);
+            index < monitor->number_of_free_rectangles; index++) {
+        if (monitor->free_rectangles[index].width >= occupied.width &&
+                monitor->free_rectangles[index].height >= occupied.height) {
+            break;
+        }
+    }
+
+    if (index == monitor->number_of_free_rectangles) {
+        return false;
+    }
+
+    space = &monitor->free_rectangles[index];
+
+    geometry->x = space->x;
+    geometry->y = space->y;
+
+    LOG("placing window into free space at %R\n", geometry->x, geometry->y,
+            geometry->width, geometry->height);
+
+    occupied.x = geometry->x;
+    occupied.y = geometry->y;
+    set_occupied_space(window, &occupied);
+    return true;
+}
@@ -0,0 +1,13 @@
+#include "probe.h"
+
+#ifdef USDT_PROBES
+
+/* the probe semaphores, these must be in the `.probes` section so that the
+ * tracer finds them
+ */
+#define X(name) unsigned short fensterchef_##name##_semaphore \
+    __attribute__((section(".probes")));
+DEFINE_ALL_PROBES
+#undef X
+
+#endif
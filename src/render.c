@@ -2,7 +2,9 @@
 
 #include <xcb/xcb_renderutil.h>
 
+#include "configuration.h"
 #include "log.h"
+#include "probe.h"
 #include "render.h"
 #include "utf8.h"
 #include "utility.h"
@@ -32,19 +34,54 @@ static struct font {
     uint32_t number_of_faces;
     /* the xcb glyphset containing glyphs */
     xcb_render_glyphset_t glyphset;
-    /* we use this to remember which glyphs we added to the glyphset */
-    FcCharSet *charset;
 } font;
 
+/* a glyph that was added to the glyphset */
+struct cached_glyph {
+    /* the codepoint of the glyph, this is also the glyph id on the server */
+    uint32_t glyph;
+    /* the number of bytes the glyph takes up on the server */
+    uint32_t size;
+    /* the next glyph in the same hash bucket */
+    struct cached_glyph *next;
+    /* the glyphs used more and less recently than this one */
+    struct cached_glyph *newer;
+    struct cached_glyph *older;
+};
+
+/* the glyphs within the glyphset, used glyphs are moved to the front and
+ * the least recently used glyphs are freed when the configured size is
+ * exceeded
+ */
+static struct glyph_cache {
+    /* hash table of all cached glyphs by their codepoint */
+    struct cached_glyph **buckets;
+    /* the number of buckets, this is always a power of two or 0 */
+    uint32_t number_of_buckets;
+    /* the number of cached glyphs */
+    uint32_t number_of_glyphs;
+    /* the most recently used glyph */
+    struct cached_glyph *newest;
+    /* the least recently used glyph */
+    struct cached_glyph *oldest;
+    /* the total size of all cached glyphs in bytes */
+    size_t size;
+    /* statistics about the cache usage */
+    struct glyph_cache_statistics statistics;
+} glyph_cache;
+
 /* a mapping from drawable to picture */
-static struct window_picture_cache {
+struct window_picture_cache {
     /* the id of the drawable */
     xcb_drawable_t xcb_drawable;
     /* the picture created for the drawable */
     xcb_render_picture_t picture;
     /* the next cache object in the linked list */
     struct window_picture_cache *next;
-} *window_picture_cache_head;
+};
+
+/* the pictures created for the windows of the current screen */
+struct window_picture_cache *window_picture_cache_head;
 
 /* Get the format of a visual. */
 static xcb_render_pictformat_t find_visual_format(xcb_visualid_t visual)
@@ -88,6 +125,168 @@ static xcb_render_pictformat_t get_picture_format(uint8_t depth)
     return 0;
 }
 
+/* Remove @cached from the recently used list. */
+static void unlink_cached_glyph(struct cached_glyph *cached)
+{
+    if (cached->newer == NULL) {
+        glyph_cache.newest = cached->older;
+    } else {
+        cached->newer->older = cached->older;
+    }
+    if (cached->older == NULL) {
+        glyph_cache.oldest = cached->newer;
+    } else {
+        cached->older->newer = cached->newer;
+    }
+}
+
+/* Put @cached at the front of the recently used list. */
+static void link_cached_glyph(struct cached_glyph *cached)
+{
+    cached->newer = NULL;
+    cached->older = glyph_cache.newest;
+    if (glyph_cache.newest == NULL) {
+        glyph_cache.oldest = cached;
+    } else {
+        glyph_cache.newest->newer = cached;
+    }
+    glyph_cache.newest = cached;
+}
+
+/* Get the hash bucket of @glyph. */
+static inline struct cached_glyph **get_glyph_bucket(uint32_t glyph)
+{
+    /* Knuth's multiplicative hash spreads the close codepoints */
+    return &glyph_cache.buckets[(glyph * 2654435761u) &
+        (glyph_cache.number_of_buckets - 1)];
+}
+
+/* Find @glyph within the glyph cache.
+ *
+ * @return NULL if the glyph is not in the glyphset.
+ */
+static struct cached_glyph *find_cached_glyph(uint32_t glyph)
+{
+    struct cached_glyph *cached;
+
+    if (glyph_cache.number_of_buckets == 0) {
+        return NULL;
+    }
+
+    for (cached = *get_glyph_bucket(glyph); cached != NULL;
+            cached = cached->next) {
+        if (cached->glyph == glyph) {
+            break;
+        }
+    }
+    return cached;
+}
+
+/* Add @glyph with @size bytes to the glyph cache. */
+static void add_cached_glyph(uint32_t glyph, uint32_t size)
+{
+    struct cached_glyph **old_buckets;
+    uint32_t old_number_of_buckets;
+    struct cached_glyph *cached, *next;
+    struct cached_glyph **bucket;
+
+    /* grow the hash table to keep the load factor at 1 or below */
+    if (glyph_cache.number_of_glyphs >= glyph_cache.number_of_buckets) {
+        old_buckets = glyph_cache.buckets;
+        old_number_of_buckets = glyph_cache.number_of_buckets;
+
+        glyph_cache.number_of_buckets = old_number_of_buckets == 0 ? 64 :
+            old_number_of_buckets * 2;
+        glyph_cache.buckets = xcalloc(glyph_cache.number_of_buckets,
+                sizeof(*glyph_cache.buckets));
+        tag_memory(glyph_cache.buckets, MEMORY_TAG_GLYPHS);
+
+        for (uint32_t i = 0; i < old_number_of_buckets; i++) {
+            for (cached = old_buckets[i]; cached != NULL; cached = next) {
+                next = cached->next;
+                bucket = get_glyph_bucket(cached->glyph);
+                cached->next = *bucket;
+                *bucket = cached;
+            }
+        }
+        free(old_buckets);
+    }
+
+    cached = xmalloc(sizeof(*cached));
+    tag_memory(cached, MEMORY_TAG_GLYPHS);
+    cached->glyph = glyph;
+    cached->size = size;
+    bucket = get_glyph_bucket(glyph);
+    cached->next = *bucket;
+    *bucket = cached;
+    link_cached_glyph(cached);
+
+    glyph_cache.number_of_glyphs++;
+    glyph_cache.size += size;
+}
+
+/* Remove @cached from the glyph cache and free it. */
+static void remove_cached_glyph(struct cached_glyph *cached)
+{
+    struct cached_glyph **bucket;
+
+    bucket = get_glyph_bucket(cached->glyph);
+    while (*bucket != cached) {
+        bucket = &(*bucket)->next;
+    }
+    *bucket = cached->next;
+
+    unlink_cached_glyph(cached);
+
+    glyph_cache.number_of_glyphs--;
+    glyph_cache.size -= cached->size;
+    free(cached);
+}
+
+/* Free the least recently used glyphs until the cache size is less than
+ * @maximum_size.
+ *
+ * This must not be called while glyphs are collected for a request because
+ * the glyphs are freed on the server immediately.
+ */
+static void evict_cold_glyphs(size_t maximum_size)
+{
+    uint32_t glyphs[64];
+    uint32_t number_of_glyphs = 0;
+
+    while (glyph_cache.size > maximum_size) {
+        glyphs[number_of_glyphs++] = glyph_cache.oldest->glyph;
+        remove_cached_glyph(glyph_cache.oldest);
+        glyph_cache.statistics.evictions++;
+
+        /* free the glyphs on the server in batches */
+        if (number_of_glyphs == SIZE(glyphs)) {
+            xcb_render_free_glyphs(connection, font.glyphset,
+                    number_of_glyphs, glyphs);
+            number_of_glyphs = 0;
+        }
+    }
+
+    if (number_of_glyphs > 0) {
+        xcb_render_free_glyphs(connection, font.glyphset,
+                number_of_glyphs, glyphs);
+    }
+}
+
+/* Keep the glyph cache within the configured size. */
+static inline void trim_glyph_cache(void)
+{
+    evict_cold_glyphs((size_t) configuration.font.cache_size * 1024);
+}
+
+/* Get the statistics of the glyph cache. */
+void get_glyph_cache_statistics(struct glyph_cache_statistics *statistics)
+{
+    *statistics = glyph_cache.statistics;
+    statistics->number_of_glyphs = glyph_cache.number_of_glyphs;
+    statistics->size = glyph_cache.size;
+}
+
 /* Free all data used by the font. */
 static void free_font(void)
 {
@@ -104,7 +303,9 @@ static void free_font(void)
     free(font.faces);
     font.faces = NULL;
     font.number_of_faces = 0;
-    FcCharSetDestroy(font.charset);
+
+    /* the glyphs were rendered with the old faces */
+    evict_cold_glyphs(0);
 }
 
 /* Initializes all parts needed for drawing fonts. */
@@ -142,13 +343,11 @@ static int initialize_font_drawing(void)
     return OK;
 }
 
-/* Initialize the graphical stock objects that can be used for rendering. */
+/* Initialize the picture formats and the font. */
 int initialize_renderer(void)
 {
     xcb_render_query_pict_formats_cookie_t formats_cookie;
     xcb_generic_error_t *error;
-    xcb_render_color_t color;
-    xcb_render_picture_t pen;
 
     /* the picture formats are the possible ways colors can be represented,
      * for example ARGB, 8 bit colors etc.
@@ -161,6 +360,21 @@ int initialize_renderer(void)
         return ERROR;
     }
 
+    /* continue running even when fonts do not work */
+    if (initialize_font_drawing() == OK) {
+        font.available = true;
+    }
+
+    return OK;
+}
+
+/* Create the graphical stock objects of the current screen. */
+int create_stock_objects(void)
+{
+    xcb_generic_error_t *error;
+    xcb_render_color_t color;
+    xcb_render_picture_t pen;
+
     for (uint32_t i = 0; i < STOCK_MAX; i++) {
         stock_objects[i] = xcb_generate_id(connection);
     }
@@ -208,12 +422,6 @@ int initialize_renderer(void)
         return ERROR;
     }
     stock_objects[STOCK_BLACK_PEN] = pen;
-
-    /* continue running even when fonts do not work */
-    if (initialize_font_drawing() == OK) {
-        font.available = true;
-    }
-
     return OK;
 }
 
@@ -349,6 +557,70 @@ xcb_render_picture_t create_pen(xcb_render_color_t color)
     return picture;
 }
 
+/* Create a picture from @width times @height premultiplied ARGB @pixels. */
+xcb_render_picture_t create_argb_picture(const uint32_t *pixels,
+        uint32_t width, uint32_t height)
+{
+    xcb_pixmap_t pixmap;
+    xcb_gcontext_t gc;
+    xcb_generic_error_t *error;
+    xcb_render_picture_t picture;
+
+    pixmap = xcb_generate_id(connection);
+    error = xcb_request_check(connection, xcb_create_pixmap_checked(connection,
+                32, pixmap, screen->root, width, height));
+    if (error != NULL) {
+        LOG_ERROR("could not create pixmap: %E\n", error);
+        free(error);
+        return XCB_NONE;
+    }
+
+    /* upload the pixels, the stock graphics contexts can not be used because
+     * they have the depth of the root window
+     */
+    gc = xcb_generate_id(connection);
+    xcb_create_gc(connection, gc, pixmap, 0, NULL);
+    xcb_put_image(connection, XCB_IMAGE_FORMAT_Z_PIXMAP, pixmap, gc,
+            width, height, 0, 0, 0, 32, width * height * sizeof(*pixels),
+            (const uint8_t*) pixels);
+    xcb_free_gc(connection, gc);
+
+    picture = xcb_generate_id(connection);
+    error = xcb_request_check(connection,
+            xcb_render_create_picture_checked(connection, picture, pixmap,
+                get_picture_format(32), 0, NULL));
+    /* the picture keeps its own reference to the pixmap */
+    xcb_free_pixmap(connection, pixmap);
+    if (error != NULL) {
+        LOG_ERROR("could not create picture: %E\n", error);
+        free(error);
+        return XCB_NONE;
+    }
+    return picture;
+}
+
+/* Draw @picture onto a given drawable at @x and @y. */
+void draw_picture(xcb_drawable_t xcb_drawable, xcb_render_picture_t picture,
+        int32_t x, int32_t y, uint32_t width, uint32_t height)
+{
+    xcb_render_picture_t destination;
+
+    destination = cache_window_picture(xcb_drawable);
+    if (destination == XCB_NONE) {
+        return;
+    }
+
+    xcb_render_composite(connection,
+            XCB_RENDER_PICT_OP_OVER, /* C = Ca + Cb * (1 - Aa) */
+            picture, /* source picture */
+            XCB_NONE, /* mask picture */
+            destination, /* destination picture */
+            0, 0, /* source position */
+            0, 0, /* mask position */
+            x, y, /* destination position */
+            width, height);
+}
+
 /* Create a font face using given pattern. */
 static FT_Face create_font_face(FcPattern *pattern)
 {
@@ -523,7 +795,7 @@ int set_font(const utf8_t *query)
 
     font.faces = faces;
     font.number_of_faces = number_of_faces;
-    font.charset = FcCharSetCreate();
+    tag_memory(font.faces, MEMORY_TAG_GLYPHS);
     return OK;
 }
 
@@ -595,6 +867,7 @@ static FT_Face load_glyph(uint32_t glyph, FT_Int32 load_flags)
 
     /* add the face to the font face list */
     RESIZE(font.faces, font.number_of_faces + 1);
+    tag_memory(font.faces, MEMORY_TAG_GLYPHS);
     font.faces[font.number_of_faces++] = face;
 
     glyph_index = FT_Get_Char_Index(face, glyph);
@@ -610,17 +883,23 @@ static FT_Face load_glyph(uint32_t glyph, FT_Int32 load_flags)
 /* Add the glyph to the cache if not already cached. */
 static FT_Face cache_glyph(uint32_t glyph)
 {
+    struct cached_glyph *cached;
     FT_Face face;
     xcb_render_glyphinfo_t glyph_info;
     uint32_t stride;
     uint8_t *temporary_bitmap;
+    uint64_t start;
 
     if (glyph == 0) {
         return NULL;
     }
 
     /* check if the glyph is already cached */
-    if (FcCharSetHasChar(font.charset, glyph)) {
+    cached = find_cached_glyph(glyph);
+    if (cached != NULL) {
+        glyph_cache.statistics.hits++;
+        unlink_cached_glyph(cached);
+        link_cached_glyph(cached);
         face = load_glyph(glyph, FT_LOAD_DEFAULT);
         if (face == NULL) {
             return NULL;
@@ -628,6 +907,10 @@ static FT_Face cache_glyph(uint32_t glyph)
         return face;
     }
 
+    glyph_cache.statistics.misses++;
+
+    start = START_PROBE_TIMER(glyph__miss);
+
     /* find the face that has the glyph and load it */
     face = load_glyph(glyph, FT_LOAD_RENDER);
     if (face == NULL) {
@@ -666,8 +949,11 @@ static FT_Face cache_glyph(uint32_t glyph)
 
     LOG_VERBOSE("cached glyph: " COLOR(GREEN) "U+%08x\n", glyph);
 
-    /* mark the glyph as cached */
-    FcCharSetAddChar(font.charset, glyph);
+    /* remember the glyph, the glyph information is also stored on the server */
+    add_cached_glyph(glyph, stride * glyph_info.height + sizeof(glyph_info));
+
+    PROBE3(glyph__miss, glyph, stride * glyph_info.height,
+            GET_PROBE_DURATION(start));
     return face;
 }
 
@@ -699,6 +985,9 @@ int draw_text(xcb_drawable_t xcb_drawable, const utf8_t *utf8, uint32_t length,
         return ERROR;
     }
 
+    /* make room before any glyph is referenced by a request */
+    trim_glyph_cache();
+
     /* get a picture to draw on */
     picture = cache_window_picture(xcb_drawable);
     if (picture == XCB_NONE) {
@@ -765,6 +1054,9 @@ void measure_text(const utf8_t *utf8, uint32_t length,
         return;
     }
 
+    /* make room, no glyph is referenced by a pending request here */
+    trim_glyph_cache();
+
     /* iterate over all glyphs */
     for (uint32_t i = 0; i < length; ) {
         U8_NEXT(utf8, i, length, glyph);
@@ -0,0 +1,680 @@
+/* needed for `memfd_create()` */
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "fensterchef.h"
+#include "frame.h"
+#include "log.h"
+#include "monitor.h"
+#include "restart.h"
+#include "screen.h"
+#include "stash_frame.h"
+#include "window.h"
+#include "xalloc.h"
+
+/* The snapshot is a native endian binary format, it is only ever read by the
+ * same machine that wrote it:
+ *
+ * magic, version
+ * number of screens
+ *     screen number, the state of that screen
+ *
+ * The state of a screen is:
+ * number of windows
+ *     id, number, mode, is visible, floating rectangle
+ *     (in age order, oldest first)
+ * number of monitors
+ *     length of the name, name, frame tree
+ * number of stashed frames
+ *     frame tree
+ *     (in stash order, last stashed first)
+ * focus window id, center of the focus frame
+ *
+ * A frame tree is written in pre-order, each frame starts with its kind. A leaf
+ * is followed by the id of its window and a parent is followed by its split
+ * direction, ratio and both children.
+ */
+
+/* the first bytes of a snapshot ("FCRS") */
+#define SNAPSHOT_MAGIC 0x53524346
+
+/* the snapshot version, increment when the format changes */
+#define SNAPSHOT_VERSION 3
+
+/* the maximum depth of a frame tree within a snapshot */
+#define SNAPSHOT_MAXIMUM_DEPTH 256
+
+/* the kind of a frame within the snapshot */
+#define SNAPSHOT_FRAME_LEAF 0
+#define SNAPSHOT_FRAME_PARENT 1
+
+/* the arguments fensterchef was started with */
+static char **restart_arguments;
+
+/* a growing buffer the snapshot is written into */
+struct snapshot_writer {
+    /* the written data */
+    uint8_t *data;
+    /* the number of written bytes */
+    size_t length;
+    /* the allocated size of `data` */
+    size_t capacity;
+};
+
+/* a snapshot being read */
+struct snapshot_reader {
+    /* the data of the snapshot */
+    const uint8_t *data;
+    /* the size of `data` */
+    size_t length;
+    /* the current read position */
+    size_t position;
+    /* if the read data should be applied or only be checked */
+    bool is_applying;
+};
+
+/* Remember the arguments fensterchef was started with. */
+void save_restart_arguments(int argc, char **argv)
+{
+    restart_arguments = xreallocarray(NULL, argc + 1,
+            sizeof(*restart_arguments));
+    for (int i = 0; i < argc; i++) {
+        restart_arguments[i] = xstrdup(argv[i]);
+    }
+    restart_arguments[argc] = NULL;
+}
+
+/* Append @size bytes of @data to the snapshot. */
+static void write_bytes(struct snapshot_writer *writer, const void *data,
+        size_t size)
+{
+    if (writer->length + size > writer->capacity) {
+        writer->capacity = MAX(writer->capacity * 2, writer->length + size);
+        RESIZE(writer->data, writer->capacity);
+    }
+    memcpy(&writer->data[writer->length], data, size);
+    writer->length += size;
+}
+
+/* Append a single byte to the snapshot. */
+static void write_8(struct snapshot_writer *writer, uint8_t value)
+{
+    write_bytes(writer, &value, sizeof(value));
+}
+
+/* Append a 32 bit value to the snapshot. */
+static void write_32(struct snapshot_writer *writer, uint32_t value)
+{
+    write_bytes(writer, &value, sizeof(value));
+}
+
+/* Check if @window is still in the window list. */
+static bool is_window_alive(const Window *window)
+{
+    for (Window *other = first_window; other != NULL; other = other->next) {
+        if (other == window) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Write @frame and all its children to the snapshot. */
+static void write_frame(struct snapshot_writer *writer, const Frame *frame)
+{
+    if (frame->left != NULL) {
+        write_8(writer, SNAPSHOT_FRAME_PARENT);
+        write_8(writer, frame->split_direction);
+        write_32(writer, frame->ratio);
+        write_frame(writer, frame->left);
+        write_frame(writer, frame->right);
+    } else {
+        write_8(writer, SNAPSHOT_FRAME_LEAF);
+        /* stashed frames may refer to windows that are gone */
+        if (frame->window != NULL && is_window_alive(frame->window)) {
+            write_32(writer, frame->window->client.id);
+        } else {
+            write_32(writer, XCB_NONE);
+        }
+    }
+}
+
+/* Write the state of the current screen into @writer. */
+static void write_screen(struct snapshot_writer *writer)
+{
+    uint32_t count;
+
+    write_32(writer, current_screen->number);
+
+    /* write all windows */
+    count = 0;
+    for (Window *window = oldest_window; window != NULL;
+            window = window->newer) {
+        count++;
+    }
+    write_32(writer, count);
+    for (Window *window = oldest_window; window != NULL;
+            window = window->newer) {
+        write_32(writer, window->client.id);
+        write_32(writer, window->number);
+        write_8(writer, window->state.mode);
+        write_8(writer, window->state.is_visible);
+        write_32(writer, window->properties->floating.x);
+        write_32(writer, window->properties->floating.y);
+        write_32(writer, window->properties->floating.width);
+        write_32(writer, window->properties->floating.height);
+    }
+
+    /* write the frames of all monitors */
+    count = 0;
+    for (Monitor *monitor = first_monitor; monitor != NULL;
+            monitor = monitor->next) {
+        count++;
+    }
+    write_32(writer, count);
+    for (Monitor *monitor = first_monitor; monitor != NULL;
+            monitor = monitor->next) {
+        count = strlen(monitor->name);
+        write_32(writer, count);
+        write_bytes(writer, monitor->name, count);
+        write_frame(writer, monitor->frame);
+    }
+
+    /* write the stash */
+    count = 0;
+    for (Frame *frame = get_last_stashed_frame(); frame != NULL;
+            frame = frame->previous_stashed) {
+        count++;
+    }
+    write_32(writer, count);
+    for (Frame *frame = get_last_stashed_frame(); frame != NULL;
+            frame = frame->previous_stashed) {
+        write_frame(writer, frame);
+    }
+
+    /* write the focus */
+    write_32(writer, focus_window == NULL ? XCB_NONE : focus_window->client.id);
+    write_32(writer, focus_frame->x + focus_frame->width / 2);
+    write_32(writer, focus_frame->y + focus_frame->height / 2);
+}
+
+/* Write the complete state of all screens into @writer. */
+static void write_snapshot(struct snapshot_writer *writer)
+{
+    const uint32_t current_index = get_current_screen_index();
+
+    write_32(writer, SNAPSHOT_MAGIC);
+    write_32(writer, SNAPSHOT_VERSION);
+
+    write_32(writer, number_of_managed_screens);
+    for (uint32_t i = 0; i < number_of_managed_screens; i++) {
+        switch_screen(i);
+        write_screen(writer);
+    }
+    switch_screen(current_index);
+}
+
+/* Write a snapshot of the current state and replace the process with a new
+ * fensterchef process.
+ */
+int restart_fensterchef(void)
+{
+    struct snapshot_writer writer;
+    int fd;
+    ssize_t written;
+    char fd_string[16];
+
+    if (restart_arguments == NULL) {
+        LOG_ERROR("can not restart without the program arguments\n");
+        return ERROR;
+    }
+
+    memset(&writer, 0, sizeof(writer));
+    write_snapshot(&writer);
+
+    /* the file descriptor is inherited by the new process, so no close on
+     * exec flag
+     */
+    fd = memfd_create("fensterchef-snapshot", 0);
+    if (fd < 0) {
+        LOG_ERROR("could not create the snapshot file: %s\n", strerror(errno));
+        free(writer.data);
+        return ERROR;
+    }
+
+    for (size_t position = 0; position < writer.length;
+            position += written) {
+        written = write(fd, &writer.data[position], writer.length - position);
+        if (written < 0) {
+            if (errno == EINTR) {
+                written = 0;
+                continue;
+            }
+            LOG_ERROR("could not write the snapshot: %s\n", strerror(errno));
+            close(fd);
+            free(writer.data);
+            return ERROR;
+        }
+    }
+
+    snprintf(fd_string, sizeof(fd_string), "%d", fd);
+    setenv(FENSTERCHEF_SNAPSHOT_VARIABLE, fd_string, true);
+
+    LOG("restarting with a snapshot of %zu bytes\n", writer.length);
+
+    free(writer.data);
+
+    /* make sure the new process can take control right away */
+    xcb_disconnect(connection);
+
+    execvp(restart_arguments[0], restart_arguments);
+
+    /* there is no way back as the connection is already closed */
+    LOG_ERROR("could not execute %s: %s\n", restart_arguments[0],
+            strerror(errno));
+    exit(EXIT_FAILURE);
+}
+
+/* Read @size bytes from the snapshot into @data. */
+static int read_bytes(struct snapshot_reader *reader, void *data, size_t size)
+{
+    if (reader->length - reader->position < size) {
+        return ERROR;
+    }
+    memcpy(data, &reader->data[reader->position], size);
+    reader->position += size;
+    return OK;
+}
+
+/* Read a single byte from the snapshot. */
+static int read_8(struct snapshot_reader *reader, uint8_t *value)
+{
+    return read_bytes(reader, value, sizeof(*value));
+}
+
+/* Read a 32 bit value from the snapshot. */
+static int read_32(struct snapshot_reader *reader, uint32_t *value)
+{
+    return read_bytes(reader, value, sizeof(*value));
+}
+
+/* Read a frame and all its children from the snapshot.
+ *
+ * When applying, the frame is allocated and stored in @frame. The windows
+ * within are marked as visible if @is_visible is true.
+ */
+static int read_frame(struct snapshot_reader *reader, uint32_t depth,
+        bool is_visible, Frame **frame)
+{
+    uint8_t kind, direction;
+    uint32_t ratio;
+    uint32_t id;
+    Window *window;
+    Frame *left = NULL, *right = NULL;
+
+    if (depth > SNAPSHOT_MAXIMUM_DEPTH || read_8(reader, &kind) != OK) {
+        return ERROR;
+    }
+
+    switch (kind) {
+    /* a frame with a window or an empty frame */
+    case SNAPSHOT_FRAME_LEAF:
+        if (read_32(reader, &id) != OK) {
+            return ERROR;
+        }
+
+        if (!reader->is_applying) {
+            break;
+        }
+
+        *frame = xcalloc(1, sizeof(**frame));
+        tag_memory(*frame, MEMORY_TAG_FRAMES);
+        window = id == XCB_NONE ? NULL : get_window_of_xcb_window(id);
+        /* only take tiling windows that are not already in a frame */
+        if (window != NULL && window->state.mode == WINDOW_MODE_TILING &&
+                !window->state.is_visible) {
+            (*frame)->window = window;
+            window->state.is_visible = is_visible;
+        }
+        break;
+
+    /* a frame with two children */
+    case SNAPSHOT_FRAME_PARENT:
+        if (read_8(reader, &direction) != OK ||
+                (direction != FRAME_SPLIT_HORIZONTALLY &&
+                    direction != FRAME_SPLIT_VERTICALLY) ||
+                read_32(reader, &ratio) != OK || ratio > FRAME_RATIO_ONE) {
+            return ERROR;
+        }
+
+        /* a broken snapshot never gets applied, so no cleanup is needed when
+         * applying
+         */
+        if (read_frame(reader, depth + 1, is_visible, &left) != OK ||
+                read_frame(reader, depth + 1, is_visible, &right) != OK) {
+            return ERROR;
+        }
+
+        if (!reader->is_applying) {
+            break;
+        }
+
+        *frame = xcalloc(1, sizeof(**frame));
+        tag_memory(*frame, MEMORY_TAG_FRAMES);
+        (*frame)->split_direction = direction;
+        (*frame)->ratio = ratio;
+        (*frame)->left = left;
+        (*frame)->right = right;
+        left->parent = *frame;
+        right->parent = *frame;
+        break;
+
+    /* invalid frame */
+    default:
+        return ERROR;
+    }
+    return OK;
+}
+
+/* Read all windows from the snapshot and create them. */
+static int read_windows(struct snapshot_reader *reader)
+{
+    uint32_t count;
+    uint32_t id, number;
+    uint8_t mode, is_visible;
+    Rectangle floating;
+    Window *window;
+
+    if (read_32(reader, &count) != OK) {
+        return ERROR;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        if (read_32(reader, &id) != OK ||
+                read_32(reader, &number) != OK ||
+                read_8(reader, &mode) != OK ||
+                read_8(reader, &is_visible) != OK ||
+                read_32(reader, (uint32_t*) &floating.x) != OK ||
+                read_32(reader, (uint32_t*) &floating.y) != OK ||
+                read_32(reader, &floating.width) != OK ||
+                read_32(reader, &floating.height) != OK) {
+            return ERROR;
+        }
+
+        if (mode >= WINDOW_MODE_MAX) {
+            return ERROR;
+        }
+
+        if (!reader->is_applying) {
+            continue;
+        }
+
+        /* the window might have been destroyed in the meantime */
+        window = create_window(id);
+        if (window == NULL) {
+            continue;
+        }
+
+        set_window_number(window, number);
+        set_window_mode(window, mode);
+        window->properties->floating = floating;
+        /* tiling windows are shown when their frame is restored */
+        if (is_visible && mode != WINDOW_MODE_TILING) {
+            show_window(window);
+        }
+    }
+    return OK;
+}
+
+/* Read the frame trees of all monitors from the snapshot. */
+static int read_monitors(struct snapshot_reader *reader)
+{
+    uint32_t count;
+    uint32_t name_length;
+    const char *name;
+    Monitor *monitor;
+    Frame *frame;
+
+    if (read_32(reader, &count) != OK) {
+        return ERROR;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        if (read_32(reader, &name_length) != OK ||
+                reader->length - reader->position < name_length) {
+            return ERROR;
+        }
+        name = (const char*) &reader->data[reader->position];
+        reader->position += name_length;
+
+        monitor = NULL;
+        if (reader->is_applying) {
+            for (monitor = first_monitor; monitor != NULL;
+                    monitor = monitor->next) {
+                if (strncmp(monitor->name, name, name_length) == 0 &&
+                        monitor->name[name_length] == '\0') {
+                    break;
+                }
+            }
+            /* only use an untouched monitor */
+            if (monitor != NULL && (monitor->frame->left != NULL ||
+                        monitor->frame->window != NULL)) {
+                monitor = NULL;
+            }
+        }
+
+        if (read_frame(reader, 0, monitor != NULL, &frame) != OK) {
+            return ERROR;
+        }
+
+        if (!reader->is_applying) {
+            continue;
+        }
+
+        /* put the frames of monitors that are gone into the stash */
+        if (monitor == NULL) {
+            link_frame_into_stash(frame);
+        } else {
+            replace_frame(monitor->frame, frame);
+            free(frame);
+        }
+    }
+    return OK;
+}
+
+/* Read the stashed frames from the snapshot. */
+static int read_stash(struct snapshot_reader *reader)
+{
+    uint32_t count;
+    Frame **frames = NULL;
+
+    if (read_32(reader, &count) != OK) {
+        return ERROR;
+    }
+
+    if (reader->is_applying) {
+        frames = xreallocarray(NULL, count, sizeof(*frames));
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        if (read_frame(reader, 0, false, frames == NULL ? NULL : &frames[i]) !=
+                OK) {
+            return ERROR;
+        }
+    }
+
+    /* link them starting from the oldest frame */
+    if (reader->is_applying) {
+        for (uint32_t i = count; i > 0; i--) {
+            link_frame_into_stash(frames[i - 1]);
+        }
+        free(frames);
+    }
+    return OK;
+}
+
+/* Read the focus from the snapshot. */
+static int read_focus(struct snapshot_reader *reader)
+{
+    uint32_t id;
+    Point center;
+    Frame *frame;
+    Window *window;
+
+    if (read_32(reader, &id) != OK ||
+            read_32(reader, (uint32_t*) &center.x) != OK ||
+            read_32(reader, (uint32_t*) &center.y) != OK) {
+        return ERROR;
+    }
+
+    if (!reader->is_applying) {
+        return OK;
+    }
+
+    frame = get_frame_at_position(center.x, center.y);
+    if (frame != NULL) {
+        focus_frame = frame;
+    }
+
+    window = get_window_of_xcb_window(id);
+    if (window != NULL && window->state.is_visible) {
+        set_focus_window(window);
+    }
+    return OK;
+}
+
+/* Read the state of a screen from the snapshot and apply it to the managed
+ * screen with the same number.
+ */
+static int read_screen(struct snapshot_reader *reader)
+{
+    const bool is_applying = reader->is_applying;
+    uint32_t number;
+    uint32_t index;
+    int result;
+
+    if (read_32(reader, &number) != OK) {
+        return ERROR;
+    }
+
+    if (is_applying) {
+        for (index = 0; index < number_of_managed_screens; index++) {
+            if (managed_screens[index].number == (int) number) {
+                break;
+            }
+        }
+
+        /* skip the screens that are no longer managed */
+        if (index == number_of_managed_screens) {
+            LOG("screen %" PRIu32 " is no longer managed\n", number);
+            reader->is_applying = false;
+        } else {
+            switch_screen(index);
+        }
+    }
+
+    if (read_windows(reader) != OK ||
+            read_monitors(reader) != OK ||
+            read_stash(reader) != OK ||
+            read_focus(reader) != OK) {
+        result = ERROR;
+    } else {
+        result = OK;
+    }
+
+    reader->is_applying = is_applying;
+    return result;
+}
+
+/* Read or check the entire snapshot. */
+static int read_snapshot(struct snapshot_reader *reader)
+{
+    uint32_t magic, version;
+    uint32_t count;
+
+    reader->position = 0;
+    if (read_32(reader, &magic) != OK || magic != SNAPSHOT_MAGIC ||
+            read_32(reader, &version) != OK || version != SNAPSHOT_VERSION ||
+            read_32(reader, &count) != OK) {
+        return ERROR;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        if (read_screen(reader) != OK) {
+            return ERROR;
+        }
+    }
+
+    /* there should be nothing left */
+    return reader->position == reader->length ? OK : ERROR;
+}
+
+/* Restore the state from the snapshot passed by the previous process. */
+int restore_from_snapshot(void)
+{
+    const char *fd_string;
+    int fd;
+    struct stat status;
+    uint8_t *data;
+    ssize_t count;
+    struct snapshot_reader reader;
+    const uint32_t current_index = get_current_screen_index();
+
+    fd_string = getenv(FENSTERCHEF_SNAPSHOT_VARIABLE);
+    if (fd_string == NULL) {
+        return ERROR;
+    }
+    fd = atoi(fd_string);
+    /* make sure processes started by us do not see the variable */
+    unsetenv(FENSTERCHEF_SNAPSHOT_VARIABLE);
+
+    if (fstat(fd, &status) != 0) {
+        LOG_ERROR("could not access the snapshot: %s\n", strerror(errno));
+        close(fd);
+        return ERROR;
+    }
+
+    data = xmalloc(status.st_size);
+    for (off_t position = 0; position < status.st_size; position += count) {
+        count = pread(fd, &data[position], status.st_size - position,
+                position);
+        if (count <= 0) {
+            if (count < 0 && errno == EINTR) {
+                count = 0;
+                continue;
+            }
+            LOG_ERROR("could not read the snapshot: %s\n", strerror(errno));
+            close(fd);
+            free(data);
+            return ERROR;
+        }
+    }
+    close(fd);
+
+    reader.data = data;
+    reader.length = status.st_size;
+
+    /* check the snapshot first so that a broken one changes nothing */
+    reader.is_applying = false;
+    if (read_snapshot(&reader) != OK) {
+        LOG_ERROR("the snapshot is invalid, ignoring it\n");
+        free(data);
+        return ERROR;
+    }
+
+    reader.is_applying = true;
+    (void) read_snapshot(&reader);
+    switch_screen(current_index);
+
+    LOG("restored %zu bytes of snapshot\n", reader.length);
+
+    free(data);
+    return OK;
+}
@@ -0,0 +1,171 @@
+#include <string.h>
+
+#include "event.h"
+#include "frame.h"
+#include "log.h"
+#include "screen.h"
+#include "stash_frame.h"
+#include "window.h"
+#include "xalloc.h"
+
+/* the managed screens, the first is the screen named by `DISPLAY` */
+struct managed_screen *managed_screens;
+
+/* the number of managed screens */
+uint32_t number_of_managed_screens;
+
+/* the screen whose state is in the globals */
+struct managed_screen *current_screen;
+
+/* the number of allocated managed screens */
+static uint32_t managed_screens_capacity;
+
+/* Add @xcb_screen with the screen number @number to the managed screens. */
+void add_managed_screen(xcb_screen_t *xcb_screen, int number)
+{
+    struct managed_screen *managed_screen;
+
+    /* screens are only added before any state exists, so the current screen
+     * is simply pointed at the first screen again
+     */
+    if (number_of_managed_screens == managed_screens_capacity) {
+        managed_screens_capacity += 4;
+        RESIZE(managed_screens, managed_screens_capacity);
+    }
+
+    managed_screen = &managed_screens[number_of_managed_screens++];
+    memset(managed_screen, 0, sizeof(*managed_screen));
+    managed_screen->screen = xcb_screen;
+    managed_screen->number = number;
+
+    LOG("managing screen %d: %C\n", number, xcb_screen);
+
+    current_screen = &managed_screens[0];
+    screen = current_screen->screen;
+}
+
+/* Stop managing the screen at @index. */
+void remove_managed_screen(uint32_t index)
+{
+    const uint32_t current_index = get_current_screen_index();
+
+    LOG("no longer managing screen %d\n", managed_screens[index].number);
+
+    number_of_managed_screens--;
+    memmove(&managed_screens[index], &managed_screens[index + 1],
+            sizeof(*managed_screens) * (number_of_managed_screens - index));
+    if (index < current_index) {
+        current_screen--;
+    }
+}
+
+/* Store the globals into the current screen and load the ones of the screen at
+ * @index.
+ */
+void switch_screen(uint32_t index)
+{
+    struct managed_screen *const next = &managed_screens[index];
+
+    if (next == current_screen) {
+        return;
+    }
+
+    current_screen->wm_check_window = wm_check_window;
+    current_screen->notification = notification;
+    current_screen->window_list = window_list;
+    memcpy(current_screen->stock_objects, stock_objects,
+            sizeof(stock_objects));
+    current_screen->window_picture_cache_head = window_picture_cache_head;
+    current_screen->first_monitor = first_monitor;
+    current_screen->focus_frame = focus_frame;
+    current_screen->last_stashed_frame = last_stashed_frame;
+    current_screen->oldest_window = oldest_window;
+    current_screen->bottom_window = bottom_window;
+    current_screen->top_window = top_window;
+    current_screen->first_window = first_window;
+    current_screen->focus_window = focus_window;
+    current_screen->has_client_list_changed = has_client_list_changed;
+
+    screen = next->screen;
+    wm_check_window = next->wm_check_window;
+    notification = next->notification;
+    window_list = next->window_list;
+    memcpy(stock_objects, next->stock_objects, sizeof(stock_objects));
+    window_picture_cache_head = next->window_picture_cache_head;
+    first_monitor = next->first_monitor;
+    focus_frame = next->focus_frame;
+    last_stashed_frame = next->last_stashed_frame;
+    oldest_window = next->oldest_window;
+    bottom_window = next->bottom_window;
+    top_window = next->top_window;
+    first_window = next->first_window;
+    focus_window = next->focus_window;
+    has_client_list_changed = next->has_client_list_changed;
+
+    current_screen = next;
+}
+
+/* Get the index of the current screen. */
+uint32_t get_current_screen_index(void)
+{
+    return current_screen - managed_screens;
+}
+
+/* Switch to the screen with the root window @root. */
+bool switch_to_root(xcb_window_t root)
+{
+    for (uint32_t i = 0; i < number_of_managed_screens; i++) {
+        if (managed_screens[i].screen->root == root) {
+            switch_screen(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Check if @managed_screen knows @xcb_window, the managed screen must not be
+ * the current screen.
+ */
+static bool has_window(const struct managed_screen *managed_screen,
+        xcb_window_t xcb_window)
+{
+    if (managed_screen->screen->root == xcb_window ||
+            managed_screen->wm_check_window == xcb_window ||
+            managed_screen->notification.id == xcb_window ||
+            managed_screen->window_list.client.id == xcb_window) {
+        return true;
+    }
+
+    for (Window *window = managed_screen->first_window; window != NULL;
+            window = window->next) {
+        if (window->client.id == xcb_window) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Switch to the screen @xcb_window is on. */
+bool switch_to_window_screen(xcb_window_t xcb_window)
+{
+    if (xcb_window == XCB_NONE) {
+        return false;
+    }
+
+    /* most events are about the current screen */
+    if (screen->root == xcb_window || wm_check_window == xcb_window ||
+            notification.id == xcb_window ||
+            window_list.client.id == xcb_window ||
+            get_window_of_xcb_window(xcb_window) != NULL) {
+        return true;
+    }
+
+    for (uint32_t i = 0; i < number_of_managed_screens; i++) {
+        if (&managed_screens[i] != current_screen &&
+                has_window(&managed_screens[i], xcb_window)) {
+            switch_screen(i);
+            return true;
+        }
+    }
+    return false;
+}
@@ -2,7 +2,7 @@
 #include "window.h"
 
 /* the last frame in the frame stashed linked list */
-static Frame *last_stashed_frame;
+Frame *last_stashed_frame;
 
 /* Hide all windows in @frame and child frames. */
 static void hide_inner_windows(Frame *frame)
@@ -25,8 +25,10 @@ Frame *stash_frame_later(Frame *frame)
 
     /* reparent the child frames */
     Frame *const stash = xcalloc(1, sizeof(*stash));
+    tag_memory(stash, MEMORY_TAG_STASH);
     if (frame->left != NULL) {
         stash->split_direction = frame->split_direction;
+        stash->ratio = frame->ratio;
         stash->left = frame->left;
         stash->right = frame->right;
         stash->left->parent = stash;
@@ -34,6 +36,7 @@ Frame *stash_frame_later(Frame *frame)
 
         frame->left = NULL;
         frame->right = NULL;
+        invalidate_frame_minimum_size(frame);
     } else {
         stash->window = frame->window;
 
@@ -52,6 +55,12 @@ void link_frame_into_stash(Frame *frame)
     last_stashed_frame = frame;
 }
 
+/* Get the frame that was stashed last. */
+Frame *get_last_stashed_frame(void)
+{
+    return last_stashed_frame;
+}
+
 /* Take @frame away from the screen, this leaves a singular empty frame. */
 Frame *stash_frame(Frame *frame)
 {
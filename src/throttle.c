@@ -0,0 +1,47 @@
+#include "throttle.h"
+#include "utility.h"
+
+/* Take a token for an event that happened at @now. */
+bool take_throttle_token(struct throttle *throttle, uint64_t now)
+{
+    uint64_t new_tokens;
+
+    /* start with a full bucket */
+    if (throttle->refill_time == 0) {
+        throttle->tokens = THROTTLE_BURST;
+        throttle->refill_time = now;
+    }
+
+    new_tokens = (now - throttle->refill_time) * THROTTLE_RATE / 1000;
+    if (new_tokens > 0) {
+        throttle->tokens = MIN(throttle->tokens + new_tokens,
+                (uint64_t) THROTTLE_BURST);
+        /* only advance by whole tokens so no fraction is lost */
+        throttle->refill_time += new_tokens * 1000 / THROTTLE_RATE;
+    }
+
+    /* all events are merged until the interval is over */
+    if (throttle->release_time != 0) {
+        throttle->deferred_events++;
+        return false;
+    }
+
+    if (throttle->tokens == 0) {
+        throttle->release_time = now + THROTTLE_INTERVAL;
+        throttle->deferred_events++;
+        return false;
+    }
+
+    throttle->tokens--;
+    return true;
+}
+
+/* End the throttling if the interval is over at @now. */
+bool release_throttle(struct throttle *throttle, uint64_t now)
+{
+    if (throttle->release_time == 0 || now < throttle->release_time) {
+        return false;
+    }
+    throttle->release_time = 0;
+    return true;
+}
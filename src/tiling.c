@@ -15,10 +15,13 @@ void split_frame(Frame *split_from, frame_split_direction_t direction)
 
     left = xcalloc(1, sizeof(*left));
     right = xcalloc(1, sizeof(*right));
+    tag_memory(left, MEMORY_TAG_FRAMES);
+    tag_memory(right, MEMORY_TAG_FRAMES);
 
     /* let `left` take the children or window */
     if (split_from->left != NULL) {
         left->split_direction = split_from->split_direction;
+        left->ratio = split_from->ratio;
         left->left = split_from->left;
         left->right = split_from->right;
         left->left->parent = left;
@@ -29,10 +32,12 @@ void split_frame(Frame *split_from, frame_split_direction_t direction)
     }
 
     split_from->split_direction = direction;
+    split_from->ratio = FRAME_RATIO_HALF;
     split_from->left = left;
     split_from->right = right;
     left->parent = split_from;
     right->parent = split_from;
+    invalidate_frame_minimum_size(split_from);
 
     if (split_from == focus_frame) {
         next_focus_frame = left;
@@ -123,9 +128,17 @@ Frame *get_below_frame(Frame *frame)
     return get_right_or_below_frame(frame, FRAME_SPLIT_HORIZONTALLY);
 }
 
-/* Get the minimum size the given frame should have. */
+/* Get the minimum size the given frame should have.
+ *
+ * The size is cached within the frame, only outdated sub frames are visited.
+ */
 static void get_minimum_frame_size(Frame *frame, Size *size)
 {
+    if (frame->is_minimum_size_valid) {
+        *size = frame->minimum_size;
+        return;
+    }
+
     if (frame->left != NULL) {
         Size left_size, right_size;
 
@@ -142,6 +155,26 @@ static void get_minimum_frame_size(Frame *frame, Size *size)
         size->width = FRAME_MINIMUM_SIZE;
         size->height = FRAME_MINIMUM_SIZE;
     }
+
+    frame->minimum_size = *size;
+    frame->is_minimum_size_valid = true;
+}
+
+/* Set the ratio of @frame such that the left child gets @left_size of @size
+ * and resize the frame.
+ */
+static void set_frame_ratio(Frame *frame, uint32_t left_size, uint32_t size)
+{
+    if (size == 0) {
+        frame->ratio = FRAME_RATIO_HALF;
+    } else {
+        /* round up so that the size derived from the ratio is exactly
+         * @left_size
+         */
+        frame->ratio = ((uint64_t) left_size * FRAME_RATIO_ONE + size - 1) /
+            size;
+    }
+    resize_frame(frame, frame->x, frame->y, frame->width, frame->height);
 }
 
 /* Increase the @edge of @frame by @amount. */
@@ -196,10 +229,9 @@ int32_t bump_frame_edge(Frame *frame, frame_edge_t edge, int32_t amount)
             }
             amount = MIN(amount, space);
         }
-        resize_frame(frame, frame->x, frame->y, frame->width + amount,
-                frame->height);
-        resize_frame(right, right->x + amount, right->y, right->width - amount,
-                right->height);
+        /* `frame` and `right` are siblings, adjust their parent's ratio */
+        set_frame_ratio(frame->parent, frame->width + amount,
+                frame->parent->width);
         break;
 
     /* move the frame's bottom edge */
@@ -224,10 +256,8 @@ int32_t bump_frame_edge(Frame *frame, frame_edge_t edge, int32_t amount)
             }
             amount = MIN(amount, space);
         }
-        resize_frame(frame, frame->x, frame->y, frame->width,
-                frame->height + amount);
-        resize_frame(right, right->x, right->y + amount, right->width,
-                right->height - amount);
+        set_frame_ratio(frame->parent, frame->height + amount,
+                frame->parent->height);
         break;
     }
     return amount;
@@ -255,11 +285,13 @@ int remove_void(Frame *frame)
     parent->right = other->right;
     if (other->left != NULL) {
         parent->split_direction = other->split_direction;
+        parent->ratio = other->ratio;
         parent->left->parent = parent;
         parent->right->parent = parent;
     } else {
         parent->window = other->window;
     }
+    invalidate_frame_minimum_size(parent);
 
     free(other);
 
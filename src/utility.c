@@ -1,5 +1,29 @@
+/* needed for `clock_gettime()` */
+#define _POSIX_C_SOURCE 199309L
+
 #include <ctype.h>
 #include <string.h>
+#include <time.h>
+
+#include "utility.h"
+
+/* Get the current monotonic time in milliseconds. */
+uint64_t get_monotonic_milliseconds(void)
+{
+    struct timespec now;
+
+    (void) clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+/* Get the current monotonic time in nanoseconds. */
+uint64_t get_monotonic_nanoseconds(void)
+{
+    struct timespec now;
+
+    (void) clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000 + now.tv_nsec;
+}
 
 /* Get the length of @string up to a maximum of @max_length. */
 size_t strnlen(const char *string, size_t max_length)
@@ -6,6 +6,7 @@
 #include "frame.h"
 #include "log.h"
 #include "monitor.h"
+#include "placement.h"
 #include "window.h"
 #include "xalloc.h"
 
@@ -24,6 +25,26 @@ Window *first_window;
 /* the currently focused window */
 Window *focus_window;
 
+/* if Z stack changes are collected instead of being sent */
+static bool is_restacking_deferred;
+
+/* Get the events selected on the windows fensterchef manages. */
+uint32_t get_window_event_mask(void)
+{
+    /* we want to know if if any properties change */
+    uint32_t event_mask = XCB_EVENT_MASK_PROPERTY_CHANGE;
+
+    /* the crossings are only needed for focus follows mouse, selecting them
+     * otherwise makes the server send them for every window the mouse moves
+     * over
+     */
+    if (configuration.mouse.focus_follows_mouse) {
+        event_mask |= XCB_EVENT_MASK_ENTER_WINDOW |
+            XCB_EVENT_MASK_LEAVE_WINDOW;
+    }
+    return event_mask;
+}
+
 /* Create a window struct and add it to the window list. */
 Window *create_window(xcb_window_t xcb_window)
 {
@@ -71,12 +92,14 @@ Window *create_window(xcb_window_t xcb_window)
 
     /* set the border color */
     general_values[0] = configuration.border.color;
-    /* we want to know if if any properties change */
-    general_values[1] = XCB_EVENT_MASK_PROPERTY_CHANGE;
+    general_values[1] = get_window_event_mask();
     xcb_change_window_attributes(connection, xcb_window,
             XCB_CW_BORDER_PIXEL | XCB_CW_EVENT_MASK, general_values);
 
     window = xcalloc(1, sizeof(*window));
+    tag_memory(window, MEMORY_TAG_WINDOWS);
+    window->properties = xcalloc(1, sizeof(*window->properties));
+    tag_memory(window->properties, MEMORY_TAG_WINDOWS);
 
     window->client.id = xcb_window;
     window->client.x = geometry->x;
@@ -140,7 +163,9 @@ Window *create_window(xcb_window_t xcb_window)
         previous->newer = window;
     }
 
-    /* initialize the window mode and Z position */
+    /* initialize the window mode and Z position, this also applies the window
+     * rules
+     */
     mode = initialize_window_properties(window);
     set_window_mode(window, mode);
     update_window_layer(window);
@@ -151,6 +176,40 @@ Window *create_window(xcb_window_t xcb_window)
     return window;
 }
 
+/* Change the number of @window and move it within the number linked list. */
+void set_window_number(Window *window, uint32_t number)
+{
+    Window *previous;
+
+    /* remove from the number linked list */
+    if (first_window == window) {
+        first_window = window->next;
+    } else {
+        previous = first_window;
+        while (previous->next != window) {
+            previous = previous->next;
+        }
+        previous->next = window->next;
+    }
+
+    window->number = number;
+
+    /* insert it again, sorted by the number */
+    if (first_window == NULL || first_window->number >= number) {
+        window->next = first_window;
+        first_window = window;
+    } else {
+        previous = first_window;
+        while (previous->next != NULL && previous->next->number < number) {
+            previous = previous->next;
+        }
+        window->next = previous->next;
+        previous->next = window;
+    }
+
+    has_client_list_changed = true;
+}
+
 /* Attempt to close a window. If it is the first time, use a friendly method by
  * sending a close request to the window. Call this function again within
  * `REQUEST_CLOSE_MAX_DURATION` to forcefully kill it.
@@ -235,6 +294,11 @@ void destroy_window(Window *window)
 
     LOG("destroying window %W\n", window);
 
+    /* the window might still be throttled */
+    log_deferred_events(window);
+
+    release_window_free_space(window);
+
     /* remove from the z linked list */
     unlink_window_from_z_list(window);
 
@@ -262,14 +326,17 @@ void destroy_window(Window *window)
 
     has_client_list_changed = true;
 
+    free_window_icon(window);
     free(window->name);
-    free(window->protocols);
-    free(window->states);
+    free(window->properties->protocols);
+    free(window->properties->states);
+    free(window->properties->deferred_properties);
+    free(window->properties);
     free(window);
 }
 
 /* Adjust given @x and @y such that it follows the @window_gravity. */
-void adjust_for_window_gravity(Monitor *monitor, int32_t *x, int32_t *y,
+void adjust_for_window_gravity(const Monitor *monitor, int32_t *x, int32_t *y,
         uint32_t width, uint32_t height, uint32_t window_gravity)
 {
     switch (window_gravity) {
@@ -320,7 +387,7 @@ void adjust_for_window_gravity(Monitor *monitor, int32_t *x, int32_t *y,
     /* attach to the bottom right */
     case XCB_GRAVITY_SOUTH_EAST:
         *x = monitor->x + monitor->width - width;
-        *y = monitor->y + monitor->width - height;
+        *y = monitor->y + monitor->height - height;
         break;
 
     /* nothing to do */
@@ -332,12 +399,13 @@ void adjust_for_window_gravity(Monitor *monitor, int32_t *x, int32_t *y,
 /* Get the minimum size the window can have. */
 void get_minimum_window_size(const Window *window, Size *size)
 {
+    const xcb_size_hints_t *const size_hints = &window->properties->size_hints;
     uint32_t width = 0, height = 0;
 
     if (window->state.mode != WINDOW_MODE_TILING) {
-        if ((window->size_hints.flags & XCB_ICCCM_SIZE_HINT_P_MIN_SIZE)) {
-            width = window->size_hints.min_width;
-            height = window->size_hints.min_height;
+        if ((size_hints->flags & XCB_ICCCM_SIZE_HINT_P_MIN_SIZE)) {
+            width = size_hints->min_width;
+            height = size_hints->min_height;
         }
     }
     size->width = MAX(width, WINDOW_MINIMUM_SIZE);
@@ -347,16 +415,195 @@ void get_minimum_window_size(const Window *window, Size *size)
 /* Get the maximum size the window can have. */
 void get_maximum_window_size(const Window *window, Size *size)
 {
+    const xcb_size_hints_t *const size_hints = &window->properties->size_hints;
     uint32_t width = UINT32_MAX, height = UINT32_MAX;
 
-    if ((window->size_hints.flags & XCB_ICCCM_SIZE_HINT_P_MAX_SIZE)) {
-        width = window->size_hints.max_width;
-        height = window->size_hints.max_height;
+    if ((size_hints->flags & XCB_ICCCM_SIZE_HINT_P_MAX_SIZE)) {
+        width = size_hints->max_width;
+        height = size_hints->max_height;
     }
     size->width = MIN(width, WINDOW_MAXIMUM_SIZE);
     size->height = MIN(height, WINDOW_MAXIMUM_SIZE);
 }
 
+/* Clip the size of @geometry using the minimum and maximum size of @window. */
+static void clip_window_geometry(const Window *window, Rectangle *geometry)
+{
+    Size minimum, maximum;
+
+    get_minimum_window_size(window, &minimum);
+    get_maximum_window_size(window, &maximum);
+
+    /* make sure the window does not become too large or too small */
+    geometry->width = MIN(geometry->width, maximum.width);
+    geometry->height = MIN(geometry->height, maximum.height);
+    geometry->width = MAX(geometry->width, minimum.width);
+    geometry->height = MAX(geometry->height, minimum.height);
+}
+
+/* Check if the center of @rectangle is within @monitor. */
+static bool is_rectangle_centered_in_monitor(const Rectangle *rectangle,
+        const Monitor *monitor)
+{
+    const int32_t x = rectangle->x + rectangle->width / 2;
+    const int32_t y = rectangle->y + rectangle->height / 2;
+
+    return x >= monitor->x && y >= monitor->y &&
+        x - (int32_t) monitor->width < monitor->x &&
+        y - (int32_t) monitor->height < monitor->y;
+}
+
+/* Get the position and size @window should have as floating window. */
+static void get_floating_geometry(const Window *window, const Monitor *monitor,
+        Rectangle *geometry)
+{
+    const struct window_properties *const properties = window->properties;
+
+    /* if the window never had a floating size, use the size hints to get a size
+     * that the window prefers
+     */
+    if (properties->floating.width == 0) {
+        if ((properties->size_hints.flags & XCB_ICCCM_SIZE_HINT_P_SIZE)) {
+            geometry->width = properties->size_hints.width;
+            geometry->height = properties->size_hints.height;
+        } else {
+            geometry->width = monitor->width * 2 / 3;
+            geometry->height = monitor->height * 2 / 3;
+        }
+
+        /* clip already so that the window is centered with its final size */
+        clip_window_geometry(window, geometry);
+
+        /* center the window */
+        geometry->x = monitor->x + (monitor->width - geometry->width) / 2;
+        geometry->y = monitor->y + (monitor->height - geometry->height) / 2;
+    } else {
+        *geometry = properties->floating;
+        /* if the window would still be in the monitor is was moved to,
+         * restore the position, otherwise center the window
+         */
+        if (!is_rectangle_centered_in_monitor(geometry, monitor)) {
+            geometry->x = monitor->x + (monitor->width - geometry->width) / 2;
+            geometry->y = monitor->y +
+                (monitor->height - geometry->height) / 2;
+        }
+    }
+}
+
+/* Get the position and size @window should have as fullscreen window. */
+static void get_fullscreen_geometry(const Window *window,
+        const Monitor *monitor, Rectangle *geometry)
+{
+    const Extents *const monitors = &window->properties->fullscreen_monitors;
+
+    if (monitors->top != monitors->bottom) {
+        geometry->x = monitors->left;
+        geometry->y = monitors->top;
+        geometry->width = monitors->right - monitors->left;
+        geometry->height = monitors->bottom - monitors->top;
+    } else {
+        geometry->x = monitor->x;
+        geometry->y = monitor->y;
+        geometry->width = monitor->width;
+        geometry->height = monitor->height;
+    }
+}
+
+/* Get the position and size @window should have as dock window. */
+static void get_dock_geometry(const Window *window, const Monitor *monitor,
+        Rectangle *geometry)
+{
+    const uint32_t both_hints = XCB_ICCCM_SIZE_HINT_P_POSITION |
+        XCB_ICCCM_SIZE_HINT_P_SIZE;
+    const xcb_size_hints_t *const size_hints = &window->properties->size_hints;
+    const wm_strut_partial_t *const strut = &window->properties->strut;
+
+    /* check if the window has both position and size defined */
+    if ((size_hints->flags & both_hints) == both_hints) {
+        geometry->x = size_hints->x;
+        geometry->y = size_hints->y;
+        geometry->width = size_hints->width;
+        geometry->height = size_hints->height;
+    /* if the window does not specify a size itself, then do it based on the
+     * strut the window defines, reasoning is that when the window wants to
+     * occupy screen space, then it should be within that occupied space
+     */
+    } else if (strut->reserved.left != 0) {
+        geometry->x = monitor->x;
+        geometry->y = strut->left_start_y;
+        geometry->width = strut->reserved.left;
+        geometry->height = strut->left_end_y - strut->left_start_y + 1;
+    } else if (strut->reserved.top != 0) {
+        geometry->x = strut->top_start_x;
+        geometry->y = monitor->y;
+        geometry->width = strut->top_end_x - strut->top_start_x + 1;
+        geometry->height = strut->reserved.top;
+    } else if (strut->reserved.right != 0) {
+        geometry->x = monitor->x + monitor->width -
+            strut->reserved.right;
+        geometry->y = strut->right_start_y;
+        geometry->width = strut->reserved.right;
+        geometry->height = strut->right_end_y - strut->right_start_y + 1;
+    } else if (strut->reserved.bottom != 0) {
+        geometry->x = strut->bottom_start_x;
+        geometry->y = monitor->y + monitor->height -
+            strut->reserved.bottom;
+        geometry->width = strut->bottom_end_x - strut->bottom_start_x + 1;
+        geometry->height = strut->reserved.bottom;
+    } else {
+        geometry->x = window->x;
+        geometry->y = window->y;
+        geometry->width = window->width;
+        geometry->height = window->height;
+    }
+}
+
+/* Compute the position and size @window should have in its current mode. */
+void compute_window_geometry(const Window *window, const Monitor *monitor,
+        Rectangle *geometry)
+{
+    switch (window->state.mode) {
+    /* tiling windows get their geometry from their frame */
+    case WINDOW_MODE_TILING:
+        geometry->x = window->x;
+        geometry->y = window->y;
+        geometry->width = window->width;
+        geometry->height = window->height;
+        break;
+
+    /* use the previous floating geometry or the preferred size */
+    case WINDOW_MODE_FLOATING:
+        get_floating_geometry(window, monitor, geometry);
+        break;
+
+    /* cover the monitor or the requested fullscreen monitors */
+    case WINDOW_MODE_FULLSCREEN:
+        get_fullscreen_geometry(window, monitor, geometry);
+        /* the fullscreen size is not affected by gravity or size hints */
+        return;
+
+    /* use the requested geometry or the strut */
+    case WINDOW_MODE_DOCK:
+        get_dock_geometry(window, monitor, geometry);
+        break;
+
+    /* not a real window mode */
+    case WINDOW_MODE_MAX:
+        return;
+    }
+
+    /* consider the window gravity, i.e. where the window wants to be */
+    if (window->state.mode != WINDOW_MODE_TILING &&
+            (window->properties->size_hints.flags &
+                XCB_ICCCM_SIZE_HINT_P_WIN_GRAVITY)) {
+        adjust_for_window_gravity(monitor, &geometry->x, &geometry->y,
+                geometry->width, geometry->height,
+                window->properties->size_hints.win_gravity);
+    }
+
+    clip_window_geometry(window, geometry);
+}
+
 /* Move the window such that it is in bounds of the screen. */
 void place_window_in_bounds(Window *window)
 {
@@ -375,38 +622,120 @@ void place_window_in_bounds(Window *window)
     /* make the window vertically visible */
     if (window->y + (int32_t) window->height < WINDOW_MINIMUM_VISIBLE_SIZE) {
         window->y = WINDOW_MINIMUM_VISIBLE_SIZE - window->height;
-    } else if (WINDOW_MINIMUM_VISIBLE_SIZE >=
+    } else if (window->y + WINDOW_MINIMUM_VISIBLE_SIZE >=
             (int32_t) screen->height_in_pixels) {
         window->y = screen->height_in_pixels - WINDOW_MINIMUM_VISIBLE_SIZE;
     }
 }
 
+/* Store @geometry as the current geometry of @window. */
+static void store_window_geometry(Window *window, const Rectangle *geometry)
+{
+    if (window->state.mode == WINDOW_MODE_FLOATING) {
+        window->properties->floating = *geometry;
+    }
+
+    window->x = geometry->x;
+    window->y = geometry->y;
+    window->width = geometry->width;
+    window->height = geometry->height;
+}
+
 /* Set the position and size of a window. */
 void set_window_size(Window *window, int32_t x, int32_t y, uint32_t width,
         uint32_t height)
 {
-    Size minimum, maximum;
+    Rectangle geometry;
+
+    geometry.x = x;
+    geometry.y = y;
+    geometry.width = width;
+    geometry.height = height;
+    clip_window_geometry(window, &geometry);
+    store_window_geometry(window, &geometry);
+}
 
-    get_minimum_window_size(window, &minimum);
-    get_maximum_window_size(window, &maximum);
+/* Compute the geometry of @window for its current mode and apply it. */
+void update_window_size(Window *window)
+{
+    Monitor *monitor;
+    Rectangle geometry;
 
-    /* make sure the window does not become too large or too small */
-    width = MIN(width, maximum.width);
-    height = MIN(height, maximum.height);
-    width = MAX(width, minimum.width);
-    height = MAX(height, minimum.height);
+    if (window->state.mode == WINDOW_MODE_FULLSCREEN) {
+        load_window_properties(window, LAZY_PROPERTY_FULLSCREEN_MONITORS);
+    }
 
-    if (window->state.mode == WINDOW_MODE_FLOATING) {
-        window->floating.x = x;
-        window->floating.y = y;
-        window->floating.width = width;
-        window->floating.height = height;
+    monitor = get_monitor_from_rectangle_or_primary(window->x, window->y,
+            window->width, window->height);
+    compute_window_geometry(window, monitor, &geometry);
+
+    /* put new floating windows into free space instead of stacking them all in
+     * the center of the monitor, only do this when the window has no
+     * preference for its position
+     */
+    if (window->state.mode == WINDOW_MODE_FLOATING &&
+            window->properties->floating.width == 0 &&
+            window->transient_for == XCB_NONE &&
+            !(window->properties->size_hints.flags &
+                (XCB_ICCCM_SIZE_HINT_US_POSITION |
+                    XCB_ICCCM_SIZE_HINT_P_POSITION |
+                    XCB_ICCCM_SIZE_HINT_P_WIN_GRAVITY))) {
+        place_in_free_space(window, monitor, &geometry);
+    }
+
+    store_window_geometry(window, &geometry);
+}
+
+/* Send a Z stack change of @window to the server or remember it when
+ * restacking is deferred.
+ */
+static void stack_window(Window *window, xcb_window_t sibling,
+        uint32_t stack_mode)
+{
+    uint32_t value_mask = XCB_CONFIG_WINDOW_STACK_MODE;
+    int value_index = 0;
+
+    if (is_restacking_deferred) {
+        window->is_restack_pending = true;
+        return;
+    }
+
+    if (sibling != XCB_NONE) {
+        general_values[value_index++] = sibling;
+        value_mask |= XCB_CONFIG_WINDOW_SIBLING;
     }
+    general_values[value_index] = stack_mode;
+    last_layout_sequence = xcb_configure_window(connection,
+            window->client.id, value_mask, general_values).sequence;
+}
+
+/* Collect the Z stack changes instead of sending them right away. */
+void defer_window_layers(void)
+{
+    is_restacking_deferred = true;
+}
+
+/* Send the collected Z stack changes. */
+void flush_window_layers(void)
+{
+    is_restacking_deferred = false;
 
-    window->x = x;
-    window->y = y;
-    window->width = width;
-    window->height = height;
+    /* going from bottom to top, every moved window is put directly above the
+     * window below it which gives the same order as the Z linked list
+     */
+    for (Window *window = bottom_window; window != NULL;
+            window = window->above) {
+        if (!window->is_restack_pending) {
+            continue;
+        }
+        window->is_restack_pending = false;
+        if (window->below == NULL) {
+            stack_window(window, XCB_NONE, XCB_STACK_MODE_BELOW);
+        } else {
+            stack_window(window, window->below->client.id,
+                    XCB_STACK_MODE_ABOVE);
+        }
+    }
 }
 
 /* Put the window on the best suited Z stack position. */
@@ -419,9 +748,7 @@ void update_window_layer(Window *window)
 
         LOG("setting window %W below all other windows\n", window);
 
-        general_values[0] = XCB_STACK_MODE_BELOW;
-        xcb_configure_window(connection, window->client.id,
-                XCB_CONFIG_WINDOW_STACK_MODE, general_values);
+        stack_window(window, XCB_NONE, XCB_STACK_MODE_BELOW);
 
         /* link onto the bottom of the Z linked list */
         unlink_window_from_z_list(window);
@@ -435,9 +762,7 @@ void update_window_layer(Window *window)
 
         LOG("setting window %W above all other windows\n", window);
 
-        general_values[0] = XCB_STACK_MODE_ABOVE;
-        xcb_configure_window(connection, window->client.id,
-                XCB_CONFIG_WINDOW_STACK_MODE, general_values);
+        stack_window(window, XCB_NONE, XCB_STACK_MODE_ABOVE);
 
         /* link onto the top of the Z linked list */
         unlink_window_from_z_list(window);
@@ -449,11 +774,7 @@ void update_window_layer(Window *window)
     /* put windows that are transient for this window above it */
     for (Window *below = window->below; below != NULL; ) {
         if (below->transient_for == window->client.id) {
-            general_values[0] = window->client.id;
-            general_values[1] = XCB_STACK_MODE_ABOVE;
-            xcb_configure_window(connection, window->client.id,
-                    XCB_CONFIG_WINDOW_SIBLING | XCB_CONFIG_WINDOW_STACK_MODE,
-                    general_values);
+            stack_window(below, window->client.id, XCB_STACK_MODE_ABOVE);
 
             unlink_window_from_z_list(below);
             if (window->above == NULL) {
@@ -528,12 +849,7 @@ bool does_window_accept_focus(Window *window)
         return false;
     }
 
-    if (supports_protocol(window, ATOM(WM_TAKE_FOCUS))) {
-        return true;
-    }
-
-    return !(window->hints.flags & XCB_ICCCM_WM_HINT_INPUT) ||
-            window->hints.input != 0;
+    return window->accepts_input;
 }
 
 /* Remove any focus indication from @window. */
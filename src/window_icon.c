@@ -0,0 +1,345 @@
+#include <inttypes.h>
+#include <string.h>
+
+#include "configuration.h"
+#include "log.h"
+#include "render.h"
+#include "utility.h"
+#include "window.h"
+#include "window_icon.h"
+
+/* the state of reading `_NET_WM_ICON` in chunks
+ *
+ * The property is a list of icons, each starting with its width and height
+ * followed by the ARGB pixels in rows.
+ */
+struct icon_reader {
+    /* the size the icon is scaled down for */
+    uint32_t size;
+    /* the width and height of the icon currently read */
+    uint32_t header[2];
+    /* how many values of `header` were read */
+    uint32_t header_length;
+    /* the index of the next pixel of the icon currently read */
+    uint32_t pixel_index;
+    /* the number of pixels of the icon currently read that are still to come */
+    uint32_t remaining_pixels;
+    /* if the icon currently read is the one being scaled */
+    bool is_scaling;
+    /* the size of the icon being scaled, 0 if none was found yet */
+    uint32_t source_width;
+    uint32_t source_height;
+    /* the size of the scaled icon */
+    uint32_t width;
+    uint32_t height;
+    /* the sums of the premultiplied alpha, red, green and blue values of all
+     * pixels falling into a scaled pixel
+     */
+    uint32_t (*sums)[4];
+    /* the number of pixels falling into each scaled pixel */
+    uint32_t *counts;
+};
+
+/* the least recently used list of all icons */
+static struct {
+    /* the most recently used icon */
+    struct window_icon *newest;
+    /* the least recently used icon */
+    struct window_icon *oldest;
+    /* the number of icons in the list */
+    uint32_t number_of_icons;
+    /* the number of bytes all icon pictures take up on the server */
+    size_t size;
+} icon_cache;
+
+/* Remove @icon from the recently used list. */
+static void unlink_icon(struct window_icon *icon)
+{
+    if (icon->newer != NULL) {
+        icon->newer->older = icon->older;
+    } else {
+        icon_cache.newest = icon->older;
+    }
+    if (icon->older != NULL) {
+        icon->older->newer = icon->newer;
+    } else {
+        icon_cache.oldest = icon->newer;
+    }
+    icon_cache.number_of_icons--;
+    icon_cache.size -= (size_t) icon->width * icon->height * 4;
+}
+
+/* Put @icon at the front of the recently used list. */
+static void link_icon(struct window_icon *icon)
+{
+    icon->newer = NULL;
+    icon->older = icon_cache.newest;
+    if (icon_cache.newest != NULL) {
+        icon_cache.newest->newer = icon;
+    } else {
+        icon_cache.oldest = icon;
+    }
+    icon_cache.newest = icon;
+    icon_cache.number_of_icons++;
+    icon_cache.size += (size_t) icon->width * icon->height * 4;
+}
+
+/* Free the icon of @window. */
+void free_window_icon(Window *window)
+{
+    struct window_icon *const icon = window->properties->icon;
+
+    if (icon == NULL) {
+        return;
+    }
+
+    unlink_icon(icon);
+    xcb_render_free_picture(connection, icon->picture);
+    free(icon);
+    window->properties->icon = NULL;
+}
+
+/* Free the least recently used icons until the cache size is at most
+ * @maximum_size, @keep is never freed.
+ */
+static void evict_cold_icons(size_t maximum_size, struct window_icon *keep)
+{
+    Window *window;
+
+    while (icon_cache.size > maximum_size && icon_cache.oldest != keep) {
+        window = icon_cache.oldest->window;
+        free_window_icon(window);
+        /* load the icon again when it is needed */
+        window->stale_properties |= LAZY_PROPERTY_ICON;
+    }
+}
+
+/* Check if an icon of @width times @height is better to scale down than the
+ * one the reader has so far.
+ */
+static bool is_better_icon(const struct icon_reader *reader, uint32_t width,
+        uint32_t height)
+{
+    const uint32_t longer = MAX(width, height);
+    const uint32_t best = MAX(reader->source_width, reader->source_height);
+
+    if (best == 0) {
+        return true;
+    }
+    /* take the smallest icon that is not smaller than the wanted size, if
+     * there is none, take the largest
+     */
+    if (best < reader->size) {
+        return longer > best;
+    }
+    return longer >= reader->size && longer < best;
+}
+
+/* Start reading an icon with the size in the reader header.
+ *
+ * @return false if the icon size is invalid.
+ */
+static bool start_icon(struct icon_reader *reader)
+{
+    const uint32_t width = reader->header[0];
+    const uint32_t height = reader->header[1];
+
+    if (width == 0 || height == 0 ||
+            width > WINDOW_ICON_MAXIMUM_SOURCE_SIZE ||
+            height > WINDOW_ICON_MAXIMUM_SOURCE_SIZE) {
+        return false;
+    }
+
+    reader->pixel_index = 0;
+    reader->remaining_pixels = width * height;
+    reader->is_scaling = is_better_icon(reader, width, height);
+    if (!reader->is_scaling) {
+        return true;
+    }
+
+    reader->source_width = width;
+    reader->source_height = height;
+    /* scale the longer side to the wanted size but never scale up */
+    if (width >= height) {
+        reader->width = MIN(width, reader->size);
+        reader->height = MAX(height * reader->width / width, 1);
+    } else {
+        reader->height = MIN(height, reader->size);
+        reader->width = MAX(width * reader->height / height, 1);
+    }
+    memset(reader->sums, 0,
+            sizeof(*reader->sums) * reader->width * reader->height);
+    memset(reader->counts, 0,
+            sizeof(*reader->counts) * reader->width * reader->height);
+    return true;
+}
+
+/* Add the @argb pixel of the icon being read to the scaled pixel it falls
+ * into.
+ */
+static void add_pixel(struct icon_reader *reader, uint32_t argb)
+{
+    const uint32_t x = reader->pixel_index % reader->source_width;
+    const uint32_t y = reader->pixel_index / reader->source_width;
+    const uint32_t alpha = argb >> 24;
+    uint32_t index;
+
+    index = y * reader->height / reader->source_height * reader->width +
+        x * reader->width / reader->source_width;
+    /* the pixels in `_NET_WM_ICON` are not premultiplied but the pictures
+     * need them to be
+     */
+    reader->sums[index][0] += alpha;
+    reader->sums[index][1] += ((argb >> 16) & 0xff) * alpha / 0xff;
+    reader->sums[index][2] += ((argb >> 8) & 0xff) * alpha / 0xff;
+    reader->sums[index][3] += (argb & 0xff) * alpha / 0xff;
+    reader->counts[index]++;
+}
+
+/* Read the next chunk of `_NET_WM_ICON`. */
+static bool read_icon_chunk(void *data, const void *chunk, uint32_t length)
+{
+    struct icon_reader *const reader = data;
+    const uint32_t *const values = chunk;
+    const uint32_t count = length / sizeof(*values);
+    uint32_t skip;
+
+    for (uint32_t i = 0; i < count; i++) {
+        /* the values are the size of the next icon */
+        if (reader->remaining_pixels == 0) {
+            reader->header[reader->header_length++] = values[i];
+            if (reader->header_length == SIZE(reader->header)) {
+                reader->header_length = 0;
+                if (!start_icon(reader)) {
+                    return false;
+                }
+            }
+            continue;
+        }
+
+        /* jump over icons that are not scaled */
+        if (!reader->is_scaling) {
+            skip = MIN(reader->remaining_pixels, count - i) - 1;
+            reader->remaining_pixels -= skip + 1;
+            i += skip;
+            continue;
+        }
+
+        add_pixel(reader, values[i]);
+        reader->pixel_index++;
+        reader->remaining_pixels--;
+    }
+    return true;
+}
+
+/* Read `_NET_WM_ICON` of @window and upload it scaled down to @size. */
+static struct window_icon *load_window_icon(Window *window, uint32_t size)
+{
+    struct icon_reader reader;
+    uint32_t *pixels;
+    uint32_t count;
+    xcb_render_picture_t picture;
+    struct window_icon *icon;
+
+    memset(&reader, 0, sizeof(reader));
+    reader.size = size;
+    reader.sums = xmalloc(sizeof(*reader.sums) * size * size);
+    reader.counts = xmalloc(sizeof(*reader.counts) * size * size);
+    tag_memory(reader.sums, MEMORY_TAG_ICONS);
+    tag_memory(reader.counts, MEMORY_TAG_ICONS);
+
+    (void) read_property_in_chunks(window->client.id, ATOM(_NET_WM_ICON),
+            XCB_ATOM_CARDINAL, 32, WINDOW_ICON_MAXIMUM_PROPERTY_SIZE,
+            read_icon_chunk, &reader);
+
+    /* the window has no usable icon */
+    if (reader.source_width == 0) {
+        free(reader.counts);
+        free(reader.sums);
+        return NULL;
+    }
+
+    /* average the sums, the sums buffer is reused for the result */
+    pixels = (uint32_t*) reader.sums;
+    for (uint32_t i = 0; i < reader.width * reader.height; i++) {
+        count = MAX(reader.counts[i], 1);
+        pixels[i] = (reader.sums[i][0] / count) << 24 |
+            (reader.sums[i][1] / count) << 16 |
+            (reader.sums[i][2] / count) << 8 |
+            (reader.sums[i][3] / count);
+    }
+
+    picture = create_argb_picture(pixels, reader.width, reader.height);
+
+    free(reader.counts);
+    free(reader.sums);
+
+    if (picture == XCB_NONE) {
+        return NULL;
+    }
+
+    LOG("scaled icon of window %W from %" PRIu32 "x%" PRIu32 " to "
+                "%" PRIu32 "x%" PRIu32 "\n",
+            window, reader.source_width, reader.source_height,
+            reader.width, reader.height);
+
+    icon = xmalloc(sizeof(*icon));
+    tag_memory(icon, MEMORY_TAG_ICONS);
+    icon->window = window;
+    icon->picture = picture;
+    icon->size = size;
+    icon->width = reader.width;
+    icon->height = reader.height;
+    return icon;
+}
+
+/* Get the icon of @window scaled down so it fits into @size times @size. */
+struct window_icon *get_window_icon(Window *window, uint32_t size)
+{
+    struct window_properties *const properties = window->properties;
+    const size_t maximum_size =
+        (size_t) configuration.notification.icon_cache_size * 1024;
+
+    if (maximum_size == 0) {
+        free_window_icon(window);
+        return NULL;
+    }
+
+    size = MIN(size, WINDOW_ICON_MAXIMUM_SIZE);
+    if (size == 0) {
+        return NULL;
+    }
+
+    if (properties->icon != NULL && properties->icon->size != size) {
+        window->stale_properties |= LAZY_PROPERTY_ICON;
+    }
+
+    if ((window->stale_properties & LAZY_PROPERTY_ICON)) {
+        free_window_icon(window);
+        properties->icon = load_window_icon(window, size);
+        if (properties->icon != NULL) {
+            link_icon(properties->icon);
+        }
+        window->stale_properties &= ~LAZY_PROPERTY_ICON;
+    }
+
+    if (properties->icon == NULL) {
+        return NULL;
+    }
+
+    /* move the icon to the front */
+    if (properties->icon != icon_cache.newest) {
+        unlink_icon(properties->icon);
+        link_icon(properties->icon);
+    }
+
+    evict_cold_icons(maximum_size, properties->icon);
+    return properties->icon;
+}
+
+/* Get the number of cached icons and the number of bytes they take up. */
+void get_window_icon_cache_usage(uint32_t *number_of_icons, size_t *size)
+{
+    *number_of_icons = icon_cache.number_of_icons;
+    *size = icon_cache.size;
+}
@@ -21,6 +21,12 @@
 /* user window list window */
 struct window_list window_list;
 
+/* the number of window lists on all screens that are currently shown */
+static uint32_t number_of_shown_window_lists;
+
+/* Register or unregister all event handlers of the window list. */
+static void set_window_list_handlers(bool is_active);
+
 /* Create the window list. */
 int initialize_window_list(void)
 {
@@ -70,12 +76,15 @@ static char get_indicator_character(Window *window)
 }
 
 /* Render the window list. */
-static void render_window_list(void)
+void render_window_list(void)
 {
     utf8_t                  buffer[256];
     uint32_t                window_count;
     struct text_measure     measure;
     uint32_t                height_per_item;
+    uint32_t                icon_size;
+    uint32_t                icon_space;
+    struct window_icon      *icon;
     uint32_t                max_width;
     Frame                   *root_frame;
     uint32_t                index = 0;
@@ -84,6 +93,11 @@ static void render_window_list(void)
     xcb_render_color_t      background_color;
     xcb_render_picture_t    pen;
 
+    /* get the names of all windows in one go, the icons are loaded only for
+     * the visible items
+     */
+    load_all_window_properties(LAZY_PROPERTY_NAME);
+
     /* measure the maximum needed width and get the index of the currently
      * selected window
      */
@@ -108,15 +122,26 @@ static void render_window_list(void)
         max_width = MAX(max_width, measure.total_width);
     }
 
-    /* unmap the window list if there are no more windows */
+    /* hide the window list if there are no more windows */
     if (window_count == 0) {
-        unmap_client(&window_list.client);
+        hide_window_list();
         return;
     }
 
     height_per_item = measure.ascent - measure.descent +
         configuration.notification.padding;
 
+    /* the icons are as high as the text and left of it */
+    if (configuration.notification.icon_cache_size > 0) {
+        icon_size = MIN(measure.ascent - measure.descent,
+                WINDOW_ICON_MAXIMUM_SIZE);
+        icon_space = icon_size + configuration.notification.padding / 2;
+        max_width += icon_space;
+    } else {
+        icon_size = 0;
+        icon_space = 0;
+    }
+
     root_frame = get_root_frame(focus_frame);
 
     /* the number of items that can fit on screen */
@@ -182,10 +207,21 @@ static void render_window_list(void)
                 window->name);
         draw_text(window_list.client.id, buffer,
                 strlen((char*) buffer), background_color, &rectangle,
-                pen, configuration.notification.padding / 2,
+                pen, icon_space + configuration.notification.padding / 2,
                 rectangle.y + measure.ascent +
                     configuration.notification.padding / 2);
 
+        /* draw the icon centered within its square */
+        icon = icon_size > 0 ? get_window_icon(window, icon_size) : NULL;
+        if (icon != NULL) {
+            draw_picture(window_list.client.id, icon->picture,
+                    configuration.notification.padding / 2 +
+                        (icon_size - icon->width) / 2,
+                    rectangle.y + configuration.notification.padding / 2 +
+                        (icon_size - icon->height) / 2,
+                    icon->width, icon->height);
+        }
+
         rectangle.y += rectangle.height;
     }
 }
@@ -221,8 +257,10 @@ static Window *get_valid_window_after(Window *last_valid, Window *start)
 }
 
 /* Handle a key press for the window list window. */
-static void handle_key_press(xcb_key_press_event_t *event)
+static void handle_key_press(xcb_generic_event_t *generic_event)
 {
+    xcb_key_press_event_t *const event = (xcb_key_press_event_t*) generic_event;
+
     if (event->event != window_list.client.id) {
         return;
     }
@@ -232,7 +270,7 @@ static void handle_key_press(xcb_key_press_event_t *event)
     case XK_q:
     case XK_n:
     case XK_Escape:
-        unmap_client(&window_list.client);
+        hide_window_list();
         break;
 
     /* confirm selection */
@@ -248,7 +286,7 @@ static void handle_key_press(xcb_key_press_event_t *event)
 
             window_list.should_revert_focus = false;
         }
-        unmap_client(&window_list.client);
+        hide_window_list();
         break;
 
     /* go to the first item */
@@ -283,8 +321,10 @@ static void handle_key_press(xcb_key_press_event_t *event)
 }
 
 /* Handle a FocusOut event. */
-static void handle_focus_out(xcb_focus_out_event_t *event)
+static void handle_focus_out(xcb_generic_event_t *generic_event)
 {
+    xcb_focus_out_event_t *const event = (xcb_focus_out_event_t*) generic_event;
+
     /* if the this event is for the window list and it is mapped (we also get
      * this event after the window was unmapped)
      */
@@ -303,22 +343,12 @@ static void handle_focus_out(xcb_focus_out_event_t *event)
             window_list.client.id, XCB_CURRENT_TIME);
 }
 
-/* Handle an UnmapNotify event. */
-static void handle_unmap_notify(xcb_unmap_notify_event_t *event)
-{
-    if (event->window != window_list.client.id) {
-        return;
-    }
-
-    /* give focus back to the last window */
-    if (window_list.should_revert_focus) {
-        set_input_focus(focus_window);
-    }
-}
-
 /* Handle when a window gets destroyed. */
-static void handle_destroy_notify(xcb_destroy_notify_event_t *event)
+static void handle_destroy_notify(xcb_generic_event_t *generic_event)
 {
+    xcb_destroy_notify_event_t *const event =
+        (xcb_destroy_notify_event_t*) generic_event;
+
     if (!window_list.client.is_mapped) {
         return;
     }
@@ -333,34 +363,45 @@ static void handle_destroy_notify(xcb_destroy_notify_event_t *event)
     }
 }
 
-/* Handle an incoming event for the window list. */
-void handle_window_list_event(xcb_generic_event_t *event)
+/* Register or unregister all event handlers of the window list. */
+static void set_window_list_handlers(bool is_active)
 {
-    /* remove the most significant bit, this gets the actual event type */
-    switch ((event->response_type & ~0x80)) {
-    /* a key was pressed */
-    case XCB_KEY_PRESS:
-        handle_key_press((xcb_key_press_event_t*) event);
-        break;
-
-    /* the window list lost focus */
-    case XCB_FOCUS_OUT:
-        handle_focus_out((xcb_focus_out_event_t*) event);
-        break;
-
-    /* the window list was hidden */
-    case XCB_UNMAP_NOTIFY:
-        handle_unmap_notify((xcb_unmap_notify_event_t*) event);
-        break;
-
-    /* select another window if the currently selected one is destroyed */
-    case XCB_DESTROY_NOTIFY:
-        handle_destroy_notify((xcb_destroy_notify_event_t*) event);
-        break;
+    const struct {
+        /* the event type */
+        uint8_t type;
+        /* the handler for the event type */
+        event_handler_t handler;
+    } handlers[] = {
+        /* a key was pressed */
+        { XCB_KEY_PRESS, handle_key_press },
+        /* the window list lost focus */
+        { XCB_FOCUS_OUT, handle_focus_out },
+        /* select another window if the currently selected one is destroyed */
+        { XCB_DESTROY_NOTIFY, handle_destroy_notify },
+    };
+
+    /* the handlers are shared by the window lists of all screens, only
+     * register them for the first shown and unregister them with the last
+     * hidden window list
+     */
+    if (is_active) {
+        number_of_shown_window_lists++;
+        if (number_of_shown_window_lists > 1) {
+            return;
+        }
+    } else {
+        number_of_shown_window_lists--;
+        if (number_of_shown_window_lists > 0) {
+            return;
+        }
     }
 
-    if (window_list.client.is_mapped) {
-        render_window_list();
+    for (uint32_t i = 0; i < SIZE(handlers); i++) {
+        if (is_active) {
+            register_event_handler(handlers[i].type, handlers[i].handler);
+        } else {
+            unregister_event_handler(handlers[i].type, handlers[i].handler);
+        }
     }
 }
 
@@ -398,6 +439,8 @@ int show_window_list(void)
 
     /* show the window list window on screen */
     map_client(&window_list.client);
+    /* the window list needs events only while it is mapped */
+    set_window_list_handlers(true);
 
     /* raise the window */
     general_values[0] = XCB_STACK_MODE_ABOVE;
@@ -409,3 +452,23 @@ int show_window_list(void)
             window_list.client.id, XCB_CURRENT_TIME);
     return OK;
 }
+
+/* Hide the window list and stop handling its events. */
+void hide_window_list(void)
+{
+    if (!window_list.client.is_mapped) {
+        return;
+    }
+
+    unmap_client(&window_list.client);
+    /* unregister the handlers right away and not when the UnmapNotify
+     * arrives, otherwise showing the window list again before that would
+     * register them a second time
+     */
+    set_window_list_handlers(false);
+
+    /* give focus back to the last window */
+    if (window_list.should_revert_focus) {
+        set_input_focus(focus_window);
+    }
+}
@@ -0,0 +1,534 @@
+#include <ctype.h>
+#include <string.h>
+
+#include <xcb/xcb_icccm.h>
+
+#include "configuration.h"
+#include "frame.h"
+#include "log.h"
+#include "utf8.h"
+#include "window.h"
+#include "window_rules.h"
+#include "x11_management.h"
+#include "xalloc.h"
+
+/* the atom constants of the window types are in one continuous block */
+#define FIRST_WINDOW_TYPE _NET_WM_WINDOW_TYPE_DESKTOP
+#define LAST_WINDOW_TYPE _NET_WM_WINDOW_TYPE_NORMAL
+#define NUMBER_OF_WINDOW_TYPES (LAST_WINDOW_TYPE - FIRST_WINDOW_TYPE + 1)
+
+/* an exact pattern within the hash table of a matcher */
+struct rule_entry {
+    /* the pattern, this points into the configured rules */
+    const utf8_t *pattern;
+    /* the hash of the pattern */
+    uint32_t hash;
+    /* the index of the rule in the configured rules */
+    uint32_t rule_index;
+    /* the next entry in the same bucket */
+    struct rule_entry *next;
+};
+
+/* the operation of a glob automaton state */
+typedef enum glob_operation {
+    /* consume a single given character */
+    GLOB_LITERAL,
+    /* consume any single character (`?`) */
+    GLOB_ANY,
+    /* consume any number of characters (`*`) */
+    GLOB_STAR,
+    /* the end of a pattern */
+    GLOB_MATCH,
+} glob_operation_t;
+
+/* a state of a glob automaton */
+struct glob_state {
+    /* what this state does */
+    glob_operation_t operation;
+    /* the character for `GLOB_LITERAL` or the rule index for `GLOB_MATCH` */
+    uint32_t value;
+};
+
+/* the compiled patterns of the matchers that match on a string */
+static struct rule_matcher {
+    /* all exact patterns */
+    struct rule_entry *entries;
+    /* the hash table of the exact patterns */
+    struct rule_entry **buckets;
+    /* the number of buckets, this is always a power of two or 0 */
+    uint32_t number_of_buckets;
+    /* the states of all glob patterns, each pattern ends with `GLOB_MATCH` */
+    struct glob_state *states;
+    /* the number of states */
+    uint32_t number_of_states;
+    /* the state each glob pattern starts at */
+    uint32_t *starts;
+    /* the number of glob patterns */
+    uint32_t number_of_starts;
+} matchers[RULE_MATCH_TYPE];
+
+/* the rules that match on a window type, indexed by the window type */
+static struct rule_type_list {
+    /* the indexes of the rules */
+    uint32_t *rules;
+    /* the number of rules */
+    uint32_t number_of_rules;
+} type_rules[NUMBER_OF_WINDOW_TYPES];
+
+/* the number of rules that were compiled */
+static uint32_t number_of_rules;
+
+/* which rules matched the window being evaluated */
+static bool *matched_rules;
+
+/* the active states while running a glob automaton */
+static uint32_t *current_states;
+static uint32_t *next_states;
+/* the generation each state was last added in, this avoids adding a state
+ * twice to the active states
+ */
+static uint32_t *state_generations;
+/* the current generation */
+static uint32_t generation;
+
+/* Translate a window type name like "dialog" or "dropdown-menu" to the
+ * corresponding atom constant.
+ */
+uint32_t translate_string_to_window_type(const char *name)
+{
+    const char *type_name;
+    uint32_t i;
+
+    for (uint32_t type = FIRST_WINDOW_TYPE; type <= LAST_WINDOW_TYPE; type++) {
+        type_name = &x_atoms[type].name[sizeof("_NET_WM_WINDOW_TYPE_") - 1];
+        /* compare case insensitive and let '-' stand for '_' */
+        for (i = 0; name[i] != '\0'; i++) {
+            if (name[i] == '-' ? type_name[i] != '_' :
+                    tolower(name[i]) != tolower(type_name[i])) {
+                break;
+            }
+        }
+        if (name[i] == '\0' && type_name[i] == '\0') {
+            return type;
+        }
+    }
+    return ATOM_MAX;
+}
+
+/* Hash @string using FNV-1a. */
+static uint32_t hash_string(const utf8_t *string)
+{
+    uint32_t hash = 2166136261;
+
+    for (; string[0] != '\0'; string++) {
+        hash ^= string[0];
+        hash *= 16777619;
+    }
+    return hash;
+}
+
+/* Check if @pattern has any glob characters. */
+static bool is_glob_pattern(const utf8_t *pattern)
+{
+    return strpbrk((const char*) pattern, "*?") != NULL;
+}
+
+/* Free all compiled rules. */
+static void clear_window_rules(void)
+{
+    for (uint32_t i = 0; i < SIZE(matchers); i++) {
+        free(matchers[i].entries);
+        free(matchers[i].buckets);
+        free(matchers[i].states);
+        free(matchers[i].starts);
+    }
+    memset(matchers, 0, sizeof(matchers));
+
+    for (uint32_t i = 0; i < SIZE(type_rules); i++) {
+        free(type_rules[i].rules);
+    }
+    memset(type_rules, 0, sizeof(type_rules));
+
+    free(matched_rules);
+    free(current_states);
+    free(next_states);
+    free(state_generations);
+    matched_rules = NULL;
+    current_states = NULL;
+    next_states = NULL;
+    state_generations = NULL;
+    number_of_rules = 0;
+}
+
+/* Append the states of the glob @pattern to the automaton of @matcher. */
+static void compile_glob(struct rule_matcher *matcher, const utf8_t *pattern,
+        uint32_t rule_index)
+{
+    const uint32_t length = strlen((const char*) pattern);
+    uint32_t character;
+    struct glob_state *state;
+
+    RESIZE(matcher->starts, matcher->number_of_starts + 1);
+    matcher->starts[matcher->number_of_starts++] = matcher->number_of_states;
+
+    /* there can be at most one state per byte and the final match state */
+    RESIZE(matcher->states, matcher->number_of_states + length + 1);
+    for (uint32_t i = 0; i < length; ) {
+        U8_NEXT(pattern, i, length, character);
+        state = &matcher->states[matcher->number_of_states];
+        if (character == '*') {
+            /* merge consecutive stars */
+            if (matcher->number_of_states > matcher->starts[
+                        matcher->number_of_starts - 1] &&
+                    state[-1].operation == GLOB_STAR) {
+                continue;
+            }
+            state->operation = GLOB_STAR;
+        } else if (character == '?') {
+            state->operation = GLOB_ANY;
+        } else {
+            state->operation = GLOB_LITERAL;
+            state->value = character;
+        }
+        matcher->number_of_states++;
+    }
+
+    state = &matcher->states[matcher->number_of_states++];
+    state->operation = GLOB_MATCH;
+    state->value = rule_index;
+}
+
+/* Put all exact patterns of @matcher into its hash table. */
+static void compile_exact(struct rule_matcher *matcher, rule_match_t match,
+        uint32_t number_of_entries)
+{
+    const struct configuration_rule *rule;
+    struct rule_entry *entry;
+    uint32_t index;
+
+    if (number_of_entries == 0) {
+        return;
+    }
+
+    /* keep the load factor at 0.5 or below */
+    matcher->number_of_buckets = 1;
+    while (matcher->number_of_buckets < number_of_entries * 2) {
+        matcher->number_of_buckets <<= 1;
+    }
+    matcher->buckets = xcalloc(matcher->number_of_buckets,
+            sizeof(*matcher->buckets));
+    matcher->entries = xmalloc(sizeof(*matcher->entries) * number_of_entries);
+
+    entry = matcher->entries;
+    for (uint32_t i = 0; i < configuration.rules.number_of_rules; i++) {
+        rule = &configuration.rules.rules[i];
+        if (rule->match != match || is_glob_pattern(rule->pattern)) {
+            continue;
+        }
+        entry->pattern = rule->pattern;
+        entry->hash = hash_string(rule->pattern);
+        entry->rule_index = i;
+        index = entry->hash & (matcher->number_of_buckets - 1);
+        entry->next = matcher->buckets[index];
+        matcher->buckets[index] = entry;
+        entry++;
+    }
+}
+
+/* Compile the rules of the current configuration into the hash tables and
+ * automatons used by `apply_window_rules()`.
+ */
+void compile_window_rules(void)
+{
+    const struct configuration_rule *rule;
+    uint32_t number_of_exact[SIZE(matchers)];
+    uint32_t maximum_states = 0;
+    uint32_t type;
+    struct rule_type_list *list;
+
+    clear_window_rules();
+
+    number_of_rules = configuration.rules.number_of_rules;
+    if (number_of_rules == 0) {
+        return;
+    }
+
+    memset(number_of_exact, 0, sizeof(number_of_exact));
+    for (uint32_t i = 0; i < number_of_rules; i++) {
+        rule = &configuration.rules.rules[i];
+        if (rule->match == RULE_MATCH_TYPE) {
+            type = translate_string_to_window_type(
+                    (const char*) rule->pattern);
+            if (type == ATOM_MAX) {
+                LOG_ERROR("invalid window type in rule: %s\n", rule->pattern);
+                continue;
+            }
+            list = &type_rules[type - FIRST_WINDOW_TYPE];
+            RESIZE(list->rules, list->number_of_rules + 1);
+            list->rules[list->number_of_rules++] = i;
+        } else if (is_glob_pattern(rule->pattern)) {
+            compile_glob(&matchers[rule->match], rule->pattern, i);
+        } else {
+            number_of_exact[rule->match]++;
+        }
+    }
+
+    for (rule_match_t match = 0; match < SIZE(matchers); match++) {
+        compile_exact(&matchers[match], match, number_of_exact[match]);
+        maximum_states = MAX(maximum_states, matchers[match].number_of_states);
+    }
+
+    matched_rules = xmalloc(sizeof(*matched_rules) * number_of_rules);
+    if (maximum_states > 0) {
+        current_states = xmalloc(sizeof(*current_states) * maximum_states);
+        next_states = xmalloc(sizeof(*next_states) * maximum_states);
+        state_generations = xcalloc(maximum_states,
+                sizeof(*state_generations));
+        generation = 0;
+    }
+}
+
+/* Check if @matcher has no patterns at all. */
+static inline bool is_matcher_empty(const struct rule_matcher *matcher)
+{
+    return matcher->number_of_buckets == 0 && matcher->number_of_starts == 0;
+}
+
+/* Start a new generation so that all states can be added again. */
+static void next_generation(uint32_t number_of_states)
+{
+    generation++;
+    /* on an overflow, the old generations must be cleared */
+    if (generation == 0) {
+        memset(state_generations, 0,
+                sizeof(*state_generations) * number_of_states);
+        generation = 1;
+    }
+}
+
+/* Add @state and the states it can reach without consuming a character to
+ * @states.
+ */
+static void add_glob_state(const struct rule_matcher *matcher,
+        uint32_t *states, uint32_t *number_of_states, uint32_t state)
+{
+    while (state_generations[state] != generation) {
+        state_generations[state] = generation;
+        states[(*number_of_states)++] = state;
+        /* a star may also match nothing */
+        if (matcher->states[state].operation != GLOB_STAR) {
+            break;
+        }
+        state++;
+    }
+}
+
+/* Run the glob automaton of @matcher over @string and mark all rules whose
+ * pattern matches.
+ */
+static void match_globs(const struct rule_matcher *matcher,
+        const utf8_t *string)
+{
+    uint32_t *current = current_states, *next = next_states, *swap;
+    uint32_t number_of_current = 0, number_of_next;
+    const uint32_t length = strlen((const char*) string);
+    uint32_t character;
+    const struct glob_state *state;
+
+    if (matcher->number_of_starts == 0) {
+        return;
+    }
+
+    next_generation(matcher->number_of_states);
+    for (uint32_t i = 0; i < matcher->number_of_starts; i++) {
+        add_glob_state(matcher, current, &number_of_current,
+                matcher->starts[i]);
+    }
+
+    for (uint32_t i = 0; i < length && number_of_current > 0; ) {
+        U8_NEXT(string, i, length, character);
+
+        next_generation(matcher->number_of_states);
+        number_of_next = 0;
+        for (uint32_t j = 0; j < number_of_current; j++) {
+            state = &matcher->states[current[j]];
+            switch (state->operation) {
+            /* advance if the character is the same */
+            case GLOB_LITERAL:
+                if (state->value == character) {
+                    add_glob_state(matcher, next, &number_of_next,
+                            current[j] + 1);
+                }
+                break;
+
+            /* advance on any character */
+            case GLOB_ANY:
+                add_glob_state(matcher, next, &number_of_next, current[j] + 1);
+                break;
+
+            /* consume the character but stay in this state */
+            case GLOB_STAR:
+                add_glob_state(matcher, next, &number_of_next, current[j]);
+                break;
+
+            /* the pattern ended before the string */
+            case GLOB_MATCH:
+                break;
+            }
+        }
+
+        swap = current;
+        current = next;
+        next = swap;
+        number_of_current = number_of_next;
+    }
+
+    /* the states at the end of a pattern are the matching patterns */
+    for (uint32_t i = 0; i < number_of_current; i++) {
+        state = &matcher->states[current[i]];
+        if (state->operation == GLOB_MATCH) {
+            matched_rules[state->value] = true;
+        }
+    }
+}
+
+/* Look up @string in the hash table of @matcher and mark all rules whose
+ * pattern is equal.
+ */
+static void match_exact(const struct rule_matcher *matcher,
+        const utf8_t *string)
+{
+    uint32_t hash;
+
+    if (matcher->number_of_buckets == 0) {
+        return;
+    }
+
+    hash = hash_string(string);
+    for (struct rule_entry *entry =
+                matcher->buckets[hash & (matcher->number_of_buckets - 1)];
+            entry != NULL; entry = entry->next) {
+        if (entry->hash == hash && strcmp((const char*) entry->pattern,
+                    (const char*) string) == 0) {
+            matched_rules[entry->rule_index] = true;
+        }
+    }
+}
+
+/* Mark all rules of @match that match on @string. */
+static void match_string(rule_match_t match, const utf8_t *string)
+{
+    if (string == NULL) {
+        return;
+    }
+    match_exact(&matchers[match], string);
+    match_globs(&matchers[match], string);
+}
+
+/* Apply all matching rules to a window that was just created. */
+void apply_window_rules(Window *window, const xcb_atom_t *types,
+        window_mode_t *mode)
+{
+    bool has_class;
+    xcb_get_property_cookie_t class_cookie;
+    xcb_icccm_get_wm_class_reply_t class;
+    const struct configuration_rule *rule;
+    const struct rule_type_list *list;
+
+    if (number_of_rules == 0) {
+        return;
+    }
+
+    memset(matched_rules, 0, sizeof(*matched_rules) * number_of_rules);
+
+    /* send the request for the class before waiting for any reply */
+    has_class = !is_matcher_empty(&matchers[RULE_MATCH_INSTANCE]) ||
+        !is_matcher_empty(&matchers[RULE_MATCH_CLASS]);
+    if (has_class) {
+        class_cookie = xcb_icccm_get_wm_class(connection, window->client.id);
+    }
+
+    /* the name is a lazy property, only load it if it is needed */
+    if (!is_matcher_empty(&matchers[RULE_MATCH_TITLE])) {
+        load_window_properties(window, LAZY_PROPERTY_NAME);
+        match_string(RULE_MATCH_TITLE, window->name);
+    }
+
+    for (; types != NULL && types[0] != XCB_NONE; types++) {
+        for (uint32_t i = 0; i < NUMBER_OF_WINDOW_TYPES; i++) {
+            if (ATOM(FIRST_WINDOW_TYPE + i) != types[0]) {
+                continue;
+            }
+            list = &type_rules[i];
+            for (uint32_t j = 0; j < list->number_of_rules; j++) {
+                matched_rules[list->rules[j]] = true;
+            }
+            break;
+        }
+    }
+
+    if (has_class && xcb_icccm_get_wm_class_reply(connection, class_cookie,
+                &class, NULL)) {
+        match_string(RULE_MATCH_INSTANCE, (utf8_t*) class.instance_name);
+        match_string(RULE_MATCH_CLASS, (utf8_t*) class.class_name);
+        xcb_icccm_get_wm_class_reply_wipe(&class);
+    }
+
+    for (uint32_t i = 0; i < number_of_rules; i++) {
+        if (!matched_rules[i]) {
+            continue;
+        }
+
+        rule = &configuration.rules.rules[i];
+        LOG("applying rule for %s to %W\n", rule->pattern, window);
+        if (rule->mode != WINDOW_MODE_MAX) {
+            *mode = rule->mode;
+        }
+        if (rule->frame != RULE_FRAME_FOCUS && !window->client.is_mapped) {
+            window->properties->rule_frame = rule->frame;
+        }
+    }
+}
+
+/* Get the frame a tiling window should be put into when it is shown. */
+Frame *get_window_rule_frame(Window *window)
+{
+    Frame *root, *frame;
+    int32_t x, y;
+
+    root = get_root_frame(focus_frame);
+    x = root->x + root->width / 2;
+    y = root->y + root->height / 2;
+
+    switch (window->properties->rule_frame) {
+    /* no frame was configured */
+    case RULE_FRAME_FOCUS:
+        /* use the frame that was focused when the program was started */
+        if (window->properties->has_launch_position) {
+            x = window->properties->launch_position.x;
+            y = window->properties->launch_position.y;
+            break;
+        }
+        return focus_frame;
+
+    /* use the frame touching the middle of an edge of the monitor */
+    case RULE_FRAME_LEFT:
+        x = root->x;
+        break;
+    case RULE_FRAME_UP:
+        y = root->y;
+        break;
+    case RULE_FRAME_RIGHT:
+        x = root->x + root->width - 1;
+        break;
+    case RULE_FRAME_DOWN:
+        y = root->y + root->height - 1;
+        break;
+    }
+
+    frame = get_frame_at_position(x, y);
+    if (frame == NULL) {
+        return focus_frame;
+    }
+    return frame;
+}
@@ -3,7 +3,6 @@
 #include "configuration.h"
 #include "frame.h"
 #include "log.h"
-#include "monitor.h"
 #include "stash_frame.h"
 #include "tiling.h"
 #include "utility.h"
@@ -25,156 +24,13 @@ bool has_window_border(Window *window)
         return false;
     }
     /* if the window has borders itself (not set by the window manager) */
-    if ((window->motif_wm_hints.flags &
+    if ((window->properties->motif_wm_hints.flags &
                 MOTIF_WM_HINTS_DECORATIONS)) {
         return false;
     }
     return true;
 }
 
-/* Set the window size and position according to the size hints. */
-static void configure_floating_size(Window *window)
-{
-    Monitor *monitor;
-    int32_t x, y;
-    uint32_t width, height;
-
-    monitor = get_monitor_from_rectangle_or_primary(window->x, window->y,
-            window->width, window->height);
-
-    /* if the window never had a floating size, use the size hints to get a size
-     * that the window prefers
-     */
-    if (window->floating.width == 0) {
-        if ((window->size_hints.flags & XCB_ICCCM_SIZE_HINT_P_SIZE)) {
-            width = window->size_hints.width;
-            height = window->size_hints.height;
-        } else {
-            width = monitor->width * 2 / 3;
-            height = monitor->height * 2 / 3;
-        }
-
-        if ((window->size_hints.flags & XCB_ICCCM_SIZE_HINT_P_MIN_SIZE)) {
-            width = MAX(width, (uint32_t) window->size_hints.min_width);
-            height = MAX(height, (uint32_t) window->size_hints.min_height);
-        }
-
-        if ((window->size_hints.flags & XCB_ICCCM_SIZE_HINT_P_MAX_SIZE)) {
-            width = MIN(width, (uint32_t) window->size_hints.max_width);
-            height = MIN(height, (uint32_t) window->size_hints.max_height);
-        }
-
-        /* center the window */
-        x = monitor->x + (monitor->width - width) / 2;
-        y = monitor->y + (monitor->height - height) / 2;
-    } else {
-        width = window->floating.width;
-        height = window->floating.height;
-        /* if the window would still be in the monitor is was moved to,
-         * restore the position, otherwise center the window
-         */
-        if (get_monitor_from_rectangle(window->floating.x,
-                    window->floating.y, window->floating.width,
-                    window->floating.height) == monitor) {
-            x = window->floating.x;
-            y = window->floating.y;
-        } else {
-            x = monitor->x + (monitor->width - width) / 2;
-            y = monitor->y + (monitor->height - height) / 2;
-        }
-    }
-
-    /* consider the window gravity, i.e. where the window wants to be */
-    if ((window->size_hints.flags & XCB_ICCCM_SIZE_HINT_P_WIN_GRAVITY)) {
-        adjust_for_window_gravity(monitor, &x, &y, width, height,
-                window->size_hints.win_gravity);
-    }
-
-    set_window_size(window, x, y, width, height);
-}
-
-/* Sets the position and size of the window to fullscreen. */
-static void configure_fullscreen_size(Window *window)
-{
-    Monitor *monitor;
-
-    if (window->fullscreen_monitors.top != window->fullscreen_monitors.bottom) {
-        set_window_size(window, window->fullscreen_monitors.left,
-                window->fullscreen_monitors.top,
-                window->fullscreen_monitors.right -
-                    window->fullscreen_monitors.left,
-                window->fullscreen_monitors.bottom -
-                    window->fullscreen_monitors.left);
-    } else {
-        monitor = get_monitor_from_rectangle_or_primary(window->x,
-                window->y, window->width, window->height);
-        set_window_size(window, monitor->x, monitor->y,
-                monitor->width, monitor->height);
-    }
-}
-
-/* Sets the position and size of the window to a dock window. */
-static void configure_dock_size(Window *window)
-{
-    const uint32_t both_hints = XCB_ICCCM_SIZE_HINT_P_POSITION |
-        XCB_ICCCM_SIZE_HINT_P_SIZE;
-    Monitor *monitor;
-    int32_t x, y;
-    uint32_t width, height;
-
-    /* check if the window has both position and size defined */
-    if ((window->size_hints.flags & both_hints) == both_hints) {
-        x = window->size_hints.x;
-        y = window->size_hints.y;
-        width = window->size_hints.width;
-        height = window->size_hints.height;
-        monitor = get_monitor_from_rectangle_or_primary(window->x, window->y,
-                window->width, window->height);
-    } else {
-        monitor = get_monitor_from_rectangle_or_primary(window->x, window->y,
-                1, 1);
-
-        /* if the window does not specify a size itself, then do it based on the
-         * strut the window defines, reasoning is that when the window wants to
-         * occupy screen space, then it should be within that occupied space
-         */
-        if (window->strut.reserved.left != 0) {
-            x = monitor->x;
-            y = window->strut.left_start_y;
-            width = window->strut.reserved.left;
-            height = window->strut.left_end_y - window->strut.left_start_y + 1;
-        } else if (window->strut.reserved.top != 0) {
-            x = window->strut.top_start_x;
-            y = monitor->y;
-            width = window->strut.top_end_x - window->strut.top_start_x + 1;
-            height = window->strut.reserved.top;
-        } else if (window->strut.reserved.right != 0) {
-            x = monitor->x + monitor->width - window->strut.reserved.right;
-            y = window->strut.right_start_y;
-            width = window->strut.reserved.right;
-            height = window->strut.right_end_y -
-                window->strut.right_start_y + 1;
-        } else if (window->strut.reserved.bottom != 0) {
-            x = window->strut.bottom_start_x;
-            y = monitor->y + monitor->height - window->strut.reserved.bottom;
-            width = window->strut.bottom_end_x -
-                window->strut.bottom_start_x + 1;
-            height = window->strut.reserved.bottom;
-        } else {
-            width = window->width;
-            height = window->height;
-        }
-    }
-
-    /* consider the window gravity, i.e. where the window wants to be */
-    if ((window->size_hints.flags & XCB_ICCCM_SIZE_HINT_P_WIN_GRAVITY)) {
-        adjust_for_window_gravity(monitor, &x, &y, width, height,
-            window->size_hints.win_gravity);
-    }
-
-    set_window_size(window, x, y, width, height);
-}
-
 /* Synchronize the `_NET_WM_ALLOWED_ACTIONS` X property. */
 static void synchronize_allowed_actions(Window *window)
 {
@@ -245,16 +101,16 @@ void add_window_states(Window *window, xcb_atom_t *states,
         j = 0;
 
         /* add the state to the window properties */
-        if (window->states != NULL) {
+        if (window->properties->states != NULL) {
             /* find the number of elements */
-            for (; window->states[j] != XCB_NONE; j++) {
+            for (; window->properties->states[j] != XCB_NONE; j++) {
                 /* nothing */
             }
         }
 
-        RESIZE(window->states, j + 2);
-        window->states[j] = states[i];
-        window->states[j + 1] = XCB_NONE;
+        RESIZE(window->properties->states, j + 2);
+        window->properties->states[j] = states[i];
+        window->properties->states[j + 1] = XCB_NONE;
 
         states[effective_count++] = states[i];
     }
@@ -278,25 +134,25 @@ void remove_window_states(Window *window, xcb_atom_t *states,
     uint32_t effective_count = 0;
 
     /* if no states are there, nothing can be removed */
-    if (window->states == NULL) {
+    if (window->properties->states == NULL) {
         return;
     }
 
     /* filter out all states in the window properties that are in `states` */
-    for (i = 0; window->states[i] != XCB_NONE; i++) {
+    for (i = 0; window->properties->states[i] != XCB_NONE; i++) {
         uint32_t j;
 
         /* check if the state exists in `states`... */
         for (j = 0; j < number_of_states; j++) {
-            if (states[j] == window->states[i]) {
+            if (states[j] == window->properties->states[i]) {
                 break;
             }
         }
 
         /* ...if not, add it */
         if (j == number_of_states) {
-            window->states[effective_count++] =
-                window->states[i];
+            window->properties->states[effective_count++] =
+                window->properties->states[i];
         }
     }
 
@@ -306,13 +162,13 @@ void remove_window_states(Window *window, xcb_atom_t *states,
     }
 
     /* terminate the end with `XCB_NONE` */
-    window->states[effective_count] = XCB_NONE;
+    window->properties->states[effective_count] = XCB_NONE;
 
     /* replace the atom list on the X server */
     xcb_change_property(connection, XCB_PROP_MODE_REPLACE,
             window->client.id, ATOM(_NET_WM_STATE),
             XCB_ATOM_ATOM, 32, effective_count,
-            window->states);
+            window->properties->states);
 }
 
 /* Changes the window state to given value and reconfigures the window only
@@ -358,19 +214,11 @@ void set_window_mode(Window *window, window_mode_t mode)
             reload_frame(focus_frame);
             break;
 
-        /* set the floating size */
+        /* set the floating, fullscreen or dock size */
         case WINDOW_MODE_FLOATING:
-            configure_floating_size(window);
-            break;
-
-        /* set the fullscreen size */
         case WINDOW_MODE_FULLSCREEN:
-            configure_fullscreen_size(window);
-            break;
-
-        /* set the dock size */
         case WINDOW_MODE_DOCK:
-            configure_dock_size(window);
+            update_window_size(window);
             break;
 
         /* not a real window mode */
@@ -421,24 +269,19 @@ void show_window(Window *window)
             reload_frame(frame);
             break;
         }
-        stash_frame(focus_frame);
-        focus_frame->window = window;
-        reload_frame(focus_frame);
+        Frame *const target = get_window_rule_frame(window);
+        window->properties->rule_frame = RULE_FRAME_FOCUS;
+        window->properties->has_launch_position = false;
+        stash_frame(target);
+        target->window = window;
+        reload_frame(target);
     } break;
 
-    /* the window has to show as floating window */
+    /* the window has to show as floating, fullscreen or dock window */
     case WINDOW_MODE_FLOATING:
-        configure_floating_size(window);
-        break;
-
-    /* the window has to show as fullscreen window */
     case WINDOW_MODE_FULLSCREEN:
-        configure_fullscreen_size(window);
-        break;
-
-    /* the window has to show as dock window */
     case WINDOW_MODE_DOCK:
-        configure_dock_size(window);
+        update_window_size(window);
         break;
 
     /* not a real window mode */
@@ -1,11 +1,16 @@
 #include <inttypes.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "log.h"
 #include "fensterchef.h"
+#include "launch.h"
+#include "probe.h"
+#include "screen.h"
 #include "window.h"
 #include "window_list.h"
 #include "x11_management.h"
+#include "xalloc.h"
 
 /* event mask for the root window; with this event mask, we get the following
  * events:
@@ -32,12 +37,15 @@ xcb_connection_t *connection;
 /* file descriptor associated to the X connection */
 int x_file_descriptor;
 
-/* the selected x screen */
+/* the x screen of the current managed screen */
 xcb_screen_t *screen;
 
 /* general purpose values for xcb function calls */
 uint32_t general_values[7];
 
+/* the sequence number of the last request changing the layout of windows */
+uint32_t last_layout_sequence;
+
 /* supporting wm check window */
 xcb_window_t wm_check_window;
 
@@ -50,13 +58,17 @@ struct x_atoms x_atoms[] = {
 #undef X
 };
 
-/* Initialize the X server connection and the X atoms. */
+/* Initialize the X server connection, the X atoms and the managed screens. */
 int initialize_x11(void)
 {
     int connection_error;
     int screen_number;
+    const char *display;
+    const char *colon;
+    bool is_screen_named;
     const xcb_setup_t *setup;
     xcb_screen_iterator_t i;
+    int number;
     xcb_intern_atom_cookie_t atom_cookies[ATOM_MAX];
     xcb_generic_error_t *error;
     xcb_intern_atom_reply_t *atom;
@@ -75,19 +87,24 @@ int initialize_x11(void)
 
     x_file_descriptor = xcb_get_file_descriptor(connection);
 
+    /* a display in the form :X.Y names the only screen to manage */
+    display = getenv("DISPLAY");
+    colon = display == NULL ? NULL : strrchr(display, ':');
+    is_screen_named = colon != NULL && strchr(colon, '.') != NULL;
+
     setup = xcb_get_setup(connection);
 
-    /* iterator over all screens to find the one with the screen number */
-    for(i = xcb_setup_roots_iterator(setup); i.rem > 0; xcb_screen_next(&i)) {
-        if (screen_number == 0) {
-            screen = i.data;
-            LOG("%C\n", screen);
+    /* the screen with the screen number comes first */
+    number = 0;
+    for (i = xcb_setup_roots_iterator(setup); i.rem > 0; xcb_screen_next(&i)) {
+        if (number == screen_number) {
+            add_managed_screen(i.data, number);
             break;
         }
-        screen_number--;
+        number++;
     }
 
-    if (screen == NULL) {
+    if (number_of_managed_screens == 0) {
         /* this should in theory not happen because `xcb_connect()` already
          * checks if the screen exists
          */
@@ -95,6 +112,16 @@ int initialize_x11(void)
         return ERROR;
     }
 
+    /* add all other screens of the display */
+    number = 0;
+    for (i = xcb_setup_roots_iterator(setup); i.rem > 0 && !is_screen_named;
+            xcb_screen_next(&i)) {
+        if (number != screen_number) {
+            add_managed_screen(i.data, number);
+        }
+        number++;
+    }
+
     /* intern the atoms into the xcb server */
     for (uint32_t i = 0; i < ATOM_MAX; i++) {
         atom_cookies[i] = xcb_intern_atom(connection, false,
@@ -176,8 +203,8 @@ static int create_utility_windows(void)
     return OK;
 }
 
-/* Try to take control of the window manager role. */
-int take_control(void)
+/* Set the event mask of the root window of @managed_screen. */
+static int select_root_events(struct managed_screen *managed_screen)
 {
     xcb_generic_error_t *error;
 
@@ -186,25 +213,116 @@ int take_control(void)
      */
     general_values[0] = ROOT_EVENT_MASK;
     error = xcb_request_check(connection,
-            xcb_change_window_attributes_checked(connection, screen->root,
-                XCB_CW_EVENT_MASK, general_values));
+            xcb_change_window_attributes_checked(connection,
+                managed_screen->screen->root, XCB_CW_EVENT_MASK,
+                general_values));
     if (error != NULL) {
-        LOG_ERROR("could not change root window mask: %E\n", error);
+        LOG_ERROR("could not change root window mask of screen %d: %E\n",
+                managed_screen->number, error);
         free(error);
         return ERROR;
     }
+    return OK;
+}
 
-    /* create the necessary utility windows */
-    if (create_utility_windows() != OK) {
+/* Try to take control of the window manager role on all screens. */
+int take_control(void)
+{
+    /* the screen named by `DISPLAY` must be available */
+    if (select_root_events(&managed_screens[0]) != OK) {
         return ERROR;
     }
 
+    /* other screens might be managed by another window manager */
+    for (uint32_t i = 1; i < number_of_managed_screens; i++) {
+        if (select_root_events(&managed_screens[i]) != OK) {
+            remove_managed_screen(i);
+            i--;
+        }
+    }
+
+    /* create the necessary utility windows */
+    for (uint32_t i = 0; i < number_of_managed_screens; i++) {
+        switch_screen(i);
+        if (create_utility_windows() != OK) {
+            return ERROR;
+        }
+    }
+
+    switch_screen(0);
+
     /* intialize the focus */
     xcb_set_input_focus(connection, XCB_INPUT_FOCUS_POINTER_ROOT,
             wm_check_window, XCB_CURRENT_TIME);
     return OK;
 }
 
+/* Get the home slot of @id within a window id set with @capacity slots. */
+static inline uint32_t hash_window_id(xcb_window_t id, uint32_t capacity)
+{
+    uint32_t hash;
+
+    hash = id;
+    hash ^= hash >> 16;
+    hash *= 0x45d9f3b;
+    hash ^= hash >> 16;
+    return hash & (capacity - 1);
+}
+
+/* Put the ids of all windows of the current screen into a set using linear
+ * probing, empty slots are `XCB_NONE`.
+ *
+ * @capacity is set to the number of slots which is a power of two.
+ *
+ * @return NULL if there are no windows.
+ */
+static xcb_window_t *create_window_id_set(uint32_t *capacity)
+{
+    uint32_t count = 0;
+    xcb_window_t *set;
+    uint32_t index;
+
+    for (Window *window = first_window; window != NULL;
+            window = window->next) {
+        count++;
+    }
+    if (count == 0) {
+        return NULL;
+    }
+
+    /* keep the set at most half full */
+    *capacity = 1;
+    while (*capacity < count * 2) {
+        *capacity *= 2;
+    }
+    set = xcalloc(*capacity, sizeof(*set));
+    for (Window *window = first_window; window != NULL;
+            window = window->next) {
+        index = hash_window_id(window->client.id, *capacity);
+        while (set[index] != XCB_NONE) {
+            index = (index + 1) & (*capacity - 1);
+        }
+        set[index] = window->client.id;
+    }
+    return set;
+}
+
+/* Check if @id is within the window id @set. */
+static bool is_in_window_id_set(const xcb_window_t *set, uint32_t capacity,
+        xcb_window_t id)
+{
+    uint32_t index;
+
+    index = hash_window_id(id, capacity);
+    while (set[index] != XCB_NONE) {
+        if (set[index] == id) {
+            return true;
+        }
+        index = (index + 1) & (capacity - 1);
+    }
+    return false;
+}
+
 /* Go through all existing windows and manage them. */
 void query_existing_windows(void)
 {
@@ -212,6 +330,8 @@ void query_existing_windows(void)
     xcb_query_tree_reply_t *tree;
     xcb_window_t *windows;
     int length;
+    xcb_window_t *managed;
+    uint32_t capacity = 0;
     Window *window;
 
     /* get a list of child windows of the root in bottom-to-top stacking order
@@ -223,15 +343,26 @@ void query_existing_windows(void)
         return;
     }
 
+    /* the windows restored from a snapshot are already managed, only the
+     * windows created after the snapshot was taken are new; the set makes
+     * telling them apart linear in the number of windows
+     */
+    managed = create_window_id_set(&capacity);
+
     windows = xcb_query_tree_children(tree);
     length = xcb_query_tree_children_length(tree);
     for (int i = 0; i < length; i++) {
+        if (managed != NULL &&
+                is_in_window_id_set(managed, capacity, windows[i])) {
+            continue;
+        }
         window = create_window(windows[i]);
         if (window != NULL && window->client.is_mapped) {
             show_window(window);
         }
     }
 
+    free(managed);
     free(tree);
 }
 
@@ -266,6 +397,10 @@ void initialize_root_properties(void)
 
         ATOM(_NET_WM_NAME),
 
+        ATOM(_NET_WM_ICON),
+
+        ATOM(_NET_STARTUP_ID),
+
         ATOM(_NET_WM_DESKTOP),
 
         ATOM(_NET_WM_WINDOW_TYPE),
@@ -363,6 +498,8 @@ void set_input_focus(Window *window)
                 focus_id, XCB_CURRENT_TIME);
     }
 
+    PROBE2(input__focus, focus_id, active_id);
+
     xcb_change_property(connection, XCB_PROP_MODE_REPLACE, screen->root,
             ATOM(_NET_ACTIVE_WINDOW), XCB_ATOM_WINDOW, 32, 1, &active_id);
 }
@@ -378,7 +515,7 @@ void map_client(XClient *client)
 
     client->is_mapped = true;
 
-    xcb_map_window(connection, client->id);
+    last_layout_sequence = xcb_map_window(connection, client->id).sequence;
 }
 
 /* Hide the client on the X server. */
@@ -392,7 +529,7 @@ void unmap_client(XClient *client)
 
     client->is_mapped = false;
 
-    xcb_unmap_window(connection, client->id);
+    last_layout_sequence = xcb_unmap_window(connection, client->id).sequence;
 }
 
 /* Set the size of a window associated to the X server. */
@@ -418,10 +555,10 @@ void configure_client(XClient *client, int32_t x, int32_t y, uint32_t width,
     general_values[2] = width;
     general_values[3] = height;
     general_values[4] = border_width;
-    xcb_configure_window(connection, client->id,
+    last_layout_sequence = xcb_configure_window(connection, client->id,
             XCB_CONFIG_WINDOW_X | XCB_CONFIG_WINDOW_Y |
             XCB_CONFIG_WINDOW_WIDTH | XCB_CONFIG_WINDOW_HEIGHT |
-            XCB_CONFIG_WINDOW_BORDER_WIDTH, general_values);
+            XCB_CONFIG_WINDOW_BORDER_WIDTH, general_values).sequence;
 }
 
 /* Set the client border color. */
@@ -440,20 +577,20 @@ void change_client_attributes(XClient *client, uint32_t border_color)
             XCB_CW_BORDER_PIXEL, general_values);
 }
 
-/* Wrapper around getting a cookie and reply for a GetProperty request. */
-static inline xcb_get_property_reply_t *get_property(xcb_window_t window,
-        xcb_atom_t property, xcb_atom_t type, uint8_t format, uint32_t length,
+/* Wrapper around getting the reply of a GetProperty request. */
+static inline xcb_get_property_reply_t *get_property_reply(
+        xcb_window_t window, xcb_atom_t property,
+        xcb_get_property_cookie_t cookie, uint8_t format, uint32_t length,
         xcb_generic_error_t **error)
 {
-    xcb_get_property_cookie_t cookie;
     xcb_get_property_reply_t *reply;
 
-    cookie = xcb_get_property(connection, false, window, property, type, 0,
-            length);
     reply = xcb_get_property_reply(connection, cookie, error);
     if (reply == NULL) {
         return NULL;
     }
+    PROBE3(property__fetch, window, property,
+            xcb_get_property_value_length(reply));
     /* check if the property is in the needed format and if it is long enough */
     if (reply->format != format || (length != UINT32_MAX &&
                 (uint32_t) xcb_get_property_value_length(reply) <
@@ -465,28 +602,168 @@ static inline xcb_get_property_reply_t *get_property(xcb_window_t window,
     return reply;
 }
 
-/* Update the name within @properties. */
-static void update_window_name(Window *window)
+/* Wrapper around getting a cookie and reply for a GetProperty request. */
+static inline xcb_get_property_reply_t *get_property(xcb_window_t window,
+        xcb_atom_t property, xcb_atom_t type, uint8_t format, uint32_t length,
+        xcb_generic_error_t **error)
+{
+    xcb_get_property_cookie_t cookie;
+
+    cookie = xcb_get_property(connection, false, window, property, type, 0,
+            length);
+    return get_property_reply(window, property, cookie, format, length, error);
+}
+
+/* Read a property that can be genuinely large, for example `_NET_WM_ICON`. */
+int read_property_in_chunks(xcb_window_t window, xcb_atom_t property,
+        xcb_atom_t type, uint8_t format, uint32_t maximum_size,
+        property_chunk_handler_t handler, void *data)
+{
+    xcb_get_property_cookie_t cookie;
+    xcb_get_property_reply_t *reply;
+    uint32_t size, remaining;
+    uint32_t offset, length;
+    uint32_t count;
+    xcb_get_property_cookie_t *cookies;
+    bool is_reading;
+
+    /* offsets and lengths are given in units of 4 bytes */
+    maximum_size -= maximum_size % 4;
+
+    cookie = xcb_get_property(connection, false, window, property, type, 0,
+            MIN(maximum_size, PROPERTY_CHUNK_SIZE) / 4);
+    reply = get_property_reply(window, property, cookie, format, 0, NULL);
+    if (reply == NULL) {
+        return ERROR;
+    }
+
+    size = xcb_get_property_value_length(reply);
+    remaining = MIN(reply->bytes_after, maximum_size - size);
+    if (remaining < reply->bytes_after) {
+        LOG("property %a of window %w is larger than %" PRIu32 " bytes, "
+                    "ignoring the rest\n",
+                property, window, maximum_size);
+    }
+
+    is_reading = handler(data, xcb_get_property_value(reply), size);
+    free(reply);
+
+    if (!is_reading || remaining == 0) {
+        return OK;
+    }
+
+    /* send the requests for all remaining chunks at once */
+    count = (remaining + PROPERTY_CHUNK_SIZE - 1) / PROPERTY_CHUNK_SIZE;
+    cookies = xmalloc(sizeof(*cookies) * count);
+    offset = size / 4;
+    for (uint32_t i = 0; i < count; i++) {
+        length = MIN(remaining, PROPERTY_CHUNK_SIZE);
+        cookies[i] = xcb_get_property(connection, false, window, property,
+                type, offset, (length + 3) / 4);
+        offset += length / 4;
+        remaining -= length;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        /* the handler is not interested in the rest */
+        if (!is_reading) {
+            xcb_discard_reply(connection, cookies[i].sequence);
+            continue;
+        }
+        /* the property might have changed or was deleted in between */
+        reply = get_property_reply(window, property, cookies[i], format, 0,
+                NULL);
+        if (reply == NULL) {
+            is_reading = false;
+            continue;
+        }
+        is_reading = handler(data, xcb_get_property_value(reply),
+                xcb_get_property_value_length(reply));
+        free(reply);
+    }
+
+    free(cookies);
+    return OK;
+}
+
+/* the requests needed to get the window name */
+struct name_cookies {
+    /* cookie for `_NET_WM_NAME` */
+    xcb_get_property_cookie_t net_name;
+    /* cookie for `WM_NAME` */
+    xcb_get_property_cookie_t name;
+};
+
+/* Send the requests for getting the name of @window. */
+static void request_window_name(Window *window, struct name_cookies *cookies)
+{
+    cookies->net_name = xcb_get_property(connection, false, window->client.id,
+            ATOM(_NET_WM_NAME), XCB_GET_PROPERTY_TYPE_ANY, 0,
+            MAXIMUM_NAME_SIZE / 4);
+    cookies->name = xcb_get_property(connection, false, window->client.id,
+            XCB_ATOM_WM_NAME, XCB_GET_PROPERTY_TYPE_ANY, 0,
+            MAXIMUM_NAME_SIZE / 4);
+}
+
+/* Get the length @string can be cut to without splitting the last multi byte
+ * character when it is @length bytes long.
+ */
+static uint32_t get_character_boundary(const utf8_t *string, uint32_t length)
+{
+    uint32_t start;
+
+    /* go back to the lead byte of the last character */
+    start = length;
+    while (start > 0 && length - start < 3 && U8_IS_TRAIL(string[start - 1])) {
+        start--;
+    }
+    if (start == 0 || !U8_IS_LEAD(string[start - 1])) {
+        return length;
+    }
+    /* drop the character if not all of its trail bytes are there */
+    if ((uint32_t) U8_COUNT_TRAIL_BYTES_UNSAFE(string[start - 1]) >
+            length - start) {
+        return start - 1;
+    }
+    return length;
+}
+
+/* Update the name within @properties using the replies to the requests made in
+ * `request_window_name()`.
+ */
+static void update_window_name(Window *window, struct name_cookies *cookies)
 {
     xcb_get_property_reply_t *name;
+    uint32_t length;
 
     free(window->name);
 
-    name = get_property(window->client.id, ATOM(_NET_WM_NAME),
-            XCB_GET_PROPERTY_TYPE_ANY, 8, UINT32_MAX, NULL);
+    name = get_property_reply(window->client.id, ATOM(_NET_WM_NAME),
+            cookies->net_name, 8, UINT32_MAX, NULL);
     if (name == NULL) {
         /* fall back to `WM_NAME` */
-        name = get_property(window->client.id, XCB_ATOM_WM_NAME,
-                XCB_GET_PROPERTY_TYPE_ANY, 8, UINT32_MAX, NULL);
+        name = get_property_reply(window->client.id, XCB_ATOM_WM_NAME,
+                cookies->name, 8, UINT32_MAX, NULL);
         if (name == NULL) {
             window->name = NULL;
             return;
         }
+    } else {
+        xcb_discard_reply(connection, cookies->name.sequence);
+    }
+
+    length = xcb_get_property_value_length(name);
+    /* the name is longer than what was requested, make sure to not cut it
+     * within a character
+     */
+    if (name->bytes_after > 0) {
+        LOG("name of window %w is truncated to %" PRIu32 " bytes\n",
+                window->client.id, length);
+        length = get_character_boundary(xcb_get_property_value(name), length);
     }
 
-    window->name = (utf8_t*) xstrndup(
-            xcb_get_property_value(name),
-            xcb_get_property_value_length(name));
+    window->name = (utf8_t*) xstrndup(xcb_get_property_value(name), length);
+    tag_memory(window->name, MEMORY_TAG_NAMES);
 
     free(name);
 }
@@ -499,11 +776,19 @@ static void update_window_size_hints(Window *window)
     size_hints_cookie = xcb_icccm_get_wm_size_hints(connection,
             window->client.id, XCB_ATOM_WM_NORMAL_HINTS);
     if (!xcb_icccm_get_wm_size_hints_reply(connection, size_hints_cookie,
-                &window->size_hints, NULL)) {
-        window->size_hints.flags = 0;
+                &window->properties->size_hints, NULL)) {
+        window->properties->size_hints.flags = 0;
     }
 }
 
+/* Update whether @window accepts input focus from its hints and protocols. */
+static void update_window_input(Window *window)
+{
+    window->accepts_input = supports_protocol(window, ATOM(WM_TAKE_FOCUS)) ||
+        !(window->properties->hints.flags & XCB_ICCCM_WM_HINT_INPUT) ||
+        window->properties->hints.input != 0;
+}
+
 /* Update the hints within @properties. */
 static void update_window_hints(Window *window)
 {
@@ -511,9 +796,10 @@ static void update_window_hints(Window *window)
 
     hints_cookie = xcb_icccm_get_wm_hints(connection, window->client.id);
     if (!xcb_icccm_get_wm_hints_reply(connection, hints_cookie,
-                &window->hints, NULL)) {
-        window->hints.flags = 0;
+                &window->properties->hints, NULL)) {
+        window->properties->hints.flags = 0;
     }
+    update_window_input(window);
 }
 
 /* Update the strut partial property within @properties. */
@@ -544,7 +830,8 @@ static void update_window_strut(Window *window)
 
     free(strut);
 
-    window->strut = new_strut;
+    window->properties->strut = new_strut;
+    window->has_strut = !is_strut_empty(&new_strut);
 }
 
 /* Get a window property as list of atoms. */
@@ -555,15 +842,22 @@ static inline xcb_atom_t *get_atom_list(xcb_window_t window, xcb_atom_t atom)
     xcb_atom_t *atoms;
 
     cookie = xcb_get_property(connection, 0, window, atom, XCB_ATOM_ATOM,
-            0, UINT32_MAX);
+            0, MAXIMUM_ATOM_LIST_LENGTH);
     reply = xcb_get_property_reply(connection, cookie, NULL);
     if (reply == NULL) {
         return NULL;
     }
+    PROBE3(property__fetch, window, atom,
+            xcb_get_property_value_length(reply));
+    if (reply->bytes_after > 0) {
+        LOG("window %w has more than " STRINGIFY(MAXIMUM_ATOM_LIST_LENGTH)
+                " atoms in %a, ignoring the rest\n", window, atom);
+    }
     atoms = xmalloc(xcb_get_property_value_length(reply) + sizeof(*atoms));
     memcpy(atoms, xcb_get_property_value(reply),
             xcb_get_property_value_length(reply));
     atoms[xcb_get_property_value_length(reply) / sizeof(xcb_atom_t)] = XCB_NONE;
+    tag_memory(atoms, MEMORY_TAG_PROPERTIES);
     free(reply);
     return atoms;
 }
@@ -584,9 +878,10 @@ static void update_window_transient_for(Window *window)
 /* Update the `protocols` property within @properties. */
 static void update_window_protocols(Window *window)
 {
-    free(window->protocols);
-    window->protocols = get_atom_list(window->client.id,
+    free(window->properties->protocols);
+    window->properties->protocols = get_atom_list(window->client.id,
             ATOM(WM_PROTOCOLS));
+    update_window_input(window);
 }
 
 /* Update the `fullscreen_monitors` property within @properties. */
@@ -596,12 +891,13 @@ static void update_window_fullscreen_monitors(Window *window)
 
     monitors = get_property(window->client.id,
             ATOM(_NET_WM_FULLSCREEN_MONITORS), XCB_ATOM_CARDINAL, 32,
-            sizeof(window->fullscreen_monitors) / sizeof(uint32_t), NULL);
+            sizeof(window->properties->fullscreen_monitors) /
+                sizeof(uint32_t), NULL);
     if (monitors == NULL) {
-        memset(&window->fullscreen_monitors, 0,
-                sizeof(window->fullscreen_monitors));
+        memset(&window->properties->fullscreen_monitors, 0,
+                sizeof(window->properties->fullscreen_monitors));
     } else {
-        window->fullscreen_monitors =
+        window->properties->fullscreen_monitors =
             *(Extents*) xcb_get_property_value(monitors);
         free(monitors);
     }
@@ -614,11 +910,12 @@ static void update_motif_wm_hints(Window *window)
 
     motif_wm_hints = get_property(window->client.id,
             ATOM(_MOTIF_WM_HINTS), ATOM(_MOTIF_WM_HINTS), 32,
-            sizeof(window->motif_wm_hints) / sizeof(uint32_t), NULL);
+            sizeof(window->properties->motif_wm_hints) /
+                sizeof(uint32_t), NULL);
     if (motif_wm_hints == NULL) {
-        window->motif_wm_hints.flags = 0;
+        window->properties->motif_wm_hints.flags = 0;
     } else {
-        window->motif_wm_hints =
+        window->properties->motif_wm_hints =
             *(motif_wm_hints_t*) xcb_get_property_value(motif_wm_hints);
         free(motif_wm_hints);
     }
@@ -630,7 +927,7 @@ bool cache_window_property(Window *window, xcb_atom_t atom)
     /* this is spaced out because it was very difficult to read with the eyes */
     if (atom == XCB_ATOM_WM_NAME || atom == ATOM(_NET_WM_NAME)) {
 
-        update_window_name(window);
+        window->stale_properties |= LAZY_PROPERTY_NAME;
 
     } else if (atom == XCB_ATOM_WM_NORMAL_HINTS ||
             atom == XCB_ATOM_WM_SIZE_HINTS) {
@@ -656,7 +953,11 @@ bool cache_window_property(Window *window, xcb_atom_t atom)
 
     } else if (atom == ATOM(_NET_WM_FULLSCREEN_MONITORS)) {
 
-        update_window_fullscreen_monitors(window);
+        window->stale_properties |= LAZY_PROPERTY_FULLSCREEN_MONITORS;
+
+    } else if (atom == ATOM(_NET_WM_ICON)) {
+
+        window->stale_properties |= LAZY_PROPERTY_ICON;
 
     } else if (atom == ATOM(_MOTIF_WM_HINTS)) {
 
@@ -668,6 +969,76 @@ bool cache_window_property(Window *window, xcb_atom_t atom)
     return true;
 }
 
+/* Make sure given lazy @properties of @window are loaded. */
+void load_window_properties(Window *window, uint32_t properties)
+{
+    struct name_cookies name_cookies;
+
+    /* the icon is only loaded by `get_window_icon()` */
+    properties &= window->stale_properties & ~LAZY_PROPERTY_ICON;
+    if (properties == 0) {
+        return;
+    }
+
+    if ((properties & LAZY_PROPERTY_NAME)) {
+        request_window_name(window, &name_cookies);
+        update_window_name(window, &name_cookies);
+    }
+
+    if ((properties & LAZY_PROPERTY_FULLSCREEN_MONITORS)) {
+        update_window_fullscreen_monitors(window);
+    }
+
+    window->stale_properties &= ~properties;
+}
+
+/* Load the stale lazy @properties of all windows. */
+void load_all_window_properties(uint32_t properties)
+{
+    uint32_t number_of_windows = 0;
+    struct name_cookies *name_cookies;
+    uint32_t index;
+
+    if ((properties & LAZY_PROPERTY_NAME)) {
+        for (Window *window = first_window; window != NULL;
+                window = window->next) {
+            if ((window->stale_properties & LAZY_PROPERTY_NAME)) {
+                number_of_windows++;
+            }
+        }
+    }
+
+    /* send all requests before waiting for any reply */
+    if (number_of_windows > 0) {
+        name_cookies = xmalloc(sizeof(*name_cookies) * number_of_windows);
+
+        index = 0;
+        for (Window *window = first_window; window != NULL;
+                window = window->next) {
+            if ((window->stale_properties & LAZY_PROPERTY_NAME)) {
+                request_window_name(window, &name_cookies[index++]);
+            }
+        }
+
+        index = 0;
+        for (Window *window = first_window; window != NULL;
+                window = window->next) {
+            if ((window->stale_properties & LAZY_PROPERTY_NAME)) {
+                update_window_name(window, &name_cookies[index++]);
+                window->stale_properties &= ~LAZY_PROPERTY_NAME;
+            }
+        }
+
+        free(name_cookies);
+    }
+
+    /* the remaining properties are rarely needed for more than one window */
+    for (Window *window = first_window; window != NULL;
+            window = window->next) {
+        load_window_properties(window, properties);
+    }
+}
+
 /* Check if an atom is within the given list of atoms. */
 static bool is_atom_included(const xcb_atom_t *atoms, xcb_atom_t atom)
 {
@@ -682,7 +1053,7 @@ static bool is_atom_included(const xcb_atom_t *atoms, xcb_atom_t atom)
     return false;
 }
 
-/* Initialize all properties within @properties. */
+/* Initialize the properties within @window that decide the window mode. */
 window_mode_t initialize_window_properties(Window *window)
 {
     xcb_list_properties_cookie_t list_properties_cookie;
@@ -693,6 +1064,11 @@ window_mode_t initialize_window_properties(Window *window)
     xcb_atom_t *types = NULL;
     window_mode_t predicted_mode = WINDOW_MODE_TILING;
 
+    /* the lazy properties are loaded when they are needed */
+    window->stale_properties = LAZY_PROPERTY_ALL;
+    /* without hints or protocols, a window accepts input */
+    window->accepts_input = true;
+
     /* get a list of properties currently set on the window */
     list_properties_cookie = xcb_list_properties(connection, window->client.id);
     list_properties = xcb_list_properties_reply(connection,
@@ -720,21 +1096,21 @@ window_mode_t initialize_window_properties(Window *window)
     } else if (is_atom_included(types, ATOM(_NET_WM_WINDOW_TYPE_DOCK))) {
         predicted_mode = WINDOW_MODE_DOCK;
     /* if this window has strut, it must be a dock window */
-    } else if (!is_strut_empty(&window->strut)) {
+    } else if (window->has_strut) {
         predicted_mode = WINDOW_MODE_DOCK;
     /* transient windows are floating windows */
     } else if (window->transient_for != 0) {
         predicted_mode = WINDOW_MODE_FLOATING;
     /* floating windows have an equal minimum and maximum size */
-    } else if ((window->size_hints.flags &
+    } else if ((window->properties->size_hints.flags &
                 (XCB_ICCCM_SIZE_HINT_P_MIN_SIZE |
                  XCB_ICCCM_SIZE_HINT_P_MAX_SIZE)) ==
                 (XCB_ICCCM_SIZE_HINT_P_MIN_SIZE |
                  XCB_ICCCM_SIZE_HINT_P_MAX_SIZE) &&
-            (window->size_hints.min_width ==
-                window->size_hints.max_width ||
-            window->size_hints.min_height ==
-                window->size_hints.max_height)) {
+            (window->properties->size_hints.min_width ==
+                window->properties->size_hints.max_width ||
+            window->properties->size_hints.min_height ==
+                window->properties->size_hints.max_height)) {
         predicted_mode = WINDOW_MODE_FLOATING;
     /* floating windows have a window type that is not the normal window type */
     } else if (types != NULL &&
@@ -742,7 +1118,13 @@ window_mode_t initialize_window_properties(Window *window)
         predicted_mode = WINDOW_MODE_FLOATING;
     }
 
-    window->states = states;
+    /* remember the frame the program was started from, a window rule can
+     * still overwrite it
+     */
+    match_window_to_launch(window);
+    apply_window_rules(window, types, &predicted_mode);
+
+    window->properties->states = states;
 
     free(types);
     free(list_properties);
@@ -753,11 +1135,11 @@ window_mode_t initialize_window_properties(Window *window)
 /* Check if @properties includes @protocol. */
 bool supports_protocol(Window *window, xcb_atom_t protocol)
 {
-    return is_atom_included(window->protocols, protocol);
+    return is_atom_included(window->properties->protocols, protocol);
 }
 
 /* Check if @properties includes @state. */
 bool has_state(Window *window, xcb_atom_t state)
 {
-    return is_atom_included(window->states, state);
+    return is_atom_included(window->properties->states, state);
 }
@@ -6,6 +6,282 @@
 #include "utility.h"
 #include "xalloc.h"
 
+#ifdef MEMORY_ACCOUNTING
+
+/* conversion from memory tag to string */
+static const char *memory_tag_strings[MEMORY_TAG_MAX] = {
+    [MEMORY_TAG_OTHER] = "other",
+    [MEMORY_TAG_WINDOWS] = "windows",
+    [MEMORY_TAG_NAMES] = "names",
+    [MEMORY_TAG_PROPERTIES] = "properties",
+    [MEMORY_TAG_FRAMES] = "frames",
+    [MEMORY_TAG_STASH] = "stash",
+    [MEMORY_TAG_GLYPHS] = "glyphs",
+    [MEMORY_TAG_ICONS] = "icons",
+    [MEMORY_TAG_CONFIGURATION] = "configuration",
+};
+
+/* a live allocation */
+struct memory_record {
+    /* the allocated memory, NULL for an empty slot */
+    void *pointer;
+    /* the number of allocated bytes */
+    size_t size;
+    /* the tag the memory is accounted to */
+    memory_tag_t tag;
+};
+
+/* the accounting of a single tag */
+static struct memory_usage {
+    /* the number of bytes currently allocated */
+    size_t live_bytes;
+    /* the highest value `live_bytes` ever had */
+    size_t peak_bytes;
+    /* the number of allocations currently alive */
+    size_t live_allocations;
+    /* the number of allocations ever made */
+    size_t total_allocations;
+} memory_usage[MEMORY_TAG_MAX];
+
+/* hash table of all live allocations using linear probing */
+static struct memory_record *records;
+/* the number of slots in `records`, this is always a power of two or 0 */
+static size_t records_capacity;
+/* the number of used slots in `records` */
+static size_t number_of_records;
+
+/* the tag new allocations are accounted to */
+static memory_tag_t current_memory_tag;
+
+/* the number of allocations ever made, this is not changed by retagging */
+static size_t number_of_allocations;
+
+/* Get the home slot of @pointer within `records`. */
+static inline size_t hash_pointer(const void *pointer)
+{
+    uintptr_t hash;
+
+    /* the lower bits are always zero because of the alignment */
+    hash = (uintptr_t) pointer >> 4;
+    hash ^= hash >> 16;
+    hash *= 0x45d9f3b;
+    hash ^= hash >> 16;
+    return hash & (records_capacity - 1);
+}
+
+/* Find the slot of @pointer or the empty slot where it would go. */
+static size_t find_record(const void *pointer)
+{
+    size_t index;
+
+    index = hash_pointer(pointer);
+    while (records[index].pointer != NULL &&
+            records[index].pointer != pointer) {
+        index = (index + 1) & (records_capacity - 1);
+    }
+    return index;
+}
+
+/* Double the size of the record table. */
+static void grow_records(void)
+{
+    struct memory_record *const old_records = records;
+    const size_t old_capacity = records_capacity;
+
+    records_capacity = old_capacity == 0 ? 256 : old_capacity * 2;
+    /* the table itself is not accounted */
+    records = calloc(records_capacity, sizeof(*records));
+    if (records == NULL) {
+        fprintf(stderr, "calloc(%zu, %zu): %s\n",
+                records_capacity, sizeof(*records), strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+
+    for (size_t i = 0; i < old_capacity; i++) {
+        if (old_records[i].pointer != NULL) {
+            records[find_record(old_records[i].pointer)] = old_records[i];
+        }
+    }
+    (free)(old_records);
+}
+
+/* Add a record for @pointer. */
+static void add_record(void *pointer, size_t size, memory_tag_t tag)
+{
+    struct memory_usage *usage;
+
+    if (pointer == NULL) {
+        return;
+    }
+
+    /* keep the load factor at 0.5 or below */
+    if ((number_of_records + 1) * 2 > records_capacity) {
+        grow_records();
+    }
+
+    records[find_record(pointer)] = (struct memory_record) {
+        .pointer = pointer,
+        .size = size,
+        .tag = tag,
+    };
+    number_of_records++;
+    number_of_allocations++;
+
+    usage = &memory_usage[tag];
+    usage->live_bytes += size;
+    usage->peak_bytes = MAX(usage->peak_bytes, usage->live_bytes);
+    usage->live_allocations++;
+    usage->total_allocations++;
+}
+
+/* Remove the record of @pointer.
+ *
+ * @return the tag @pointer was accounted to or the current tag if there was no
+ *         record.
+ */
+static memory_tag_t remove_record(void *pointer)
+{
+    size_t index, next, home;
+    memory_tag_t tag;
+    struct memory_usage *usage;
+
+    if (pointer == NULL || records_capacity == 0) {
+        return current_memory_tag;
+    }
+
+    index = find_record(pointer);
+    if (records[index].pointer == NULL) {
+        return current_memory_tag;
+    }
+
+    tag = records[index].tag;
+    usage = &memory_usage[tag];
+    usage->live_bytes -= records[index].size;
+    usage->live_allocations--;
+
+    /* shift the following records back so no probe sequence is broken */
+    next = index;
+    while (next = (next + 1) & (records_capacity - 1),
+            records[next].pointer != NULL) {
+        home = hash_pointer(records[next].pointer);
+        /* check if the home slot is cyclically outside of (index, next] */
+        if (next > index ? (home <= index || home > next) :
+                (home <= index && home > next)) {
+            records[index] = records[next];
+            index = next;
+        }
+    }
+    records[index].pointer = NULL;
+    number_of_records--;
+    return tag;
+}
+
+/* Set the tag all following allocations are accounted to. */
+memory_tag_t set_memory_tag(memory_tag_t tag)
+{
+    const memory_tag_t previous_tag = current_memory_tag;
+
+    current_memory_tag = tag;
+    return previous_tag;
+}
+
+/* Account the memory at @pointer to @tag. */
+void tag_memory(void *pointer, memory_tag_t tag)
+{
+    size_t index;
+    struct memory_usage *usage;
+
+    if (pointer == NULL || records_capacity == 0) {
+        return;
+    }
+
+    index = find_record(pointer);
+    if (records[index].pointer == NULL) {
+        return;
+    }
+
+    /* move the allocation over as if it was always accounted to @tag */
+    usage = &memory_usage[records[index].tag];
+    usage->live_bytes -= records[index].size;
+    usage->live_allocations--;
+    usage->total_allocations--;
+
+    records[index].tag = tag;
+
+    usage = &memory_usage[tag];
+    usage->live_bytes += records[index].size;
+    usage->peak_bytes = MAX(usage->peak_bytes, usage->live_bytes);
+    usage->live_allocations++;
+    usage->total_allocations++;
+}
+
+/* Like `free()` but also remove the accounting record. */
+void xfree(void *pointer)
+{
+    (void) remove_record(pointer);
+    (free)(pointer);
+}
+
+#else
+
+/* accounting is disabled */
+
+static inline void add_record(void *pointer, size_t size, memory_tag_t tag)
+{
+    (void) pointer;
+    (void) size;
+    (void) tag;
+}
+
+static inline memory_tag_t remove_record(void *pointer)
+{
+    (void) pointer;
+    return MEMORY_TAG_OTHER;
+}
+
+#define current_memory_tag MEMORY_TAG_OTHER
+
+#endif
+
+/* Get the number of allocations made so far. */
+size_t get_number_of_allocations(void)
+{
+#ifdef MEMORY_ACCOUNTING
+    return number_of_allocations;
+#else
+    return 0;
+#endif
+}
+
+/* Write the live bytes and number of allocations of each tag to @file. */
+void dump_memory_usage(FILE *file)
+{
+#ifdef MEMORY_ACCOUNTING
+    struct memory_usage total;
+
+    memset(&total, 0, sizeof(total));
+    fprintf(file, "%-16s %12s %12s %12s %12s\n",
+            "tag", "live bytes", "peak bytes", "live allocs", "total allocs");
+    for (memory_tag_t tag = 0; tag < MEMORY_TAG_MAX; tag++) {
+        const struct memory_usage *const usage = &memory_usage[tag];
+        fprintf(file, "%-16s %12zu %12zu %12zu %12zu\n",
+                memory_tag_strings[tag], usage->live_bytes, usage->peak_bytes,
+                usage->live_allocations, usage->total_allocations);
+        total.live_bytes += usage->live_bytes;
+        total.live_allocations += usage->live_allocations;
+        total.total_allocations += usage->total_allocations;
+    }
+    fprintf(file, "%-16s %12zu %12s %12zu %12zu\n",
+            "total", total.live_bytes, "-",
+            total.live_allocations, total.total_allocations);
+    fprintf(file, "accounting overhead: %zu bytes\n",
+            records_capacity * sizeof(*records));
+#else
+    fprintf(file, "memory accounting is not available, "
+            "build with -DMEMORY_ACCOUNTING\n");
+#endif
+}
+
 void *xmalloc(size_t size)
 {
     void *ptr;
@@ -19,6 +295,7 @@ void *xmalloc(size_t size)
                 size, strerror(errno));
         exit(EXIT_FAILURE);
     }
+    add_record(ptr, size, current_memory_tag);
     return ptr;
 }
 
@@ -35,27 +312,34 @@ void *xcalloc(size_t nmemb, size_t size)
                 nmemb, size, strerror(errno));
         exit(EXIT_FAILURE);
     }
+    add_record(ptr, nmemb * size, current_memory_tag);
     return ptr;
 }
 
 void *xrealloc(void *ptr, size_t size)
 {
+    memory_tag_t tag;
+
     if (size == 0) {
         free(ptr);
         return NULL;
     }
+    /* the memory stays with its tag */
+    tag = remove_record(ptr);
     ptr = realloc(ptr, size);
     if (ptr == NULL) {
         fprintf(stderr, "realloc(%p, %zu): %s\n",
                 ptr, size, strerror(errno));
         exit(EXIT_FAILURE);
     }
+    add_record(ptr, size, tag);
     return ptr;
 }
 
 void *xreallocarray(void *ptr, size_t nmemb, size_t size)
 {
     size_t n_bytes;
+    memory_tag_t tag;
 
     if (nmemb == 0 || size == 0) {
         free(ptr);
@@ -66,12 +350,15 @@ void *xreallocarray(void *ptr, size_t nmemb, size_t size)
                 ptr, nmemb, size);
         exit(EXIT_FAILURE);
     }
+    /* the memory stays with its tag */
+    tag = remove_record(ptr);
     ptr = realloc(ptr, n_bytes);
     if (ptr == NULL) {
         fprintf(stderr, "reallocarray(%p, %zu, %zu): %s\n",
                 ptr, nmemb, size, strerror(errno));
         exit(EXIT_FAILURE);
     }
+    add_record(ptr, n_bytes, tag);
     return ptr;
 }
 
@@ -90,6 +377,7 @@ void *xmemdup(const void *ptr, size_t size)
         exit(EXIT_FAILURE);
     }
     memcpy(p_dup, ptr, size);
+    add_record(p_dup, size, current_memory_tag);
     return p_dup;
 }
 
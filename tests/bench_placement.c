@@ -0,0 +1,195 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "configuration.h"
+#include "log.h"
+#include "placement.h"
+#include "test.h"
+#include "window.h"
+
+/* Benchmark of the placement engine with many floating windows on one monitor.
+ *
+ * The first part places the windows one after another like they would be
+ * placed when they are mapped. The second part moves, hides and shows random
+ * windows, this updates the free space around them. The last part builds the
+ * free space from scratch, the result must be the same as the one updated
+ * along the way.
+ */
+
+/* the number of placed windows */
+#define NUMBER_OF_WINDOWS 500
+
+/* how many windows are moved, hidden or shown */
+#define NUMBER_OF_CHANGES 2000
+
+/* how often the free space is built from scratch */
+#define NUMBER_OF_REBUILDS 5
+
+/* the monitor the windows are placed on */
+static Monitor monitor = {
+    .x = 0,
+    .y = 0,
+    .width = 3840,
+    .height = 2160,
+};
+
+/* the benchmarked windows */
+static Window windows[NUMBER_OF_WINDOWS];
+
+/* Put @window on top of the Z stack and into the number linked list as
+ * visible floating window.
+ */
+static void add_floating_window(Window *window)
+{
+    window->state.mode = WINDOW_MODE_FLOATING;
+    window->state.is_visible = true;
+    window->below = top_window;
+    if (top_window != NULL) {
+        top_window->above = window;
+    } else {
+        bottom_window = window;
+    }
+    top_window = window;
+    window->next = first_window;
+    first_window = window;
+}
+
+/* Force the free space of the monitor to be built from scratch. */
+static void rebuild_free_space(void)
+{
+    Window probe = { .border_size = 0 };
+    Rectangle geometry = {
+        .width = monitor.width + 1,
+        .height = monitor.height + 1,
+    };
+
+    monitor.is_free_space_valid = false;
+    CHECK(!place_in_free_space(&probe, &monitor, &geometry));
+}
+
+/* The border of the placed window is used and not the configured border. */
+static void test_window_border(void)
+{
+    Window window = { .border_size = 0 };
+    Rectangle geometry = {
+        .width = monitor.width,
+        .height = monitor.height,
+    };
+
+    configuration.border.size = 50;
+    CHECK(place_in_free_space(&window, &monitor, &geometry));
+    release_window_free_space(&window);
+
+    window.border_size = 1;
+    CHECK(!place_in_free_space(&window, &monitor, &geometry));
+}
+
+/* Move, hide or show a random window. */
+static void change_random_window(void)
+{
+    Window *const window = &windows[rand() % NUMBER_OF_WINDOWS];
+
+    switch (rand() % 3) {
+    case 0:
+        window->x = rand() % (monitor.width - window->width);
+        window->y = rand() % (monitor.height - window->height);
+        break;
+
+    case 1:
+        window->state.is_visible = !window->state.is_visible;
+        break;
+
+    case 2:
+        window->width = 40 + rand() % 200;
+        window->height = 30 + rand() % 150;
+        break;
+    }
+    update_window_free_space(window);
+}
+
+int main(void)
+{
+    uint64_t start, placing_time, changing_time, rebuild_time;
+    uint32_t number_of_placed = 0;
+    uint32_t number_of_rectangles;
+    Rectangle *rectangles;
+    Rectangle geometry;
+
+    log_severity = LOG_SEVERITY_ERROR;
+    first_monitor = &monitor;
+
+    test_window_border();
+
+    srand(1);
+    start = get_monotonic_nanoseconds();
+    for (uint32_t i = 0; i < NUMBER_OF_WINDOWS; i++) {
+        Window *const window = &windows[i];
+
+        window->border_size = 1 + i % 3;
+        geometry.x = 0;
+        geometry.y = 0;
+        geometry.width = 40 + rand() % 200;
+        geometry.height = 30 + rand() % 150;
+        if (place_in_free_space(window, &monitor, &geometry)) {
+            number_of_placed++;
+        }
+        window->x = geometry.x;
+        window->y = geometry.y;
+        window->width = geometry.width;
+        window->height = geometry.height;
+        add_floating_window(window);
+        /* the window is shown on the next synchronization */
+        update_window_free_space(window);
+    }
+    placing_time = get_monotonic_nanoseconds() - start;
+
+    start = get_monotonic_nanoseconds();
+    for (uint32_t i = 0; i < NUMBER_OF_CHANGES; i++) {
+        change_random_window();
+    }
+    changing_time = get_monotonic_nanoseconds() - start;
+
+    /* the free space updated along the way is the same as a rebuilt one */
+    number_of_rectangles = monitor.number_of_free_rectangles;
+    rectangles = xmemdup(monitor.free_rectangles,
+            sizeof(*rectangles) * number_of_rectangles);
+
+    start = get_monotonic_nanoseconds();
+    for (uint32_t i = 0; i < NUMBER_OF_REBUILDS; i++) {
+        rebuild_free_space();
+    }
+    rebuild_time = get_monotonic_nanoseconds() - start;
+
+    CHECK_EQUAL(monitor.number_of_free_rectangles, number_of_rectangles);
+    CHECK(memcmp(monitor.free_rectangles, rectangles,
+                sizeof(*rectangles) * number_of_rectangles) == 0);
+    free(rectangles);
+
+    /* the free space never covers a visible window */
+    for (uint32_t i = 0; i < monitor.number_of_free_rectangles; i++) {
+        const Rectangle *const space = &monitor.free_rectangles[i];
+
+        for (uint32_t j = 0; j < NUMBER_OF_WINDOWS; j++) {
+            const Window *const window = &windows[j];
+
+            if (!window->state.is_visible) {
+                continue;
+            }
+            CHECK(space->x >= window->x + (int32_t) window->width ||
+                    window->x >= space->x + (int32_t) space->width ||
+                    space->y >= window->y + (int32_t) window->height ||
+                    window->y >= space->y + (int32_t) space->height);
+        }
+    }
+
+    printf("placed %" PRIu32 " of %d windows: %" PRIu64 " ns/placement\n",
+            number_of_placed, NUMBER_OF_WINDOWS,
+            placing_time / NUMBER_OF_WINDOWS);
+    printf("moved, hid or showed %d windows: %" PRIu64 " ns/change\n",
+            NUMBER_OF_CHANGES, changing_time / NUMBER_OF_CHANGES);
+    printf("rebuilt free space of %d windows: %" PRIu64
+                " ns/rebuild, %" PRIu32 " free rectangles\n",
+            NUMBER_OF_WINDOWS, rebuild_time / NUMBER_OF_REBUILDS,
+            monitor.number_of_free_rectangles);
+    return get_test_result();
+}
@@ -0,0 +1,332 @@
+#include <stdlib.h>
+
+#include "configuration.h"
+#include "frame.h"
+#include "log.h"
+#include "monitor.h"
+#include "stash_frame.h"
+#include "stubs/xcb_stub.h"
+#include "test.h"
+#include "tiling.h"
+#include "window.h"
+
+/* Benchmark of the tiling operations on large frame trees.
+ *
+ * The tree is grown to each of the sizes in `tree_sizes[]` and then a random
+ * sequence of operations runs on it. For each operation, the time, the number
+ * of allocations and the number of X requests per call are reported. The
+ * allocations are only counted when compiled with `MEMORY_ACCOUNTING`.
+ *
+ * After each sequence, the tree is checked for consistency.
+ */
+
+/* the number of random operations for each tree size */
+#define NUMBER_OF_OPERATIONS 20000
+
+/* the numbers of leaves the tree is grown to */
+static const uint32_t tree_sizes[] = { 100, 1000, 10000 };
+
+/* the benchmarked operations */
+typedef enum {
+    OPERATION_SPLIT,
+    OPERATION_REMOVE_VOID,
+    OPERATION_BUMP_EDGE,
+    OPERATION_STASH,
+    OPERATION_FILL_VOID,
+    OPERATION_LOOKUP,
+
+    OPERATION_MAX
+} operation_t;
+
+/* the accumulated measurements of an operation */
+static struct profile {
+    /* the name of the operation */
+    const char *name;
+    /* the number of measured calls */
+    uint64_t calls;
+    /* the total time spent in nanoseconds */
+    uint64_t nanoseconds;
+    /* the total number of allocations */
+    uint64_t allocations;
+    /* the total number of X requests */
+    uint64_t requests;
+} profiles[OPERATION_MAX] = {
+    [OPERATION_SPLIT] = { .name = "split" },
+    [OPERATION_REMOVE_VOID] = { .name = "remove void" },
+    [OPERATION_BUMP_EDGE] = { .name = "bump edge" },
+    [OPERATION_STASH] = { .name = "stash" },
+    [OPERATION_FILL_VOID] = { .name = "fill void" },
+    [OPERATION_LOOKUP] = { .name = "lookup" },
+};
+
+/* the values at the start of the current measurement */
+static struct {
+    uint64_t time;
+    size_t allocations;
+    uint64_t requests;
+} start;
+
+/* the monitor the frames are on */
+static Monitor monitor = {
+    .x = 0,
+    .y = 0,
+    .width = 3840,
+    .height = 2160,
+};
+
+/* the windows that are in no frame and not stashed */
+static Window **free_windows;
+
+/* the number of windows in `free_windows` */
+static uint32_t number_of_free_windows;
+
+/* the current number of leaves in the tree */
+static uint32_t number_of_leaves = 1;
+
+/* Start measuring an operation. */
+static inline void begin_measurement(void)
+{
+    start.allocations = get_number_of_allocations();
+    start.requests = number_of_stubbed_requests;
+    start.time = get_monotonic_nanoseconds();
+}
+
+/* Add the measurement since `begin_measurement()` to @operation. */
+static inline void end_measurement(operation_t operation)
+{
+    struct profile *const profile = &profiles[operation];
+
+    profile->nanoseconds += get_monotonic_nanoseconds() - start.time;
+    profile->allocations += get_number_of_allocations() - start.allocations;
+    profile->requests += number_of_stubbed_requests - start.requests;
+    profile->calls++;
+}
+
+/* Create the windows that are put into the frames. */
+static void create_windows(uint32_t count)
+{
+    Window *window;
+
+    free_windows = xreallocarray(NULL, count, sizeof(*free_windows));
+    for (uint32_t i = 0; i < count; i++) {
+        window = xcalloc(1, sizeof(*window));
+        window->properties = xcalloc(1, sizeof(*window->properties));
+        window->client.id = i + 1;
+        window->number = i + 1;
+        window->state.mode = WINDOW_MODE_TILING;
+        window->accepts_input = true;
+        window->next = first_window;
+        first_window = window;
+        free_windows[number_of_free_windows++] = window;
+    }
+}
+
+/* Get a random leaf by walking down the tree randomly. */
+static Frame *get_random_leaf(void)
+{
+    Frame *frame = monitor.frame;
+
+    while (frame->left != NULL) {
+        frame = rand() % 2 == 0 ? frame->left : frame->right;
+    }
+    return frame;
+}
+
+/* Get a random leaf that has a window if @has_window is true or one that is
+ * empty otherwise.
+ *
+ * @return NULL if no such leaf was found after a few tries.
+ */
+static Frame *get_random_leaf_with(bool has_window)
+{
+    Frame *frame;
+
+    for (uint32_t i = 0; i < 8; i++) {
+        frame = get_random_leaf();
+        if ((frame->window != NULL) == has_window) {
+            return frame;
+        }
+    }
+    return NULL;
+}
+
+/* Split a random leaf and put a free window into the new frame. */
+static void split_random_leaf(void)
+{
+    Frame *const frame = get_random_leaf();
+    Window *window;
+
+    begin_measurement();
+    split_frame(frame, rand() % 2 == 0 ? FRAME_SPLIT_HORIZONTALLY :
+            FRAME_SPLIT_VERTICALLY);
+    end_measurement(OPERATION_SPLIT);
+
+    number_of_leaves++;
+
+    if (number_of_free_windows > 0) {
+        window = free_windows[--number_of_free_windows];
+        window->state.is_visible = true;
+        frame->right->window = window;
+        reload_frame(frame->right);
+    }
+}
+
+/* Stash the window of @frame. */
+static void stash_leaf(Frame *frame)
+{
+    begin_measurement();
+    (void) stash_frame(frame);
+    end_measurement(OPERATION_STASH);
+}
+
+/* Run a random operation on the tree, it never grows over @maximum_leaves. */
+static void run_random_operation(uint32_t maximum_leaves)
+{
+    Frame *frame;
+    Frame *(*const lookups[])(Frame *frame) = {
+        get_left_frame, get_above_frame, get_right_frame, get_below_frame,
+    };
+
+    switch ((operation_t) (rand() % OPERATION_MAX)) {
+    case OPERATION_SPLIT:
+        if (number_of_leaves < maximum_leaves) {
+            split_random_leaf();
+        }
+        break;
+
+    case OPERATION_REMOVE_VOID:
+        frame = get_random_leaf();
+        if (frame->parent == NULL) {
+            break;
+        }
+        /* only empty frames are removed */
+        if (frame->window != NULL) {
+            stash_leaf(frame);
+        }
+        begin_measurement();
+        (void) remove_void(frame);
+        end_measurement(OPERATION_REMOVE_VOID);
+        number_of_leaves--;
+        break;
+
+    case OPERATION_BUMP_EDGE:
+        frame = get_random_leaf();
+        begin_measurement();
+        (void) bump_frame_edge(frame, rand() % 4, rand() % 201 - 100);
+        end_measurement(OPERATION_BUMP_EDGE);
+        break;
+
+    case OPERATION_STASH:
+        frame = get_random_leaf_with(true);
+        if (frame != NULL) {
+            stash_leaf(frame);
+        }
+        break;
+
+    case OPERATION_FILL_VOID:
+        frame = get_random_leaf_with(false);
+        if (frame != NULL) {
+            begin_measurement();
+            fill_void_with_stash(frame);
+            end_measurement(OPERATION_FILL_VOID);
+        }
+        break;
+
+    case OPERATION_LOOKUP:
+        frame = get_random_leaf();
+        begin_measurement();
+        (void) lookups[rand() % SIZE(lookups)](frame);
+        end_measurement(OPERATION_LOOKUP);
+        break;
+
+    case OPERATION_MAX:
+        break;
+    }
+}
+
+/* Check that the children of @frame cover it exactly.
+ *
+ * @return the number of leaves within @frame.
+ */
+static uint32_t check_frame(const Frame *frame)
+{
+    const Frame *const left = frame->left;
+    const Frame *const right = frame->right;
+
+    if (left == NULL) {
+        CHECK(right == NULL);
+        return 1;
+    }
+
+    CHECK(frame->window == NULL);
+    CHECK(left->parent == frame && right->parent == frame);
+    CHECK(left->x == frame->x && left->y == frame->y);
+    if (frame->split_direction == FRAME_SPLIT_HORIZONTALLY) {
+        CHECK(left->width + right->width == frame->width);
+        CHECK(right->x == left->x + (int32_t) left->width);
+    } else {
+        CHECK(left->height + right->height == frame->height);
+        CHECK(right->y == left->y + (int32_t) left->height);
+    }
+    return check_frame(left) + check_frame(right);
+}
+
+/* Print the profiles and reset them. */
+static void report_profiles(uint32_t tree_size)
+{
+    printf("%-8s %-12s %10s %10s %10s %12s\n",
+            "leaves", "operation", "calls", "ns/op", "allocs/op",
+            "requests/op");
+    for (operation_t operation = 0; operation < OPERATION_MAX; operation++) {
+        struct profile *const profile = &profiles[operation];
+
+        if (profile->calls == 0) {
+            continue;
+        }
+        printf("%-8" PRIu32 " %-12s %10" PRIu64 " %10" PRIu64
+                    " %10.2f %12.2f\n",
+                tree_size, profile->name, profile->calls,
+                profile->nanoseconds / profile->calls,
+                (double) profile->allocations / profile->calls,
+                (double) profile->requests / profile->calls);
+
+        profile->calls = 0;
+        profile->nanoseconds = 0;
+        profile->allocations = 0;
+        profile->requests = 0;
+    }
+}
+
+int main(void)
+{
+    const uint32_t maximum_leaves = tree_sizes[SIZE(tree_sizes) - 1];
+
+    log_severity = LOG_SEVERITY_ERROR;
+    /* do not render any notification */
+    configuration.notification.duration = 0;
+    configuration.tiling.auto_fill_void = false;
+
+    srand(1);
+    create_windows(maximum_leaves);
+
+    monitor.frame = xcalloc(1, sizeof(*monitor.frame));
+    first_monitor = &monitor;
+    focus_frame = monitor.frame;
+    resize_frame(monitor.frame, monitor.x, monitor.y, monitor.width,
+            monitor.height);
+
+    for (uint32_t i = 0; i < SIZE(tree_sizes); i++) {
+        while (number_of_leaves < tree_sizes[i]) {
+            split_random_leaf();
+        }
+        report_profiles(tree_sizes[i]);
+
+        for (uint32_t j = 0; j < NUMBER_OF_OPERATIONS; j++) {
+            run_random_operation(tree_sizes[i]);
+        }
+        report_profiles(tree_sizes[i]);
+
+        CHECK_EQUAL(check_frame(monitor.frame), number_of_leaves);
+    }
+    return get_test_result();
+}
@@ -0,0 +1,203 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "test.h"
+#include "window.h"
+#include "xalloc.h"
+
+/* Benchmark of `compute_window_geometry()` over synthetic windows.
+ *
+ * Every window gets a random mode, random size hints and a random window
+ * gravity. Docks get a random strut and some fullscreen windows cover a
+ * requested region, so all branches are taken in a mixed order like they would
+ * be when many windows are configured at once.
+ */
+
+/* the number of synthetic windows */
+#define NUMBER_OF_WINDOWS 4096
+
+/* how often the geometry of every window is computed */
+#define NUMBER_OF_ROUNDS 200
+
+/* the monitor all windows are put on, it is not at the origin to catch mixed
+ * up offsets
+ */
+static Monitor monitor = {
+    .x = 1920,
+    .y = 0,
+    .width = 2560,
+    .height = 1440,
+};
+
+/* the synthetic windows */
+static Window *windows;
+
+/* the size hints a window might have */
+static const uint32_t size_hint_flags[] = {
+    XCB_ICCCM_SIZE_HINT_P_POSITION,
+    XCB_ICCCM_SIZE_HINT_P_SIZE,
+    XCB_ICCCM_SIZE_HINT_P_MIN_SIZE,
+    XCB_ICCCM_SIZE_HINT_P_MAX_SIZE,
+    XCB_ICCCM_SIZE_HINT_P_WIN_GRAVITY,
+};
+
+/* Get a random number between @minimum and @maximum (inclusive). */
+static uint32_t get_random(uint32_t minimum, uint32_t maximum)
+{
+    return minimum + rand() % (maximum - minimum + 1);
+}
+
+/* Give @strut a random reserved space on one side of the monitor. */
+static void randomize_strut(wm_strut_partial_t *strut)
+{
+    switch (rand() % 5) {
+    case 0:
+        strut->reserved.left = get_random(16, 64);
+        strut->left_start_y = 0;
+        strut->left_end_y = monitor.height - 1;
+        break;
+
+    case 1:
+        strut->reserved.top = get_random(16, 64);
+        strut->top_start_x = monitor.x;
+        strut->top_end_x = monitor.x + monitor.width - 1;
+        break;
+
+    case 2:
+        strut->reserved.right = get_random(16, 64);
+        strut->right_start_y = 0;
+        strut->right_end_y = monitor.height - 1;
+        break;
+
+    case 3:
+        strut->reserved.bottom = get_random(16, 64);
+        strut->bottom_start_x = monitor.x;
+        strut->bottom_end_x = monitor.x + monitor.width - 1;
+        break;
+
+    /* no strut, the dock uses its own geometry */
+    case 4:
+        break;
+    }
+}
+
+/* Give @window a random mode, size hints, gravity and geometry. */
+static void randomize_window(Window *window)
+{
+    struct window_properties *const properties = window->properties;
+    xcb_size_hints_t *const size_hints = &properties->size_hints;
+
+    window->state.mode = rand() % WINDOW_MODE_MAX;
+    window->x = monitor.x + get_random(0, monitor.width - 1);
+    window->y = monitor.y + get_random(0, monitor.height - 1);
+    window->width = get_random(1, monitor.width);
+    window->height = get_random(1, monitor.height);
+
+    for (uint32_t i = 0; i < SIZE(size_hint_flags); i++) {
+        if (rand() % 2 == 0) {
+            size_hints->flags |= size_hint_flags[i];
+        }
+    }
+    size_hints->x = window->x;
+    size_hints->y = window->y;
+    size_hints->width = get_random(1, monitor.width);
+    size_hints->height = get_random(1, monitor.height);
+    size_hints->min_width = get_random(0, 400);
+    size_hints->min_height = get_random(0, 300);
+    size_hints->max_width = get_random(size_hints->min_width, 2 * 2560);
+    size_hints->max_height = get_random(size_hints->min_height, 2 * 1440);
+    size_hints->win_gravity = get_random(XCB_GRAVITY_NORTH_WEST,
+            XCB_GRAVITY_STATIC);
+
+    /* half of the floating windows were floating before */
+    if (rand() % 2 == 0) {
+        properties->floating.x = monitor.x + get_random(0, monitor.width);
+        properties->floating.y = monitor.y + get_random(0, monitor.height);
+        properties->floating.width = get_random(1, monitor.width);
+        properties->floating.height = get_random(1, monitor.height);
+    }
+
+    /* some fullscreen windows cover a requested region */
+    if (rand() % 4 == 0) {
+        properties->fullscreen_monitors.left = 0;
+        properties->fullscreen_monitors.top = 0;
+        properties->fullscreen_monitors.right = monitor.x + monitor.width;
+        properties->fullscreen_monitors.bottom = monitor.height;
+    }
+
+    randomize_strut(&properties->strut);
+}
+
+/* Create the synthetic windows. */
+static void create_windows(void)
+{
+    windows = xcalloc(NUMBER_OF_WINDOWS, sizeof(*windows));
+    for (uint32_t i = 0; i < NUMBER_OF_WINDOWS; i++) {
+        windows[i].properties =
+            xcalloc(1, sizeof(*windows[i].properties));
+        randomize_window(&windows[i]);
+    }
+}
+
+/* Check that @geometry of @window is within the size limits. */
+static void check_geometry(const Window *window, const Rectangle *geometry)
+{
+    Size minimum, maximum;
+
+    /* the fullscreen size is not clipped */
+    if (window->state.mode == WINDOW_MODE_FULLSCREEN) {
+        return;
+    }
+
+    get_minimum_window_size(window, &minimum);
+    get_maximum_window_size(window, &maximum);
+    CHECK(geometry->width >= minimum.width);
+    CHECK(geometry->height >= minimum.height);
+    CHECK(geometry->width <= MAX(maximum.width, minimum.width));
+    CHECK(geometry->height <= MAX(maximum.height, minimum.height));
+}
+
+int main(void)
+{
+    uint64_t start, duration;
+    uint32_t count[WINDOW_MODE_MAX];
+    Rectangle geometry;
+    /* sum of all computed values so that nothing is optimized away */
+    uint64_t sum = 0;
+
+    srand(1);
+    create_windows();
+
+    memset(count, 0, sizeof(count));
+    for (uint32_t i = 0; i < NUMBER_OF_WINDOWS; i++) {
+        compute_window_geometry(&windows[i], &monitor, &geometry);
+        check_geometry(&windows[i], &geometry);
+        count[windows[i].state.mode]++;
+    }
+
+    start = get_monotonic_nanoseconds();
+    for (uint32_t round = 0; round < NUMBER_OF_ROUNDS; round++) {
+        for (uint32_t i = 0; i < NUMBER_OF_WINDOWS; i++) {
+            compute_window_geometry(&windows[i], &monitor, &geometry);
+            sum += geometry.x + geometry.y + geometry.width + geometry.height;
+        }
+    }
+    duration = get_monotonic_nanoseconds() - start;
+
+    printf("computed the geometry of %d windows "
+                "(%" PRIu32 " tiling, %" PRIu32 " floating, "
+                "%" PRIu32 " fullscreen, %" PRIu32 " dock) "
+                "%d times: %" PRIu64 " ns/call (sum %" PRIu64 ")\n",
+            NUMBER_OF_WINDOWS,
+            count[WINDOW_MODE_TILING], count[WINDOW_MODE_FLOATING],
+            count[WINDOW_MODE_FULLSCREEN], count[WINDOW_MODE_DOCK],
+            NUMBER_OF_ROUNDS,
+            duration / ((uint64_t) NUMBER_OF_WINDOWS * NUMBER_OF_ROUNDS),
+            sum);
+
+    for (uint32_t i = 0; i < NUMBER_OF_WINDOWS; i++) {
+        free(windows[i].properties);
+    }
+    free(windows);
+    return get_test_result();
+}
@@ -0,0 +1,156 @@
+#include <stdlib.h>
+
+#include "event.h"
+#include "frame.h"
+#include "log.h"
+#include "monitor.h"
+#include "screen.h"
+#include "stubs/xcb_stub.h"
+#include "test.h"
+#include "window.h"
+#include "xalloc.h"
+
+/* Benchmark of the walks over the window list that happen every cycle.
+ *
+ * Each walk runs over the same synthetic windows:
+ * - `synchronize_with_server()` after nothing changed
+ * - `get_window_of_xcb_window()` for every window
+ * - the walk of `render_window_list()` checking which windows are listed
+ */
+
+/* the number of synthetic windows */
+#define NUMBER_OF_WINDOWS 1000
+
+/* how often each walk is repeated */
+#define NUMBER_OF_ROUNDS 2000
+
+/* how often each window is looked up */
+#define NUMBER_OF_LOOKUP_ROUNDS 20
+
+/* the stubbed screen */
+static xcb_screen_t stubbed_screen = {
+    .root = 1,
+    .width_in_pixels = 3840,
+    .height_in_pixels = 2160,
+};
+
+/* the monitor all windows are on */
+static Monitor monitor = {
+    .x = 0,
+    .y = 0,
+    .width = 3840,
+    .height = 2160,
+};
+
+/* Create the synthetic windows, every fourth one is hidden and every tenth
+ * one does not accept input.
+ */
+static void create_windows(void)
+{
+    Window *window;
+
+    for (uint32_t i = 0; i < NUMBER_OF_WINDOWS; i++) {
+        window = xcalloc(1, sizeof(*window));
+        window->properties = xcalloc(1, sizeof(*window->properties));
+        window->client.id = 2 + i;
+        window->number = 1 + i;
+        window->state.mode = WINDOW_MODE_FLOATING;
+        window->state.is_visible = i % 4 != 0;
+        window->accepts_input = i % 10 != 0;
+        window->x = i % 3000;
+        window->y = i % 2000;
+        window->width = 200;
+        window->height = 100;
+
+        window->next = first_window;
+        first_window = window;
+
+        window->below = top_window;
+        if (top_window != NULL) {
+            top_window->above = window;
+        } else {
+            bottom_window = window;
+        }
+        top_window = window;
+
+        window->newer = oldest_window;
+        oldest_window = window;
+    }
+}
+
+/* Walk over the windows like `render_window_list()` does.
+ *
+ * @return the number of listed windows.
+ */
+static uint32_t count_listed_windows(void)
+{
+    uint32_t count = 0;
+
+    for (Window *window = first_window; window != NULL;
+            window = window->next) {
+        if (!does_window_accept_focus(window)) {
+            continue;
+        }
+        count += window->state.is_visible ? window->number : 1;
+    }
+    return count;
+}
+
+/* Print the time per walk of @count walks that took @nanoseconds. */
+static void report_walk(const char *name, uint64_t nanoseconds, uint64_t count)
+{
+    printf("%-24s %10.1f ns/walk\n", name, (double) nanoseconds / count);
+}
+
+int main(void)
+{
+    uint64_t start;
+    uint64_t requests;
+    uint64_t listed = 0;
+    uint32_t found = 0;
+
+    log_severity = LOG_SEVERITY_ERROR;
+    for (uint32_t i = 0; i < ATOM_MAX; i++) {
+        x_atoms[i].atom = 1 + i;
+    }
+
+    add_managed_screen(&stubbed_screen, 0);
+    monitor.frame = xcalloc(1, sizeof(*monitor.frame));
+    first_monitor = &monitor;
+    focus_frame = monitor.frame;
+    create_windows();
+
+    /* the first run configures, maps and unmaps all windows */
+    synchronize_with_server();
+
+    requests = number_of_stubbed_requests;
+    start = get_monotonic_nanoseconds();
+    for (uint32_t i = 0; i < NUMBER_OF_ROUNDS; i++) {
+        synchronize_with_server();
+    }
+    report_walk("synchronize_with_server", get_monotonic_nanoseconds() - start,
+            NUMBER_OF_ROUNDS);
+    /* nothing changed so nothing is sent */
+    CHECK_EQUAL(number_of_stubbed_requests - requests, 0);
+
+    start = get_monotonic_nanoseconds();
+    for (uint32_t i = 0; i < NUMBER_OF_LOOKUP_ROUNDS; i++) {
+        for (uint32_t j = 0; j < NUMBER_OF_WINDOWS; j++) {
+            found += get_window_of_xcb_window(2 + j) != NULL;
+        }
+    }
+    /* each lookup walks over half of the windows on average */
+    report_walk("get_window_of_xcb_window", get_monotonic_nanoseconds() - start,
+            NUMBER_OF_LOOKUP_ROUNDS * NUMBER_OF_WINDOWS);
+    CHECK_EQUAL(found, NUMBER_OF_LOOKUP_ROUNDS * NUMBER_OF_WINDOWS);
+
+    start = get_monotonic_nanoseconds();
+    for (uint32_t i = 0; i < NUMBER_OF_ROUNDS; i++) {
+        listed += count_listed_windows();
+    }
+    report_walk("window list", get_monotonic_nanoseconds() - start,
+            NUMBER_OF_ROUNDS);
+    CHECK(listed > 0);
+
+    return get_test_result();
+}
@@ -0,0 +1,143 @@
+#include <string.h>
+
+#include "action.h"
+#include "configuration.h"
+#include "event.h"
+#include "log.h"
+#include "screen.h"
+#include "stubs/xcb_stub.h"
+#include "test.h"
+#include "window.h"
+#include "xalloc.h"
+
+/* Tests for merging the queued repeats of a held down key.
+ *
+ * The key resizes the focused floating window by a fixed amount, so the width
+ * tells how often the key was handled.
+ */
+
+/* the keycode of the configured key, this is also its key symbol */
+#define KEYCODE 42
+
+/* how much the window grows each time the key is handled */
+#define RESIZE_AMOUNT 10
+
+/* the root window of the stubbed screen */
+#define ROOT 1
+
+/* the stubbed screen */
+static xcb_screen_t stubbed_screen = { .root = ROOT };
+
+/* the window resized by the key */
+static Window window;
+
+/* Queue a key event of type @type with @time. */
+static void queue_key_event(uint8_t type, xcb_timestamp_t time)
+{
+    xcb_key_press_event_t event;
+
+    memset(&event, 0, sizeof(event));
+    event.response_type = type;
+    event.detail = KEYCODE;
+    event.time = time;
+    event.root = ROOT;
+    queue_stubbed_event(&event);
+}
+
+/* Handle the events sent by the stubbed server like the event loop does and
+ * check that @expected_cycles were needed and that the window was resized
+ * @expected_resizes times.
+ */
+static void check_stubbed_events(uint32_t expected_cycles,
+        uint32_t expected_resizes)
+{
+    const uint32_t width = window.width;
+    uint32_t cycles = 0;
+    xcb_generic_event_t *event;
+
+    while (event = xcb_poll_for_event(connection), event != NULL) {
+        handle_event(event);
+        free(event);
+        /* the event loop flushes at the end of each cycle */
+        xcb_flush(connection);
+        cycles++;
+    }
+    CHECK_EQUAL(cycles, expected_cycles);
+    CHECK_EQUAL(window.width - width, expected_resizes * RESIZE_AMOUNT);
+    CHECK_EQUAL(get_number_of_stubbed_events(), 0);
+    CHECK(!is_stubbed_keyboard_frozen);
+}
+
+/* With detectable autorepeat, repeats are presses without release. */
+static void test_detectable_repeats(void)
+{
+    queue_key_event(XCB_KEY_PRESS, 100);
+    for (uint32_t i = 1; i <= 3; i++) {
+        queue_key_event(XCB_KEY_PRESS, 100 + i * 30);
+    }
+    check_stubbed_events(1, 4);
+
+    queue_key_event(XCB_KEY_RELEASE, 300);
+    check_stubbed_events(1, 0);
+}
+
+/* Without detectable autorepeat, each repeat is a release and press pair that
+ * freezes the keyboard again.
+ */
+static void test_paired_repeats(void)
+{
+    queue_key_event(XCB_KEY_PRESS, 400);
+    for (uint32_t i = 1; i <= 3; i++) {
+        queue_key_event(XCB_KEY_RELEASE, 400 + i * 30);
+        queue_key_event(XCB_KEY_PRESS, 400 + i * 30);
+    }
+    check_stubbed_events(1, 4);
+
+    queue_key_event(XCB_KEY_RELEASE, 600);
+    check_stubbed_events(1, 0);
+}
+
+/* Repeats queued before the key was released are dropped. */
+static void test_stale_repeats(void)
+{
+    queue_key_event(XCB_KEY_PRESS, 700);
+    queue_key_event(XCB_KEY_PRESS, 730);
+    queue_key_event(XCB_KEY_PRESS, 760);
+    queue_key_event(XCB_KEY_RELEASE, 770);
+    /* the release is handled within the cycle of the first press */
+    check_stubbed_events(1, 1);
+}
+
+int main(void)
+{
+    Action action = {
+        .code = ACTION_RESIZE_BY,
+        .parameter.quad = { 0, 0, RESIZE_AMOUNT, 0 },
+    };
+    struct configuration_key key = {
+        .key_symbol = KEYCODE,
+        .actions = &action,
+        .number_of_actions = 1,
+    };
+
+    log_severity = LOG_SEVERITY_ERROR;
+    configuration.notification.duration = 0;
+    configuration.keyboard.keys = &key;
+    configuration.keyboard.number_of_keys = 1;
+
+    add_managed_screen(&stubbed_screen, 0);
+    initialize_event_handlers();
+
+    window.client.id = 2;
+    window.properties = xcalloc(1, sizeof(*window.properties));
+    window.state.mode = WINDOW_MODE_FLOATING;
+    window.width = 100;
+    window.height = 100;
+    first_window = &window;
+    focus_window = &window;
+
+    test_detectable_repeats();
+    test_paired_repeats();
+    test_stale_repeats();
+    return get_test_result();
+}
@@ -0,0 +1,130 @@
+#include <string.h>
+
+#include "frame.h"
+#include "launch.h"
+#include "log.h"
+#include "screen.h"
+#include "test.h"
+
+/* Tests for matching windows to the programs started by the `RUN` action. */
+
+/* the stubbed screens */
+static xcb_screen_t stubbed_screens[2] = {
+    { .root = 1 },
+    { .root = 2 },
+};
+
+/* the frame focused when the programs start */
+static Frame frame = {
+    .width = 100,
+    .height = 100,
+};
+
+/* Start a program at the horizontal position @x with the process id
+ * @process_id.
+ *
+ * @return the startup identifier of the program.
+ */
+static const char *launch_at(int32_t x, pid_t process_id)
+{
+    const char *id;
+
+    frame.x = x - frame.width / 2;
+    id = begin_launch();
+    if (process_id != 0) {
+        set_launch_process(id, process_id);
+    }
+    return id;
+}
+
+/* Take the launch @id or @process_id and check that it is at @expected_x, an
+ * @expected_x of 0 means that no launch should match.
+ */
+static void check_take_launch(const char *id, pid_t process_id,
+        uint64_t now, int32_t expected_x)
+{
+    Point position = { 0, 0 };
+    bool is_taken;
+
+    is_taken = take_launch(id, id == NULL ? 0 : strlen(id), process_id, now,
+            &position);
+    CHECK_EQUAL(is_taken, expected_x != 0);
+    CHECK_EQUAL(position.x, expected_x);
+}
+
+/* The startup identifier matches before the process id. */
+static void test_startup_id_before_process_id(void)
+{
+    const uint64_t now = get_monotonic_milliseconds();
+    char id[LAUNCH_ID_SIZE];
+
+    (void) launch_at(100, 42);
+    strcpy(id, launch_at(200, 43));
+
+    /* the first launch has the same process id, e.g. a reused one */
+    check_take_launch(id, 42, now, 200);
+    check_take_launch(NULL, 42, now, 100);
+}
+
+/* Only the first window of a program is placed. */
+static void test_first_window_only(void)
+{
+    const uint64_t now = get_monotonic_milliseconds();
+    char id[LAUNCH_ID_SIZE];
+
+    strcpy(id, launch_at(300, 44));
+    check_take_launch(id, 44, now, 300);
+    check_take_launch(id, 44, now, 0);
+    check_take_launch(NULL, 44, now, 0);
+}
+
+/* Launches that did not show a window in time are forgotten. */
+static void test_timeout(void)
+{
+    const uint64_t now = get_monotonic_milliseconds();
+    char id[LAUNCH_ID_SIZE];
+
+    strcpy(id, launch_at(400, 45));
+    check_take_launch(id, 45, now + LAUNCH_TIMEOUT, 0);
+    check_take_launch(id, 45, now + LAUNCH_TIMEOUT - 1, 400);
+}
+
+/* Unknown startup identifiers and process ids match nothing. */
+static void test_no_match(void)
+{
+    const uint64_t now = get_monotonic_milliseconds();
+
+    (void) launch_at(500, 46);
+    check_take_launch("fensterchef-0-0", 0, now, 0);
+    check_take_launch(NULL, 47, now, 0);
+    check_take_launch(NULL, 0, now, 0);
+}
+
+/* A launch only matches windows on the screen the program was started on. */
+static void test_other_screen(void)
+{
+    const uint64_t now = get_monotonic_milliseconds();
+    char id[LAUNCH_ID_SIZE];
+
+    strcpy(id, launch_at(600, 48));
+    switch_screen(1);
+    check_take_launch(id, 48, now, 0);
+    check_take_launch(NULL, 48, now, 0);
+    switch_screen(0);
+    check_take_launch(id, 48, now, 600);
+}
+
+int main(void)
+{
+    log_severity = LOG_SEVERITY_ERROR;
+    add_managed_screen(&stubbed_screens[0], 0);
+    add_managed_screen(&stubbed_screens[1], 1);
+    focus_frame = &frame;
+
+    test_startup_id_before_process_id();
+    test_first_window_only();
+    test_timeout();
+    test_no_match();
+    test_other_screen();
+    return get_test_result();
+}
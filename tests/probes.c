@@ -0,0 +1,34 @@
+#include "probe.h"
+#include "test.h"
+
+/* Tests that the probes cost nothing while no tracer is attached.
+ *
+ * `make check` runs this once without and, if `sys/sdt.h` exists, once with
+ * `USDT_PROBES`.
+ */
+
+/* how often a probe argument was evaluated */
+static uint32_t number_of_evaluations;
+
+/* Count the evaluation of a probe argument. */
+static uint64_t evaluate_argument(void)
+{
+    number_of_evaluations++;
+    return 0;
+}
+
+int main(void)
+{
+    CHECK(!IS_PROBE_ENABLED(event__handle));
+
+    PROBE(synchronize__start);
+    PROBE1(synchronize__end, evaluate_argument());
+    PROBE2(event__receive, evaluate_argument(), evaluate_argument());
+    PROBE3(event__handle, evaluate_argument(), evaluate_argument(),
+            evaluate_argument());
+    CHECK_EQUAL(number_of_evaluations, 0);
+
+    /* the clock is not read */
+    CHECK_EQUAL(START_PROBE_TIMER(event__handle), 0);
+    return get_test_result();
+}
@@ -0,0 +1,181 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include <xcb/xcb.h>
+#include <xcb/xcb_keysyms.h>
+
+#include "xcb_stub.h"
+
+/* the maximum number of queued events */
+#define MAXIMUM_STUBBED_EVENTS 64
+
+/* the number of requests made to the stubbed X server */
+uint64_t number_of_stubbed_requests;
+
+/* if the keyboard is frozen by the key grab */
+bool is_stubbed_keyboard_frozen;
+
+/* if the key grab is active */
+static bool is_key_grab_active;
+
+/* if a request to thaw the keyboard was made but not flushed yet */
+static bool is_keyboard_thaw_pending;
+
+/* the queued events */
+static xcb_generic_event_t stubbed_events[MAXIMUM_STUBBED_EVENTS];
+
+/* the position of the next event to send */
+static uint32_t stubbed_event_position;
+
+/* the number of queued events */
+static uint32_t number_of_stubbed_events;
+
+/* Count a request and get a cookie for it. */
+static xcb_void_cookie_t make_request(void)
+{
+    xcb_void_cookie_t cookie;
+
+    number_of_stubbed_requests++;
+    cookie.sequence = number_of_stubbed_requests;
+    return cookie;
+}
+
+xcb_void_cookie_t xcb_configure_window(xcb_connection_t *connection,
+        xcb_window_t window, uint16_t value_mask, const void *value_list)
+{
+    (void) connection;
+    (void) window;
+    (void) value_mask;
+    (void) value_list;
+    return make_request();
+}
+
+xcb_void_cookie_t xcb_change_window_attributes(xcb_connection_t *connection,
+        xcb_window_t window, uint32_t value_mask, const void *value_list)
+{
+    (void) connection;
+    (void) window;
+    (void) value_mask;
+    (void) value_list;
+    return make_request();
+}
+
+xcb_void_cookie_t xcb_change_property(xcb_connection_t *connection,
+        uint8_t mode, xcb_window_t window, xcb_atom_t property,
+        xcb_atom_t type, uint8_t format, uint32_t data_len, const void *data)
+{
+    (void) connection;
+    (void) mode;
+    (void) window;
+    (void) property;
+    (void) type;
+    (void) format;
+    (void) data_len;
+    (void) data;
+    return make_request();
+}
+
+xcb_void_cookie_t xcb_map_window(xcb_connection_t *connection,
+        xcb_window_t window)
+{
+    (void) connection;
+    (void) window;
+    return make_request();
+}
+
+xcb_void_cookie_t xcb_unmap_window(xcb_connection_t *connection,
+        xcb_window_t window)
+{
+    (void) connection;
+    (void) window;
+    return make_request();
+}
+
+xcb_void_cookie_t xcb_set_input_focus(xcb_connection_t *connection,
+        uint8_t revert_to, xcb_window_t focus, xcb_timestamp_t time)
+{
+    (void) connection;
+    (void) revert_to;
+    (void) focus;
+    (void) time;
+    return make_request();
+}
+
+xcb_void_cookie_t xcb_allow_events(xcb_connection_t *connection,
+        uint8_t mode, xcb_timestamp_t time)
+{
+    (void) connection;
+    (void) time;
+    if (mode == XCB_ALLOW_ASYNC_KEYBOARD) {
+        is_keyboard_thaw_pending = true;
+    }
+    return make_request();
+}
+
+/* Put a copy of the 32 byte @event at the end of the stubbed event queue. */
+void queue_stubbed_event(const void *event)
+{
+    if (stubbed_event_position == number_of_stubbed_events) {
+        stubbed_event_position = 0;
+        number_of_stubbed_events = 0;
+    }
+    memset(&stubbed_events[number_of_stubbed_events], 0,
+            sizeof(*stubbed_events));
+    /* events on the wire are 32 bytes, the generic event has some extra */
+    memcpy(&stubbed_events[number_of_stubbed_events++], event, 32);
+}
+
+/* Get the number of events in the stubbed event queue. */
+uint32_t get_number_of_stubbed_events(void)
+{
+    return number_of_stubbed_events - stubbed_event_position;
+}
+
+xcb_generic_event_t *xcb_poll_for_event(xcb_connection_t *connection)
+{
+    xcb_generic_event_t *event;
+
+    (void) connection;
+
+    if (is_stubbed_keyboard_frozen ||
+            stubbed_event_position == number_of_stubbed_events) {
+        return NULL;
+    }
+
+    event = malloc(sizeof(*event));
+    memcpy(event, &stubbed_events[stubbed_event_position++], sizeof(*event));
+
+    switch (event->response_type & ~0x80) {
+    /* the press activates the synchronous grab which freezes the keyboard */
+    case XCB_KEY_PRESS:
+        if (!is_key_grab_active) {
+            is_key_grab_active = true;
+            is_stubbed_keyboard_frozen = true;
+        }
+        break;
+
+    case XCB_KEY_RELEASE:
+        is_key_grab_active = false;
+        break;
+    }
+    return event;
+}
+
+int xcb_flush(xcb_connection_t *connection)
+{
+    (void) connection;
+    /* the server only sees the requests after they are flushed */
+    if (is_keyboard_thaw_pending) {
+        is_keyboard_thaw_pending = false;
+        is_stubbed_keyboard_frozen = false;
+    }
+    return 1;
+}
+
+xcb_keysym_t xcb_key_symbols_get_keysym(xcb_key_symbols_t *symbols,
+        xcb_keycode_t keycode, int column)
+{
+    (void) symbols;
+    (void) column;
+    return keycode;
+}
@@ -0,0 +1,32 @@
+#ifndef XCB_STUB_H
+#define XCB_STUB_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* The stubbed xcb request functions replace the ones of libxcb within the
+ * tests. They do not talk to any X server, they only count the requests.
+ *
+ * Only requests without reply are stubbed, the tests must not run code that
+ * waits for a reply.
+ *
+ * The stubbed server sends the events queued with `queue_stubbed_event()`.
+ * Like a real server, it freezes the keyboard when a key press activates the
+ * synchronous key grab and sends no more events until a flushed
+ * `xcb_allow_events()` thaws it again. The key symbol of each keycode is the
+ * keycode itself.
+ */
+
+/* the number of requests made to the stubbed X server */
+extern uint64_t number_of_stubbed_requests;
+
+/* if the keyboard is frozen by the key grab */
+extern bool is_stubbed_keyboard_frozen;
+
+/* Put a copy of the 32 byte @event at the end of the stubbed event queue. */
+void queue_stubbed_event(const void *event);
+
+/* Get the number of events in the stubbed event queue. */
+uint32_t get_number_of_stubbed_events(void);
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef TEST_H
+#define TEST_H
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Every source file in `tests/` is built into its own program by `make tests`
+ * and `make check` runs them all. A test program reports each failed check and
+ * exits with a non zero exit code if any check failed.
+ */
+
+/* the number of failed checks */
+static uint32_t number_of_failed_checks;
+
+/* Check that @condition holds, otherwise report the location. */
+#define CHECK(condition) do { \
+    if (!(condition)) { \
+        fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, \
+                #condition); \
+        number_of_failed_checks++; \
+    } \
+} while (0)
+
+/* Check that the integers @actual and @expected are equal. */
+#define CHECK_EQUAL(actual, expected) do { \
+    const int64_t actual_ = (actual); \
+    const int64_t expected_ = (expected); \
+    if (actual_ != expected_) { \
+        fprintf(stderr, "%s:%d: check failed: %s is %" PRId64 \
+                " but should be %" PRId64 "\n", __FILE__, __LINE__, \
+                #actual, actual_, expected_); \
+        number_of_failed_checks++; \
+    } \
+} while (0)
+
+/* Get the exit code of the test program. */
+static inline int get_test_result(void)
+{
+    if (number_of_failed_checks > 0) {
+        fprintf(stderr, "%" PRIu32 " check(s) failed\n",
+                number_of_failed_checks);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+#endif
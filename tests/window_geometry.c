@@ -0,0 +1,252 @@
+#include <string.h>
+
+#include "test.h"
+#include "window.h"
+
+/* Tests for `compute_window_geometry()`, it only reads the window and the
+ * monitor so no X connection is needed.
+ */
+
+/* the monitor all windows are put on, it is not at the origin to catch mixed
+ * up offsets
+ */
+static Monitor monitor = {
+    .x = 100,
+    .y = 50,
+    .width = 1000,
+    .height = 800,
+};
+
+/* Reset @window and @properties to a window in @mode without any hints. */
+static void reset_window(Window *window, struct window_properties *properties,
+        window_mode_t mode)
+{
+    memset(window, 0, sizeof(*window));
+    memset(properties, 0, sizeof(*properties));
+    window->properties = properties;
+    window->state.mode = mode;
+}
+
+/* Check that @geometry is at @x, @y with the size @width x @height. */
+#define CHECK_GEOMETRY(geometry, x_, y_, width_, height_) do { \
+    CHECK_EQUAL((geometry).x, (x_)); \
+    CHECK_EQUAL((geometry).y, (y_)); \
+    CHECK_EQUAL((geometry).width, (width_)); \
+    CHECK_EQUAL((geometry).height, (height_)); \
+} while (0)
+
+/* Floating windows with a window gravity are attached to that side of the
+ * monitor.
+ */
+static void test_gravity(void)
+{
+    const struct {
+        uint32_t gravity;
+        int32_t x, y;
+    } cases[] = {
+        { XCB_GRAVITY_NORTH_WEST, 100, 50 },
+        { XCB_GRAVITY_NORTH, 500, 50 },
+        { XCB_GRAVITY_NORTH_EAST, 900, 50 },
+        { XCB_GRAVITY_WEST, 100, 400 },
+        { XCB_GRAVITY_CENTER, 500, 400 },
+        { XCB_GRAVITY_EAST, 900, 400 },
+        { XCB_GRAVITY_SOUTH_WEST, 100, 750 },
+        { XCB_GRAVITY_SOUTH, 500, 750 },
+        /* this used the monitor width for the vertical position */
+        { XCB_GRAVITY_SOUTH_EAST, 900, 750 },
+        /* the centered position stays */
+        { XCB_GRAVITY_STATIC, 500, 400 },
+    };
+    Window window;
+    struct window_properties properties;
+    Rectangle geometry;
+
+    for (uint32_t i = 0; i < SIZE(cases); i++) {
+        reset_window(&window, &properties, WINDOW_MODE_FLOATING);
+        properties.size_hints.flags = XCB_ICCCM_SIZE_HINT_P_SIZE |
+            XCB_ICCCM_SIZE_HINT_P_WIN_GRAVITY;
+        properties.size_hints.width = 200;
+        properties.size_hints.height = 100;
+        properties.size_hints.win_gravity = cases[i].gravity;
+
+        compute_window_geometry(&window, &monitor, &geometry);
+        CHECK_GEOMETRY(geometry, cases[i].x, cases[i].y, 200, 100);
+    }
+
+    /* tiling windows ignore the gravity */
+    reset_window(&window, &properties, WINDOW_MODE_TILING);
+    properties.size_hints.flags = XCB_ICCCM_SIZE_HINT_P_WIN_GRAVITY;
+    properties.size_hints.win_gravity = XCB_GRAVITY_SOUTH_EAST;
+    window.x = 10;
+    window.y = 20;
+    window.width = 300;
+    window.height = 400;
+    compute_window_geometry(&window, &monitor, &geometry);
+    CHECK_GEOMETRY(geometry, 10, 20, 300, 400);
+}
+
+/* Fullscreen windows cover the monitor or the region they asked for. */
+static void test_fullscreen(void)
+{
+    Window window;
+    struct window_properties properties;
+    Rectangle geometry;
+
+    reset_window(&window, &properties, WINDOW_MODE_FULLSCREEN);
+    compute_window_geometry(&window, &monitor, &geometry);
+    CHECK_GEOMETRY(geometry, 100, 50, 1000, 800);
+
+    /* the height used to subtract the left edge instead of the top edge */
+    properties.fullscreen_monitors.left = 0;
+    properties.fullscreen_monitors.right = 1920;
+    properties.fullscreen_monitors.top = 100;
+    properties.fullscreen_monitors.bottom = 1180;
+    compute_window_geometry(&window, &monitor, &geometry);
+    CHECK_GEOMETRY(geometry, 0, 100, 1920, 1080);
+
+    /* neither the gravity nor the size hints shrink a fullscreen window */
+    memset(&properties.fullscreen_monitors, 0,
+            sizeof(properties.fullscreen_monitors));
+    properties.size_hints.flags = XCB_ICCCM_SIZE_HINT_P_MAX_SIZE |
+        XCB_ICCCM_SIZE_HINT_P_WIN_GRAVITY;
+    properties.size_hints.max_width = 50;
+    properties.size_hints.max_height = 50;
+    properties.size_hints.win_gravity = XCB_GRAVITY_SOUTH_EAST;
+    compute_window_geometry(&window, &monitor, &geometry);
+    CHECK_GEOMETRY(geometry, 100, 50, 1000, 800);
+}
+
+/* Dock windows use their hints, then their strut and then their current
+ * geometry.
+ */
+static void test_dock(void)
+{
+    Window window;
+    struct window_properties properties;
+    Rectangle geometry;
+
+    /* position and size are both needed */
+    reset_window(&window, &properties, WINDOW_MODE_DOCK);
+    properties.size_hints.flags = XCB_ICCCM_SIZE_HINT_P_POSITION |
+        XCB_ICCCM_SIZE_HINT_P_SIZE;
+    properties.size_hints.x = 120;
+    properties.size_hints.y = 60;
+    properties.size_hints.width = 300;
+    properties.size_hints.height = 20;
+    compute_window_geometry(&window, &monitor, &geometry);
+    CHECK_GEOMETRY(geometry, 120, 60, 300, 20);
+
+    reset_window(&window, &properties, WINDOW_MODE_DOCK);
+    properties.strut.reserved.left = 30;
+    properties.strut.left_start_y = 50;
+    properties.strut.left_end_y = 849;
+    compute_window_geometry(&window, &monitor, &geometry);
+    CHECK_GEOMETRY(geometry, 100, 50, 30, 800);
+
+    reset_window(&window, &properties, WINDOW_MODE_DOCK);
+    properties.strut.reserved.top = 24;
+    properties.strut.top_start_x = 100;
+    properties.strut.top_end_x = 1099;
+    compute_window_geometry(&window, &monitor, &geometry);
+    CHECK_GEOMETRY(geometry, 100, 50, 1000, 24);
+
+    reset_window(&window, &properties, WINDOW_MODE_DOCK);
+    properties.strut.reserved.right = 40;
+    properties.strut.right_start_y = 50;
+    properties.strut.right_end_y = 449;
+    compute_window_geometry(&window, &monitor, &geometry);
+    CHECK_GEOMETRY(geometry, 1060, 50, 40, 400);
+
+    reset_window(&window, &properties, WINDOW_MODE_DOCK);
+    properties.strut.reserved.bottom = 16;
+    properties.strut.bottom_start_x = 600;
+    properties.strut.bottom_end_x = 1099;
+    compute_window_geometry(&window, &monitor, &geometry);
+    CHECK_GEOMETRY(geometry, 600, 834, 500, 16);
+
+    /* without hints or strut, the window stays where it is */
+    reset_window(&window, &properties, WINDOW_MODE_DOCK);
+    window.x = 7;
+    window.y = 9;
+    window.width = 64;
+    window.height = 32;
+    compute_window_geometry(&window, &monitor, &geometry);
+    CHECK_GEOMETRY(geometry, 7, 9, 64, 32);
+}
+
+/* Floating windows are clipped to their minimum and maximum size and centered
+ * with their final size.
+ */
+static void test_floating(void)
+{
+    Window window;
+    struct window_properties properties;
+    Rectangle geometry;
+
+    /* without any hints, take two thirds of the monitor */
+    reset_window(&window, &properties, WINDOW_MODE_FLOATING);
+    compute_window_geometry(&window, &monitor, &geometry);
+    CHECK_GEOMETRY(geometry, 267, 183, 666, 533);
+
+    /* the maximum size wins over the preferred size */
+    reset_window(&window, &properties, WINDOW_MODE_FLOATING);
+    properties.size_hints.flags = XCB_ICCCM_SIZE_HINT_P_SIZE |
+        XCB_ICCCM_SIZE_HINT_P_MAX_SIZE;
+    properties.size_hints.width = 900;
+    properties.size_hints.height = 700;
+    properties.size_hints.max_width = 400;
+    properties.size_hints.max_height = 300;
+    compute_window_geometry(&window, &monitor, &geometry);
+    CHECK_GEOMETRY(geometry, 400, 300, 400, 300);
+
+    /* the minimum size wins over the preferred size */
+    reset_window(&window, &properties, WINDOW_MODE_FLOATING);
+    properties.size_hints.flags = XCB_ICCCM_SIZE_HINT_P_SIZE |
+        XCB_ICCCM_SIZE_HINT_P_MIN_SIZE;
+    properties.size_hints.width = 10;
+    properties.size_hints.height = 10;
+    properties.size_hints.min_width = 200;
+    properties.size_hints.min_height = 100;
+    compute_window_geometry(&window, &monitor, &geometry);
+    CHECK_GEOMETRY(geometry, 500, 400, 200, 100);
+
+    /* no window gets smaller than the minimum window size */
+    reset_window(&window, &properties, WINDOW_MODE_FLOATING);
+    properties.size_hints.flags = XCB_ICCCM_SIZE_HINT_P_SIZE;
+    properties.size_hints.width = 1;
+    properties.size_hints.height = 0;
+    compute_window_geometry(&window, &monitor, &geometry);
+    CHECK_EQUAL(geometry.width, WINDOW_MINIMUM_SIZE);
+    CHECK_EQUAL(geometry.height, WINDOW_MINIMUM_SIZE);
+
+    /* the previous floating geometry is restored if it is on the monitor */
+    reset_window(&window, &properties, WINDOW_MODE_FLOATING);
+    properties.floating.x = 150;
+    properties.floating.y = 70;
+    properties.floating.width = 320;
+    properties.floating.height = 240;
+    compute_window_geometry(&window, &monitor, &geometry);
+    CHECK_GEOMETRY(geometry, 150, 70, 320, 240);
+
+    /* it is centered if it belongs to another monitor */
+    properties.floating.x = 2000;
+    compute_window_geometry(&window, &monitor, &geometry);
+    CHECK_GEOMETRY(geometry, 440, 330, 320, 240);
+
+    /* and clipped if the size hints changed in the meantime */
+    properties.floating.x = 150;
+    properties.size_hints.flags = XCB_ICCCM_SIZE_HINT_P_MAX_SIZE;
+    properties.size_hints.max_width = 100;
+    properties.size_hints.max_height = 5000;
+    compute_window_geometry(&window, &monitor, &geometry);
+    CHECK_GEOMETRY(geometry, 150, 70, 100, 240);
+}
+
+int main(void)
+{
+    test_gravity();
+    test_fullscreen();
+    test_dock();
+    test_floating();
+    return get_test_result();
+}
@@ -0,0 +1,68 @@
+#include <string.h>
+
+#include "configuration.h"
+#include "configuration_parser.h"
+#include "test.h"
+
+/* Tests for the patterns of window rules in the `[rules]` label. */
+
+/* Parse @line as line within the rules label into @configuration. */
+static parser_error_t parse_rule_line(struct configuration *configuration,
+        const char *line)
+{
+    Parser parser;
+
+    memset(&parser, 0, sizeof(parser));
+    parser.line = (char*) line;
+    parser.configuration = configuration;
+    parser.label = PARSER_LABEL_RULES;
+    return parse_line(&parser);
+}
+
+/* Check that @line is parsed into a rule with the pattern @pattern. */
+static void check_pattern(const char *line, const char *pattern)
+{
+    struct configuration configuration;
+    parser_error_t error;
+
+    memset(&configuration, 0, sizeof(configuration));
+    error = parse_rule_line(&configuration, line);
+    CHECK_EQUAL(error, PARSER_SUCCESS);
+    if (error != PARSER_SUCCESS) {
+        return;
+    }
+
+    CHECK_EQUAL(configuration.rules.number_of_rules, 1);
+    CHECK(strcmp((char*) configuration.rules.rules[0].pattern, pattern) == 0);
+    CHECK_EQUAL(configuration.rules.rules[0].frame, RULE_FRAME_LEFT);
+
+    free(configuration.rules.rules[0].pattern);
+    free(configuration.rules.rules);
+}
+
+/* Check that @line fails to parse with @expected. */
+static void check_error(const char *line, parser_error_t expected)
+{
+    struct configuration configuration;
+
+    memset(&configuration, 0, sizeof(configuration));
+    CHECK_EQUAL(parse_rule_line(&configuration, line), expected);
+    CHECK_EQUAL(configuration.rules.number_of_rules, 0);
+}
+
+int main(void)
+{
+    check_pattern("class Firefox frame left", "Firefox");
+    check_pattern("title \"Mozilla Firefox\" frame left", "Mozilla Firefox");
+    check_pattern("title Mozilla\\ Firefox frame left", "Mozilla Firefox");
+    check_pattern("title \"say \\\"hi\\\"\" frame left", "say \"hi\"");
+    check_pattern("title \"a\\\\b\" frame left", "a\\b");
+    check_pattern("title \"*  spaced  *\" frame left", "*  spaced  *");
+
+    check_error("title \"Mozilla Firefox frame left",
+            PARSER_ERROR_MISSING_QUOTE);
+    check_error("title \"\" frame left", PARSER_ERROR_PREMATURE_LINE_END);
+    check_error("title Mozilla Firefox frame left",
+            PARSER_ERROR_INVALID_RULE_EFFECT);
+    return get_test_result();
+}